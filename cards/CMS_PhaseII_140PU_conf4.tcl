@@ -95,6 +95,12 @@ module PileUpMerger PileUpMerger {
   # pre-generated minbias input file
   set PileUpFile MinBias.pileup
 
+  # number of minbias events kept in memory, 0 to read them from the file
+  set PreloadPileUp 0
+
+  # threads filling pile-up particles, more than one needs PreloadPileUp or a columnar pile-up file
+  set NumberOfThreads 1
+
   # Get rid of beam spot from http://red-gridftp11.unl.edu/Snowmass/MinBias100K_14TeV.pileup ...
   set InputBSX 2.44
   set InputBSY 3.39
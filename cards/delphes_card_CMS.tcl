@@ -597,4 +597,12 @@ module TreeWriter TreeWriter {
   add Branch UniqueObjectFinder/muons Muon Muon
   add Branch MissingET/momentum MissingET MissingET
   add Branch ScalarHT/energy ScalarHT ScalarHT
+
+# branches written as leaf arrays (Jet_PT[Jet_size]) instead of objects,
+# compression algorithm and level -1 use the settings of the output file,
+# references from other branches (Jet.Constituents, Muon.Particle) to the objects
+# of a flat branch can't be resolved, so Particle, Track, Tower and Muon
+# should stay object branches when such references are used
+# add FlatBranch BranchName BasketSize CompressionAlgorithm CompressionLevel
+# add FlatBranch Jet 256000 4 4
 }
@@ -0,0 +1,84 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesArena_h
+#define DelphesArena_h
+
+/** \class DelphesArena
+ *
+ *  Typed arena handing out preallocated objects by bumping an index.
+ *  Objects are allocated in slabs that are kept between events,
+ *  Clear() only resets the index.
+ *
+ */
+
+#include <vector>
+
+#include <stddef.h>
+
+template< typename T >
+class DelphesArena
+{
+public:
+
+  DelphesArena(size_t slabSize = 1024) : fSlabSize(slabSize), fSize(0) {}
+
+  ~DelphesArena()
+  {
+    typename std::vector< T * >::iterator itSlabs;
+    for(itSlabs = fSlabs.begin(); itSlabs != fSlabs.end(); ++itSlabs)
+    {
+      delete[] (*itSlabs);
+    }
+  }
+
+  T *New()
+  {
+    if(fSize >= fObjects.size()) NewSlab();
+    return fObjects[fSize++];
+  }
+
+  void Clear() { fSize = 0; }
+
+  size_t GetSize() const { return fSize; }
+  size_t GetCapacity() const { return fObjects.size(); }
+
+private:
+
+  void NewSlab()
+  {
+    size_t i;
+    T *slab = new T[fSlabSize];
+    fSlabs.push_back(slab);
+    fObjects.reserve(fObjects.size() + fSlabSize);
+    for(i = 0; i < fSlabSize; ++i)
+    {
+      fObjects.push_back(slab + i);
+    }
+  }
+
+  DelphesArena(const DelphesArena &);
+  DelphesArena &operator=(const DelphesArena &);
+
+  size_t fSlabSize, fSize;
+
+  std::vector< T * > fSlabs;
+  std::vector< T * > fObjects;
+};
+
+#endif // DelphesArena_h
@@ -0,0 +1,257 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \class DelphesCaloBinning
+ *
+ *  Constant-time lookup of calorimeter eta and phi bins.
+ *  Each axis is covered by a uniform grid of cells, every cell
+ *  stores the first bin edge above its lower boundary.
+ *  A short walk over the neighbouring edges corrects
+ *  the result for non-uniform binning.
+ *
+ *  Returns the same bins as std::lower_bound over the bin edges.
+ *
+ *  Also groups packed tower hits by tower with a radix sort
+ *  whose number of passes is set by the number of bins.
+ *
+ */
+
+#include "classes/DelphesCaloBinning.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// number of grid cells per bin
+static const Int_t kCellsPerBin = 4;
+
+// number of bits sorted in one radix sort pass
+static const Int_t kRadixBits = 8;
+static const Int_t kRadixSize = 1 << kRadixBits;
+static const Int_t kRadixPasses = 5;
+
+// number of bits needed to store values in [0, size)
+static Int_t GetBits(Int_t size)
+{
+  Int_t bits = 0;
+  while(bits < 16 && (1 << bits) < size) ++bits;
+  return bits;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesCaloBinning::DelphesCaloBinning()
+{
+  Clear();
+}
+
+//------------------------------------------------------------------------------
+
+DelphesCaloBinning::~DelphesCaloBinning()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesCaloBinning::Clear()
+{
+  fEtaAxis.edgeOffset = 0;
+  fEtaAxis.edgeSize = 0;
+  fEtaAxis.cellOffset = 0;
+  fEtaAxis.cellSize = 0;
+  fEtaAxis.min = 0.0;
+  fEtaAxis.scale = 0.0;
+
+  fPhiAxes.clear();
+  fEdges.clear();
+  fCells.clear();
+
+  fPhiBits = 16;
+  fKeyBits = 40;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesCaloBinning::Build(const vector< Double_t > &etaBins, const vector< vector< Double_t >* > &phiBins)
+{
+  vector< vector< Double_t >* >::const_iterator itPhiBins;
+  Int_t phiSize;
+
+  Clear();
+
+  BuildAxis(fEtaAxis, etaBins);
+
+  phiSize = 0;
+  fPhiAxes.resize(phiBins.size());
+  for(itPhiBins = phiBins.begin(); itPhiBins != phiBins.end(); ++itPhiBins)
+  {
+    BuildAxis(fPhiAxes[itPhiBins - phiBins.begin()], **itPhiBins);
+    phiSize = max(phiSize, Int_t((*itPhiBins)->size()));
+  }
+
+  // only the bits used by the bin numbers enter the sort key
+  fPhiBits = GetBits(phiSize);
+  fKeyBits = GetBits(etaBins.size()) + fPhiBits + 8;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesCaloBinning::BuildAxis(Axis &axis, const vector< Double_t > &edges)
+{
+  Int_t i;
+  Double_t width;
+
+  axis.edgeOffset = fEdges.size();
+  axis.edgeSize = edges.size();
+  axis.cellOffset = fCells.size();
+  axis.cellSize = 0;
+  axis.min = 0.0;
+  axis.scale = 0.0;
+
+  fEdges.insert(fEdges.end(), edges.begin(), edges.end());
+
+  if(edges.size() < 2) return;
+
+  width = edges.back() - edges.front();
+  if(width <= 0.0) return;
+
+  axis.cellSize = kCellsPerBin*(edges.size() - 1);
+  axis.min = edges.front();
+  axis.scale = axis.cellSize/width;
+
+  for(i = 0; i < axis.cellSize; ++i)
+  {
+    fCells.push_back(lower_bound(edges.begin(), edges.end(), axis.min + i/axis.scale) - edges.begin());
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Int_t DelphesCaloBinning::FindEdge(const Axis &axis, Double_t x) const
+{
+  Int_t cell, i;
+  const Double_t *edges;
+
+  if(axis.cellSize == 0) return -1;
+
+  edges = &fEdges[axis.edgeOffset];
+
+  // same acceptance as lower_bound without first and last edges
+  if(!(x > edges[0]) || x > edges[axis.edgeSize - 1]) return -1;
+
+  cell = Int_t((x - axis.min)*axis.scale);
+  if(cell < 0) cell = 0;
+  if(cell >= axis.cellSize) cell = axis.cellSize - 1;
+
+  i = fCells[axis.cellOffset + cell];
+
+  // correct for edges inside the cell and for rounding
+  while(i > 0 && edges[i - 1] >= x) --i;
+  while(edges[i] < x) ++i;
+
+  return i;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesCaloBinning::FindBin(Double_t eta, Double_t phi, Int_t &etaBin, Int_t &phiBin) const
+{
+  etaBin = FindEdge(fEtaAxis, eta);
+  if(etaBin < 0) return kFALSE;
+
+  phiBin = FindEdge(fPhiAxes[etaBin], phi);
+  if(phiBin < 0) return kFALSE;
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+Long64_t DelphesCaloBinning::GetHitKey(Long64_t hit) const
+{
+  Long64_t etaBin, phiBin, flags;
+
+  etaBin = (hit >> 48) & 0x000000000000FFFFLL;
+  phiBin = (hit >> 32) & 0x000000000000FFFFLL;
+  flags = (hit >> 24) & 0x00000000000000FFLL;
+
+  return (etaBin << (fPhiBits + 8)) | (phiBin << 8) | flags;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesCaloBinning::SortHits(vector< Long64_t > &hits)
+{
+  Int_t counts[kRadixPasses][kRadixSize];
+  Int_t passes, pass, digit, offset, total, size, i;
+  Long64_t key;
+  Long64_t *input, *output;
+
+  size = hits.size();
+  if(size < 2) return;
+
+  passes = (fKeyBits + kRadixBits - 1)/kRadixBits;
+
+  // fill histograms of all digits in one loop
+  fill(&counts[0][0], &counts[0][0] + kRadixPasses*kRadixSize, 0);
+  for(i = 0; i < size; ++i)
+  {
+    key = GetHitKey(hits[i]);
+    for(pass = 0; pass < passes; ++pass)
+    {
+      ++counts[pass][(key >> (pass*kRadixBits)) & (kRadixSize - 1)];
+    }
+  }
+
+  fHitBuffer.resize(size);
+
+  input = &hits[0];
+  output = &fHitBuffer[0];
+
+  // least significant digit first, every pass keeps the order of equal digits,
+  // so hit numbers stay sorted without being part of the key
+  for(pass = 0; pass < passes; ++pass)
+  {
+    // skip digits that are the same for all hits
+    key = GetHitKey(input[0]);
+    digit = (key >> (pass*kRadixBits)) & (kRadixSize - 1);
+    if(counts[pass][digit] == size) continue;
+
+    total = 0;
+    for(digit = 0; digit < kRadixSize; ++digit)
+    {
+      offset = counts[pass][digit];
+      counts[pass][digit] = total;
+      total += offset;
+    }
+
+    for(i = 0; i < size; ++i)
+    {
+      key = GetHitKey(input[i]);
+      digit = (key >> (pass*kRadixBits)) & (kRadixSize - 1);
+      output[counts[pass][digit]++] = input[i];
+    }
+
+    swap(input, output);
+  }
+
+  if(input != &hits[0]) hits.swap(fHitBuffer);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,87 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesCaloBinning_h
+#define DelphesCaloBinning_h
+
+/** \class DelphesCaloBinning
+ *
+ *  Constant-time lookup of calorimeter eta and phi bins.
+ *  Each axis is covered by a uniform grid of cells, every cell
+ *  stores the first bin edge above its lower boundary.
+ *  A short walk over the neighbouring edges corrects
+ *  the result for non-uniform binning.
+ *
+ *  Returns the same bins as std::lower_bound over the bin edges.
+ *
+ *  Also groups packed tower hits by tower with a radix sort
+ *  whose number of passes is set by the number of bins.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class DelphesCaloBinning
+{
+public:
+
+  DelphesCaloBinning();
+  ~DelphesCaloBinning();
+
+  void Clear();
+
+  void Build(const std::vector< Double_t > &etaBins, const std::vector< std::vector< Double_t >* > &phiBins);
+
+  // find eta bin [1, etaBins.size - 1] and phi bin [1, phiBins[etaBin].size - 1],
+  // returns false if the point is outside of the calorimeter
+  Bool_t FindBin(Double_t eta, Double_t phi, Int_t &etaBin, Int_t &phiBin) const;
+
+  // sort tower hits {16-bits for eta bin number, 16-bits for phi bin number, 8-bits for flags, 24-bits for number}
+  // by eta bin number, then by phi bin number, then by flags and then by number,
+  // hits with equal eta bin number, phi bin number and flags must be added in increasing order of number
+  void SortHits(std::vector< Long64_t > &hits);
+
+private:
+
+  struct Axis
+  {
+    Int_t edgeOffset, edgeSize;
+    Int_t cellOffset, cellSize;
+    Double_t min, scale;
+  };
+
+  void BuildAxis(Axis &axis, const std::vector< Double_t > &edges);
+
+  Int_t FindEdge(const Axis &axis, Double_t x) const;
+
+  Long64_t GetHitKey(Long64_t hit) const;
+
+  Axis fEtaAxis;
+  std::vector< Axis > fPhiAxes;
+
+  std::vector< Double_t > fEdges;
+  std::vector< Int_t > fCells;
+
+  Int_t fPhiBits, fKeyBits;
+
+  std::vector< Long64_t > fHitBuffer;
+};
+
+#endif // DelphesCaloBinning_h
@@ -30,8 +30,12 @@
 #include "classes/DelphesClasses.h"
 
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesOverlapIndex.h"
 #include "classes/SortableObject.h"
 
+#include <algorithm>
+#include <vector>
+
 CompBase *GenParticle::fgCompare = 0;
 CompBase *Photon::fgCompare = CompPT<Photon>::Instance();
 CompBase *Electron::fgCompare = CompPT<Electron>::Instance();
@@ -146,7 +150,10 @@ Candidate::Candidate() :
   NSubJetsPruned(0),
   NSubJetsSoftDropped(0),
   fFactory(0),
-  fArray(0)
+  fArray(0),
+  fNCandidates(0),
+  fCandidatesOffset(-1),
+  fCandidatesCapacity(kInlineCandidates)
 {
   int i;
   Edges[0] = 0.0;
@@ -173,49 +180,118 @@ Candidate::Candidate() :
 
 //------------------------------------------------------------------------------
 
+Candidate *const *Candidate::GetDaughters() const
+{
+  if(fCandidatesOffset < 0) return fInlineCandidates;
+  return fFactory->GetDaughters(fCandidatesOffset);
+}
+
+//------------------------------------------------------------------------------
+
 void Candidate::AddCandidate(Candidate *object)
 {
-  if(!fArray) fArray = fFactory->NewArray();
-  fArray->Add(object);
+  Int_t i, offset, capacity;
+  Candidate **daughters;
+
+  if(fNCandidates >= fCandidatesCapacity)
+  {
+    // move daughters to a new block of the pool,
+    // blocks shared with clones are never extended in place
+    capacity = 2*fNCandidates;
+    if(capacity < 16) capacity = 16;
+    offset = fFactory->NewDaughters(capacity);
+    daughters = fFactory->GetDaughters(offset);
+    for(i = 0; i < fNCandidates; ++i)
+    {
+      daughters[i] = GetDaughters()[i];
+    }
+    fCandidatesOffset = offset;
+    fCandidatesCapacity = capacity;
+  }
+
+  if(fCandidatesOffset < 0)
+  {
+    fInlineCandidates[fNCandidates++] = object;
+  }
+  else
+  {
+    fFactory->GetDaughters(fCandidatesOffset)[fNCandidates++] = object;
+  }
 }
 
 //------------------------------------------------------------------------------
 
 TObjArray *Candidate::GetCandidates()
 {
+  Int_t i;
+  Candidate *const *daughters = GetDaughters();
+
+  // the array is only a view of the daughter list,
+  // it is extended when daughters have been added since the last call
   if(!fArray) fArray = fFactory->NewArray();
+  for(i = fArray->GetEntriesFast(); i < fNCandidates; ++i)
+  {
+    fArray->Add(daughters[i]);
+  }
   return fArray;
 }
 
 //------------------------------------------------------------------------------
 
-Bool_t Candidate::Overlaps(const Candidate *object) const
+// true if one of the leaves of the daughter tree has the given ID
+static Bool_t ContainsLeaf(const Candidate *candidate, UInt_t id)
 {
-  const Candidate *candidate;
+  Int_t i, size = candidate->GetNumberOfCandidates();
 
-  if(object->GetUniqueID() == GetUniqueID()) return kTRUE;
+  if(size == 0) return candidate->GetUniqueID() == id;
 
-  if(fArray)
+  for(i = 0; i < size; ++i)
   {
-    TIter it(fArray);
-    while((candidate = static_cast<Candidate *>(it.Next())))
-    {
-      if(candidate->Overlaps(object)) return kTRUE;
-    }
+    if(ContainsLeaf(candidate->GetCandidate(i), id)) return kTRUE;
   }
 
-  if(object->fArray)
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+// true if one of the leaves of the daughter tree is in the sorted list
+static Bool_t ContainsLeaf(const Candidate *candidate, const std::vector< UInt_t > &leaves)
+{
+  Int_t i, size = candidate->GetNumberOfCandidates();
+
+  if(size == 0) return std::binary_search(leaves.begin(), leaves.end(), candidate->GetUniqueID());
+
+  for(i = 0; i < size; ++i)
   {
-    TIter it(object->fArray);
-    while((candidate = static_cast<Candidate *>(it.Next())))
-    {
-      if(candidate->Overlaps(this)) return kTRUE;
-    }
+    if(ContainsLeaf(candidate->GetCandidate(i), leaves)) return kTRUE;
   }
 
   return kFALSE;
 }
 
+//------------------------------------------------------------------------------
+
+Bool_t Candidate::Overlaps(const Candidate *object) const
+{
+  std::vector< UInt_t > localLeaves;
+  std::vector< UInt_t > *leaves;
+
+  if(object == this || object->GetUniqueID() == GetUniqueID()) return kTRUE;
+
+  // two daughter trees share a candidate if and only if they share a leaf
+  if(object->GetNumberOfCandidates() == 0) return ContainsLeaf(this, object->GetUniqueID());
+  if(GetNumberOfCandidates() == 0) return ContainsLeaf(object, GetUniqueID());
+
+  leaves = fFactory ? &fFactory->GetLeafBuffer() : &localLeaves;
+
+  leaves->clear();
+  DelphesOverlapIndex::CollectLeaves(this, *leaves);
+
+  std::sort(leaves->begin(), leaves->end());
+
+  return ContainsLeaf(object, *leaves);
+}
 
 //------------------------------------------------------------------------------
 
@@ -231,7 +307,7 @@ TObject *Candidate::Clone(const char *newname) const
 void Candidate::Copy(TObject &obj) const
 {
   Candidate &object = static_cast<Candidate &>(obj);
-  Candidate *candidate;
+  Int_t i;
 
   object.PID = PID;
   object.Status = Status;
@@ -316,18 +392,25 @@ void Candidate::Copy(TObject &obj) const
   object.fFactory = fFactory;
   object.fArray = 0;
 
-  // copy cluster timing info
-  copy(ECalEnergyTimePairs.begin(), ECalEnergyTimePairs.end(), back_inserter(object.ECalEnergyTimePairs));
-
-  if(fArray && fArray->GetEntriesFast() > 0)
+  // share the daughter list, the clone moves it
+  // to its own block when it adds a daughter
+  object.fNCandidates = fNCandidates;
+  object.fCandidatesOffset = fCandidatesOffset;
+  if(fCandidatesOffset < 0)
   {
-    TIter itArray(fArray);
-    TObjArray *array = object.GetCandidates();
-    while((candidate = static_cast<Candidate *>(itArray.Next())))
+    object.fCandidatesCapacity = kInlineCandidates;
+    for(i = 0; i < fNCandidates; ++i)
     {
-      array->Add(candidate);
+      object.fInlineCandidates[i] = fInlineCandidates[i];
     }
   }
+  else
+  {
+    object.fCandidatesCapacity = fNCandidates;
+  }
+
+  // copy cluster timing info
+  copy(ECalEnergyTimePairs.begin(), ECalEnergyTimePairs.end(), back_inserter(object.ECalEnergyTimePairs));
 }
 
 //------------------------------------------------------------------------------
@@ -409,4 +492,7 @@ void Candidate::Clear(Option_t* option)
   NSubJetsSoftDropped = 0;
 
   fArray = 0;
+  fNCandidates = 0;
+  fCandidatesOffset = -1;
+  fCandidatesCapacity = kInlineCandidates;
 }
@@ -582,6 +582,9 @@ public:
   void AddCandidate(Candidate *object);
   TObjArray *GetCandidates();
 
+  Int_t GetNumberOfCandidates() const { return fNCandidates; }
+  Candidate *GetCandidate(Int_t i) const { return GetDaughters()[i]; }
+
   Bool_t Overlaps(const Candidate *object) const;
 
   virtual void Copy(TObject &object) const;
@@ -592,6 +595,17 @@ private:
   DelphesFactory *fFactory; //!
   TObjArray *fArray; //!
 
+  // first daughters are stored inline, longer lists are
+  // stored in the daughter pool of the factory
+  enum { kInlineCandidates = 4 };
+
+  Int_t fNCandidates; //!
+  Int_t fCandidatesOffset; //!
+  Int_t fCandidatesCapacity; //!
+  Candidate *fInlineCandidates[kInlineCandidates]; //!
+
+  Candidate *const *GetDaughters() const;
+
   void SetFactory(DelphesFactory *factory) { fFactory = factory; }
 
   ClassDef(Candidate, 4)
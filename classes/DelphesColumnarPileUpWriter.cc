@@ -0,0 +1,246 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \class DelphesColumnarPileUpWriter
+ *
+ *  Writes columnar pile-up binary file
+ *
+ */
+
+#include "classes/DelphesColumnarPileUpWriter.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+static const char kMagic[8] = {'D', 'P', 'U', 'C', 'O', 'L', '0', '1'};
+static const int kHeaderSize = 128;
+static const int kColumnAlignment = 64;
+static const int kColumns = 9;
+static const int kBufferSize = 1000000;
+
+//------------------------------------------------------------------------------
+
+static void EncodeWord(unsigned int value, char *output)
+{
+  output[0] = value & 0xFF;
+  output[1] = (value >> 8) & 0xFF;
+  output[2] = (value >> 16) & 0xFF;
+  output[3] = (value >> 24) & 0xFF;
+}
+
+//------------------------------------------------------------------------------
+
+static void EncodeQuad(u_quad_t value, char *output)
+{
+  EncodeWord(value & 0xFFFFFFFFULL, output);
+  EncodeWord(value >> 32, output + 4);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesColumnarPileUpWriter::DelphesColumnarPileUpWriter(const char *fileName) :
+  fEntries(0), fParticles(0), fPileUpFile(0)
+{
+  stringstream message;
+  int i;
+
+  for(i = 0; i < kColumns; ++i) fColumnFiles[i] = 0;
+
+  fPileUpFile = fopen(fileName, "w+");
+
+  if(fPileUpFile == NULL)
+  {
+    message << "can't open pile-up file " << fileName;
+    throw runtime_error(message.str());
+  }
+
+  // columns are collected in temporary files and merged by WriteIndex
+  for(i = 0; i < kColumns; ++i)
+  {
+    fColumnFiles[i] = tmpfile();
+    if(fColumnFiles[i] == NULL)
+    {
+      throw runtime_error("can't create temporary file for pile-up columns");
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+DelphesColumnarPileUpWriter::~DelphesColumnarPileUpWriter()
+{
+  int i;
+
+  for(i = 0; i < kColumns; ++i)
+  {
+    if(fColumnFiles[i]) fclose(fColumnFiles[i]);
+  }
+  if(fPileUpFile) fclose(fPileUpFile);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesColumnarPileUpWriter::WriteParticle(int pid,
+  float x, float y, float z, float t,
+  float px, float py, float pz, float e)
+{
+  if(fPIDBuffer.size() >= size_t(kBufferSize))
+  {
+    throw runtime_error("too many particles in pile-up event");
+  }
+
+  fPIDBuffer.push_back(pid);
+  fBuffers[0].push_back(x);
+  fBuffers[1].push_back(y);
+  fBuffers[2].push_back(z);
+  fBuffers[3].push_back(t);
+  fBuffers[4].push_back(px);
+  fBuffers[5].push_back(py);
+  fBuffers[6].push_back(pz);
+  fBuffers[7].push_back(e);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesColumnarPileUpWriter::WriteEntry()
+{
+  int i, size;
+
+  size = fPIDBuffer.size();
+
+  fIndex.push_back(fParticles);
+
+  if(size > 0)
+  {
+    WriteColumn(0, &fPIDBuffer[0], size);
+    for(i = 0; i < kColumns - 1; ++i)
+    {
+      WriteColumn(i + 1, &fBuffers[i][0], size);
+      fBuffers[i].clear();
+    }
+    fPIDBuffer.clear();
+  }
+
+  fParticles += size;
+  ++fEntries;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesColumnarPileUpWriter::WriteColumn(int column, const void *data, int size)
+{
+  const char *input = static_cast<const char *>(data);
+  unsigned int value;
+  int i;
+
+  fEncodeBuffer.resize(size*4);
+  for(i = 0; i < size; ++i)
+  {
+    memcpy(&value, input + i*4, 4);
+    EncodeWord(value, &fEncodeBuffer[i*4]);
+  }
+
+  if(fwrite(&fEncodeBuffer[0], 4, size, fColumnFiles[column]) != size_t(size))
+  {
+    throw runtime_error("can't write pile-up columns");
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesColumnarPileUpWriter::WriteIndex()
+{
+  char header[kHeaderSize];
+  char buffer[65536];
+  u_quad_t offsets[kColumns];
+  u_quad_t offset, indexOffset;
+  size_t size;
+  int i;
+
+  // the file is rewritten from the start by every call,
+  // the index is followed by the total number of particles
+  rewind(fPileUpFile);
+
+  // layout: header, index, columns aligned on kColumnAlignment
+  indexOffset = kHeaderSize;
+  offset = indexOffset + (fIndex.size() + 1)*8;
+  for(i = 0; i < kColumns; ++i)
+  {
+    offset = (offset + kColumnAlignment - 1)/kColumnAlignment*kColumnAlignment;
+    offsets[i] = offset;
+    offset += fParticles*4;
+  }
+
+  memset(header, 0, kHeaderSize);
+  memcpy(header, kMagic, 8);
+  EncodeQuad(fEntries, header + 8);
+  EncodeQuad(fParticles, header + 16);
+  EncodeQuad(indexOffset, header + 24);
+  for(i = 0; i < kColumns; ++i)
+  {
+    EncodeQuad(offsets[i], header + 32 + i*8);
+  }
+
+  fEncodeBuffer.resize((fIndex.size() + 1)*8);
+  for(size = 0; size < fIndex.size(); ++size)
+  {
+    EncodeQuad(fIndex[size], &fEncodeBuffer[size*8]);
+  }
+  EncodeQuad(fParticles, &fEncodeBuffer[size*8]);
+
+  if(fwrite(header, 1, kHeaderSize, fPileUpFile) != size_t(kHeaderSize)
+  || fwrite(&fEncodeBuffer[0], 1, fEncodeBuffer.size(), fPileUpFile) != fEncodeBuffer.size())
+  {
+    throw runtime_error("can't write pile-up file");
+  }
+
+  // copy columns
+  memset(buffer, 0, kColumnAlignment);
+  for(i = 0; i < kColumns; ++i)
+  {
+    offset = ftello(fPileUpFile);
+    if(fwrite(buffer, 1, offsets[i] - offset, fPileUpFile) != offsets[i] - offset)
+    {
+      throw runtime_error("can't write pile-up file");
+    }
+
+    rewind(fColumnFiles[i]);
+    while((size = fread(buffer, 1, sizeof(buffer), fColumnFiles[i])) > 0)
+    {
+      if(fwrite(buffer, 1, size, fPileUpFile) != size)
+      {
+        throw runtime_error("can't write pile-up file");
+      }
+    }
+
+    // the next entries are appended to the column
+    fseeko(fColumnFiles[i], 0, SEEK_END);
+    memset(buffer, 0, kColumnAlignment);
+  }
+
+  fflush(fPileUpFile);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,75 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesColumnarPileUpWriter_h
+#define DelphesColumnarPileUpWriter_h
+
+/** \class DelphesColumnarPileUpWriter
+ *
+ *  Writes columnar pile-up binary file
+ *
+ *  All numbers are little-endian, the file starts with a header of 128 bytes:
+ *  8 bytes of magic "DPUCOL01", number of events, number of particles,
+ *  offset of the index and offsets of the pid, x, y, z, t, px, py, pz, e columns,
+ *  all as 64-bit integers. The index stores the number of the first particle
+ *  of every event, followed by the number of particles. Every column is an array
+ *  of 32-bit integers (pid) or floats aligned on a 64-byte boundary,
+ *  so that the file can be memory-mapped and read without copying.
+ *
+ */
+
+#include <stdio.h>
+#include <rpc/types.h>
+
+#include <vector>
+
+class DelphesColumnarPileUpWriter
+{
+public:
+
+  DelphesColumnarPileUpWriter(const char *fileName);
+
+  ~DelphesColumnarPileUpWriter();
+
+  void WriteParticle(int pid,
+    float x, float y, float z, float t,
+    float px, float py, float pz, float e);
+
+  void WriteEntry();
+
+  // writes the file with all entries so far, can be called again after more entries
+  void WriteIndex();
+
+private:
+
+  void WriteColumn(int column, const void *data, int size);
+
+  quad_t fEntries;
+  quad_t fParticles;
+
+  FILE *fPileUpFile;
+  FILE *fColumnFiles[9];
+
+  std::vector< int > fPIDBuffer;
+  std::vector< float > fBuffers[8];
+  std::vector< char > fEncodeBuffer;
+
+  std::vector< quad_t > fIndex;
+};
+
+#endif // DelphesColumnarPileUpWriter_h
@@ -0,0 +1,326 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+/** \class DelphesEfficiencyMap
+ *
+ *  Efficiency formulas indexed by flavor (PDG code of the matched parton),
+ *  flavors without a formula use the formula of flavor 0
+ *  or zero efficiency if there is none.
+ *  Evaluates many candidates at once, grouped by formula.
+ *
+ *  Formulas that depend only on pt and eta can be tabulated
+ *  on a regular (pt, eta) grid, with or without bilinear interpolation.
+ *  Candidates outside of the grid are evaluated with the formula.
+ *
+ */
+
+#include "classes/DelphesEfficiencyMap.h"
+#include "classes/DelphesFormula.h"
+
+#include "TMath.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+// flavors below this value are looked up in a dense table
+static const Int_t kDenseFlavors = 32;
+
+//------------------------------------------------------------------------------
+
+DelphesEfficiencyMap::DelphesEfficiencyMap() :
+  fFlavorEntries(kDenseFlavors, -1), fDefaultEntry(-1),
+  fPTBins(0), fEtaBins(0),
+  fPTMin(0.0), fPTMax(0.0), fEtaMax(0.0),
+  fPTScale(0.0), fEtaScale(0.0),
+  fInterpolate(kFALSE)
+{
+}
+
+//------------------------------------------------------------------------------
+
+DelphesEfficiencyMap::~DelphesEfficiencyMap()
+{
+  Clear();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEfficiencyMap::Clear()
+{
+  vector< Entry >::iterator itEntries;
+
+  for(itEntries = fEntries.begin(); itEntries != fEntries.end(); ++itEntries)
+  {
+    if(itEntries->formula) delete itEntries->formula;
+  }
+
+  fEntries.clear();
+  fFlavorMap.clear();
+  fFlavorEntries.assign(kDenseFlavors, -1);
+  fDefaultEntry = -1;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEfficiencyMap::SetFormula(Int_t flavor, const char *expression)
+{
+  map< Int_t, Int_t >::iterator itFlavorMap;
+  DelphesFormula *formula;
+  Int_t i, entry;
+
+  formula = new DelphesFormula;
+  formula->Compile(expression);
+
+  itFlavorMap = fFlavorMap.find(flavor);
+  if(itFlavorMap != fFlavorMap.end())
+  {
+    entry = itFlavorMap->second;
+    delete fEntries[entry].formula;
+  }
+  else
+  {
+    entry = fEntries.size();
+    fEntries.push_back(Entry());
+    fFlavorMap[flavor] = entry;
+  }
+
+  fEntries[entry].formula = formula;
+  BuildTable(fEntries[entry]);
+
+  // update the entries of the flavors
+  itFlavorMap = fFlavorMap.find(0);
+  fDefaultEntry = itFlavorMap != fFlavorMap.end() ? itFlavorMap->second : -1;
+
+  for(i = 0; i < kDenseFlavors; ++i)
+  {
+    itFlavorMap = fFlavorMap.find(i);
+    fFlavorEntries[i] = itFlavorMap != fFlavorMap.end() ? itFlavorMap->second : fDefaultEntry;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesEfficiencyMap::HasFormula(Int_t flavor) const
+{
+  return fFlavorMap.find(flavor) != fFlavorMap.end();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEfficiencyMap::SetTable(Int_t ptBins, Double_t ptMin, Double_t ptMax, Int_t etaBins, Double_t etaMax, Bool_t interpolate)
+{
+  vector< Entry >::iterator itEntries;
+
+  if(ptBins > 0 && (etaBins <= 0 || ptMax <= ptMin || etaMax <= 0.0))
+  {
+    throw runtime_error("invalid efficiency table binning");
+  }
+
+  fPTBins = ptBins;
+  fEtaBins = etaBins;
+  fPTMin = ptMin;
+  fPTMax = ptMax;
+  fEtaMax = etaMax;
+  fInterpolate = interpolate;
+
+  if(ptBins > 0)
+  {
+    fPTScale = ptBins/(ptMax - ptMin);
+    fEtaScale = etaBins/(2.0*etaMax);
+  }
+
+  for(itEntries = fEntries.begin(); itEntries != fEntries.end(); ++itEntries)
+  {
+    BuildTable(*itEntries);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEfficiencyMap::BuildTable(Entry &entry)
+{
+  Int_t i, j, ptNodes, etaNodes;
+  Double_t offset;
+  vector< Double_t > pt, eta;
+
+  entry.table.clear();
+
+  // tables can only be used for functions of pt and eta
+  entry.tabulated = fPTBins > 0 && !entry.formula->DependsOn(2) && !entry.formula->DependsOn(3);
+  if(!entry.tabulated) return;
+
+  // nodes at the bin edges for interpolation and at the bin centers otherwise
+  ptNodes = fInterpolate ? fPTBins + 1 : fPTBins;
+  etaNodes = fInterpolate ? fEtaBins + 1 : fEtaBins;
+  offset = fInterpolate ? 0.0 : 0.5;
+
+  pt.resize(ptNodes*etaNodes);
+  eta.resize(ptNodes*etaNodes);
+  entry.table.resize(ptNodes*etaNodes);
+
+  for(i = 0; i < ptNodes; ++i)
+  {
+    for(j = 0; j < etaNodes; ++j)
+    {
+      pt[i*etaNodes + j] = fPTMin + (i + offset)/fPTScale;
+      eta[i*etaNodes + j] = -fEtaMax + (j + offset)/fEtaScale;
+    }
+  }
+
+  entry.formula->EvalN(&pt[0], &eta[0], 0, 0, &entry.table[0], ptNodes*etaNodes);
+}
+
+//------------------------------------------------------------------------------
+
+Int_t DelphesEfficiencyMap::GetEntry(Int_t flavor) const
+{
+  map< Int_t, Int_t >::const_iterator itFlavorMap;
+
+  if(flavor >= 0 && flavor < kDenseFlavors) return fFlavorEntries[flavor];
+
+  itFlavorMap = fFlavorMap.find(flavor);
+  return itFlavorMap != fFlavorMap.end() ? itFlavorMap->second : fDefaultEntry;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesEfficiencyMap::Lookup(const Entry &entry, Double_t pt, Double_t eta, Double_t &value) const
+{
+  Int_t i, j, stride;
+  Double_t u, v;
+  const Double_t *node;
+
+  if(!(pt >= fPTMin && pt <= fPTMax && eta >= -fEtaMax && eta <= fEtaMax)) return kFALSE;
+
+  u = (pt - fPTMin)*fPTScale;
+  v = (eta + fEtaMax)*fEtaScale;
+  i = TMath::Min(Int_t(u), fPTBins - 1);
+  j = TMath::Min(Int_t(v), fEtaBins - 1);
+
+  if(!fInterpolate)
+  {
+    value = entry.table[i*fEtaBins + j];
+    return kTRUE;
+  }
+
+  u -= i;
+  v -= j;
+  stride = fEtaBins + 1;
+  node = &entry.table[i*stride + j];
+
+  value = (1.0 - u)*((1.0 - v)*node[0] + v*node[1]) + u*((1.0 - v)*node[stride] + v*node[stride + 1]);
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEfficiencyMap::EvalEntry(Entry &entry, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Double_t *energy, Double_t *out, Int_t n)
+{
+  Int_t i;
+
+  if(!entry.tabulated)
+  {
+    entry.formula->EvalN(pt, eta, phi, energy, out, n);
+    return;
+  }
+
+  for(i = 0; i < n; ++i)
+  {
+    if(Lookup(entry, pt[i], eta[i], out[i])) continue;
+    out[i] = entry.formula->Eval(pt[i], eta[i]);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Double_t DelphesEfficiencyMap::Eval(Int_t flavor, Double_t pt, Double_t eta, Double_t phi, Double_t energy)
+{
+  Int_t entry;
+  Double_t value;
+
+  entry = GetEntry(flavor);
+  if(entry < 0) return 0.0;
+
+  if(fEntries[entry].tabulated && Lookup(fEntries[entry], pt, eta, value)) return value;
+
+  return fEntries[entry].formula->Eval(pt, eta, phi, energy);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEfficiencyMap::EvalN(const Int_t *flavor, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Double_t *energy, Double_t *out, Int_t n)
+{
+  Int_t i, k, entry, size;
+
+  if(n <= 0) return;
+
+  fill(out, out + n, 0.0);
+
+  if(!flavor)
+  {
+    if(fDefaultEntry >= 0) EvalEntry(fEntries[fDefaultEntry], pt, eta, phi, energy, out, n);
+    return;
+  }
+
+  fPointEntries.resize(n);
+  for(i = 0; i < n; ++i)
+  {
+    fPointEntries[i] = GetEntry(flavor[i]);
+  }
+
+  // gather the candidates of every formula and evaluate them together
+  for(entry = 0; entry < Int_t(fEntries.size()); ++entry)
+  {
+    fSelected.clear();
+    for(i = 0; i < n; ++i)
+    {
+      if(fPointEntries[i] == entry) fSelected.push_back(i);
+    }
+
+    size = fSelected.size();
+    if(size == 0) continue;
+
+    fPT.resize(size);
+    fEta.resize(size);
+    fPhi.resize(size);
+    fEnergy.resize(size);
+    fValues.resize(size);
+
+    for(k = 0; k < size; ++k)
+    {
+      i = fSelected[k];
+      fPT[k] = pt[i];
+      fEta[k] = eta ? eta[i] : 0.0;
+      fPhi[k] = phi ? phi[i] : 0.0;
+      fEnergy[k] = energy ? energy[i] : 0.0;
+    }
+
+    EvalEntry(fEntries[entry], &fPT[0], &fEta[0], &fPhi[0], &fEnergy[0], &fValues[0], size);
+
+    for(k = 0; k < size; ++k)
+    {
+      out[fSelected[k]] = fValues[k];
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
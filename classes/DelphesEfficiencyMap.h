@@ -0,0 +1,100 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DelphesEfficiencyMap_h
+#define DelphesEfficiencyMap_h
+
+/** \class DelphesEfficiencyMap
+ *
+ *  Efficiency formulas indexed by flavor (PDG code of the matched parton),
+ *  flavors without a formula use the formula of flavor 0
+ *  or zero efficiency if there is none.
+ *  Evaluates many candidates at once, grouped by formula.
+ *
+ *  Formulas that depend only on pt and eta can be tabulated
+ *  on a regular (pt, eta) grid, with or without bilinear interpolation.
+ *  Candidates outside of the grid are evaluated with the formula.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <map>
+#include <vector>
+
+class DelphesFormula;
+
+class DelphesEfficiencyMap
+{
+public:
+
+  DelphesEfficiencyMap();
+  ~DelphesEfficiencyMap();
+
+  void Clear();
+
+  void SetFormula(Int_t flavor, const char *expression);
+
+  Bool_t HasFormula(Int_t flavor) const;
+
+  // tabulates formulas for ptMin <= pt <= ptMax and |eta| <= etaMax,
+  // without interpolation every bin has the value at its center
+  void SetTable(Int_t ptBins, Double_t ptMin, Double_t ptMax, Int_t etaBins, Double_t etaMax, Bool_t interpolate);
+
+  Double_t Eval(Int_t flavor, Double_t pt, Double_t eta, Double_t phi = 0.0, Double_t energy = 0.0);
+
+  // flavors are taken as zero if the flavor array is null,
+  // phi and energy are taken as zero if their arrays are null
+  void EvalN(const Int_t *flavor, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Double_t *energy, Double_t *out, Int_t n);
+
+private:
+
+  struct Entry
+  {
+    Entry() : formula(0), tabulated(kFALSE) {}
+    DelphesFormula *formula;
+    Bool_t tabulated;
+    std::vector< Double_t > table;
+  };
+
+  Int_t GetEntry(Int_t flavor) const;
+
+  void BuildTable(Entry &entry);
+  Bool_t Lookup(const Entry &entry, Double_t pt, Double_t eta, Double_t &value) const;
+  void EvalEntry(Entry &entry, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Double_t *energy, Double_t *out, Int_t n);
+
+  std::vector< Entry > fEntries;
+
+  std::map< Int_t, Int_t > fFlavorMap;
+
+  // entries of small flavors, -1 if there is no formula
+  std::vector< Int_t > fFlavorEntries;
+
+  Int_t fDefaultEntry;
+
+  Int_t fPTBins, fEtaBins;
+  Double_t fPTMin, fPTMax, fEtaMax;
+  Double_t fPTScale, fEtaScale;
+  Bool_t fInterpolate;
+
+  std::vector< Int_t > fPointEntries, fSelected;
+  std::vector< Double_t > fPT, fEta, fPhi, fEnergy, fValues;
+};
+
+#endif // DelphesEfficiencyMap_h
@@ -0,0 +1,278 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \class DelphesEtaPhiIndex
+ *
+ *  Per-event cache of eta, phi and pT of the candidates of an array
+ *  and grid of eta-phi cells over these candidates.
+ *  Kinematics of every candidate are computed once when the index is built,
+ *  the grid is filled at the first cone query.
+ *  Cone queries visit only the cells overlapping with the cone
+ *  and select the candidates with the same DeltaR as TLorentzVector::DeltaR.
+ *
+ *  Indices of the arrays used in the current event are kept by DelphesFactory
+ *  and can be shared between modules.
+ *
+ */
+
+#include "classes/DelphesEtaPhiIndex.h"
+#include "classes/DelphesClasses.h"
+
+#include "TMath.h"
+#include "TVector2.h"
+#include "TObjArray.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// limits the number of eta cells for very forward candidates
+static const Int_t kMaxEtaCells = 1000;
+
+// candidates outside of this range go to the first or last eta cell
+static const Double_t kMaxGridEta = 10.0;
+
+//------------------------------------------------------------------------------
+
+DelphesEtaPhiIndex::DelphesEtaPhiIndex(Double_t cellSize) :
+  fCellSize(cellSize), fBuilt(kFALSE), fGridBuilt(kFALSE),
+  fEtaCells(1), fPhiCells(1),
+  fEtaMin(0.0), fEtaWidth(1.0), fPhiWidth(TMath::TwoPi())
+{
+}
+
+//------------------------------------------------------------------------------
+
+DelphesEtaPhiIndex::~DelphesEtaPhiIndex()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEtaPhiIndex::Clear()
+{
+  fBuilt = kFALSE;
+  fGridBuilt = kFALSE;
+  fCandidates.clear();
+  fEta.clear();
+  fPhi.clear();
+  fPT.clear();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEtaPhiIndex::Build(const TObjArray *array)
+{
+  Int_t i, size;
+  Candidate *candidate;
+
+  Clear();
+
+  size = array->GetEntriesFast();
+
+  fCandidates.reserve(size);
+  fEta.reserve(size);
+  fPhi.reserve(size);
+  fPT.reserve(size);
+
+  for(i = 0; i < size; ++i)
+  {
+    candidate = static_cast<Candidate *>(array->At(i));
+
+    if(!candidate)
+    {
+      fCandidates.push_back(0);
+      fEta.push_back(0.0);
+      fPhi.push_back(0.0);
+      fPT.push_back(0.0);
+      continue;
+    }
+
+    Add(candidate, candidate->Momentum);
+  }
+
+  fBuilt = kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEtaPhiIndex::Add(Candidate *candidate, const TLorentzVector &momentum)
+{
+  Double_t pt, pz;
+
+  pt = momentum.Pt();
+  pz = momentum.Pz();
+
+  fCandidates.push_back(candidate);
+
+  // same pseudorapidity as TVector3::PseudoRapidity without the warning for pT = 0
+  if(pt > 0.0)
+  {
+    fEta.push_back(momentum.Eta());
+  }
+  else
+  {
+    fEta.push_back(pz > 0.0 ? 10e10 : (pz < 0.0 ? -10e10 : 0.0));
+  }
+
+  fPhi.push_back(momentum.Phi());
+  fPT.push_back(pt);
+
+  fGridBuilt = kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEtaPhiIndex::BuildGrid()
+{
+  Int_t i, cell, size, cells;
+  Double_t eta, etaMax;
+  Bool_t first;
+  vector< Int_t > entryCells;
+
+  size = fCandidates.size();
+
+  first = kTRUE;
+  fEtaMin = 0.0;
+  etaMax = 0.0;
+
+  for(i = 0; i < size; ++i)
+  {
+    if(!fCandidates[i]) continue;
+    eta = TMath::Range(-kMaxGridEta, kMaxGridEta, fEta[i]);
+    if(first || eta < fEtaMin) fEtaMin = eta;
+    if(first || eta > etaMax) etaMax = eta;
+    first = kFALSE;
+  }
+
+  fEtaCells = TMath::Max(1, Int_t(TMath::Min((etaMax - fEtaMin)/fCellSize, Double_t(kMaxEtaCells))));
+  fEtaWidth = TMath::Max((etaMax - fEtaMin)/fEtaCells, fCellSize);
+
+  fPhiCells = TMath::Max(1, Int_t(TMath::TwoPi()/fCellSize));
+  fPhiWidth = TMath::TwoPi()/fPhiCells;
+
+  cells = fEtaCells*fPhiCells;
+
+  // counting sort of candidates by cell, keeps the order of the input array in each cell
+  fCellStart.assign(cells + 1, 0);
+  fCellEntries.clear();
+  entryCells.resize(size);
+
+  for(i = 0; i < size; ++i)
+  {
+    if(!fCandidates[i]) continue;
+    cell = GetEtaCell(fEta[i])*fPhiCells + GetPhiCell(fPhi[i]);
+    entryCells[i] = cell;
+    ++fCellStart[cell + 1];
+  }
+
+  for(cell = 0; cell < cells; ++cell)
+  {
+    fCellStart[cell + 1] += fCellStart[cell];
+  }
+
+  fCellEntries.resize(fCellStart[cells]);
+
+  for(i = 0; i < size; ++i)
+  {
+    if(!fCandidates[i]) continue;
+    fCellEntries[fCellStart[entryCells[i]]++] = i;
+  }
+
+  for(cell = cells; cell > 0; --cell)
+  {
+    fCellStart[cell] = fCellStart[cell - 1];
+  }
+  fCellStart[0] = 0;
+
+  fGridBuilt = kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+Int_t DelphesEtaPhiIndex::GetEtaCell(Double_t eta) const
+{
+  Double_t cell = (eta - fEtaMin)/fEtaWidth;
+  if(!(cell > 0.0)) return 0;
+  if(cell >= fEtaCells) return fEtaCells - 1;
+  return Int_t(cell);
+}
+
+//------------------------------------------------------------------------------
+
+Int_t DelphesEtaPhiIndex::GetPhiCell(Double_t phi) const
+{
+  Int_t cell = Int_t((phi + TMath::Pi())/fPhiWidth);
+  if(cell < 0) return 0;
+  if(cell >= fPhiCells) return fPhiCells - 1;
+  return cell;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesEtaPhiIndex::Query(Double_t eta, Double_t phi, Double_t deltaRMax, vector< Int_t > &result)
+{
+  Int_t etaCell, etaFirst, etaLast;
+  Int_t phiCell, phiFirst, phiLast, cell;
+  Int_t i, entry, first;
+  Double_t deltaEta, deltaPhi;
+
+  if(fCandidates.empty()) return;
+
+  if(!fGridBuilt) BuildGrid();
+
+  first = result.size();
+
+  etaFirst = GetEtaCell(eta - deltaRMax);
+  etaLast = GetEtaCell(eta + deltaRMax);
+
+  // visit every phi cell only once if the cone covers the whole circle
+  if(2.0*deltaRMax + fPhiWidth >= TMath::TwoPi())
+  {
+    phiFirst = 0;
+    phiLast = fPhiCells - 1;
+  }
+  else
+  {
+    phiFirst = TMath::FloorNint((phi - deltaRMax + TMath::Pi())/fPhiWidth);
+    phiLast = TMath::FloorNint((phi + deltaRMax + TMath::Pi())/fPhiWidth);
+  }
+
+  for(etaCell = etaFirst; etaCell <= etaLast; ++etaCell)
+  {
+    for(phiCell = phiFirst; phiCell <= phiLast; ++phiCell)
+    {
+      cell = etaCell*fPhiCells + (phiCell % fPhiCells + fPhiCells) % fPhiCells;
+      for(i = fCellStart[cell]; i < fCellStart[cell + 1]; ++i)
+      {
+        entry = fCellEntries[i];
+        deltaEta = eta - fEta[entry];
+        deltaPhi = TVector2::Phi_mpi_pi(phi - fPhi[entry]);
+        if(TMath::Sqrt(deltaEta*deltaEta + deltaPhi*deltaPhi) <= deltaRMax)
+        {
+          result.push_back(entry);
+        }
+      }
+    }
+  }
+
+  sort(result.begin() + first, result.end());
+}
+
+//------------------------------------------------------------------------------
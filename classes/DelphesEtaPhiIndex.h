@@ -0,0 +1,96 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesEtaPhiIndex_h
+#define DelphesEtaPhiIndex_h
+
+/** \class DelphesEtaPhiIndex
+ *
+ *  Per-event cache of eta, phi and pT of the candidates of an array
+ *  and grid of eta-phi cells over these candidates.
+ *  Kinematics of every candidate are computed once when the index is built,
+ *  the grid is filled at the first cone query.
+ *  Cone queries visit only the cells overlapping with the cone
+ *  and select the candidates with the same DeltaR as TLorentzVector::DeltaR.
+ *
+ *  Indices of the arrays used in the current event are kept by DelphesFactory
+ *  and can be shared between modules.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class TObjArray;
+class TLorentzVector;
+class Candidate;
+
+class DelphesEtaPhiIndex
+{
+public:
+
+  DelphesEtaPhiIndex(Double_t cellSize = 0.2);
+  ~DelphesEtaPhiIndex();
+
+  void Clear();
+
+  void Build(const TObjArray *array);
+
+  // appends a candidate with the given momentum,
+  // can be used to index momenta that are not stored in a candidate
+  void Add(Candidate *candidate, const TLorentzVector &momentum);
+
+  Bool_t IsBuilt() const { return fBuilt; }
+
+  // appends to result the indices of all candidates with DeltaR <= deltaRMax,
+  // in the order of the input array
+  void Query(Double_t eta, Double_t phi, Double_t deltaRMax, std::vector< Int_t > &result);
+
+  // entries have the same positions as in the input array
+  Int_t GetSize() const { return fCandidates.size(); }
+
+  Candidate *GetCandidate(Int_t i) const { return fCandidates[i]; }
+
+  Double_t GetEta(Int_t i) const { return fEta[i]; }
+  Double_t GetPhi(Int_t i) const { return fPhi[i]; }
+  Double_t GetPT(Int_t i) const { return fPT[i]; }
+
+private:
+
+  void BuildGrid();
+
+  Int_t GetEtaCell(Double_t eta) const;
+  Int_t GetPhiCell(Double_t phi) const;
+
+  Double_t fCellSize;
+
+  Bool_t fBuilt, fGridBuilt;
+
+  Int_t fEtaCells, fPhiCells;
+  Double_t fEtaMin, fEtaWidth, fPhiWidth;
+
+  std::vector< Candidate * > fCandidates;
+  std::vector< Double_t > fEta, fPhi, fPT;
+
+  // candidates of cell i are fCellEntries[fCellStart[i]] ... fCellEntries[fCellStart[i + 1] - 1]
+  std::vector< Int_t > fCellStart;
+  std::vector< Int_t > fCellEntries;
+};
+
+#endif // DelphesEtaPhiIndex_h
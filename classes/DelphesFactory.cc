@@ -28,6 +28,7 @@
 
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesEtaPhiIndex.h"
 
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 
@@ -55,6 +56,12 @@ DelphesFactory::~DelphesFactory()
   {
     delete (itBranches->second);
   }
+
+  map< const TObjArray*, DelphesEtaPhiIndex* >::iterator itIndices;
+  for(itIndices = fEtaPhiIndices.begin(); itIndices != fEtaPhiIndices.end(); ++itIndices)
+  {
+    delete (itIndices->second);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -69,11 +76,21 @@ void DelphesFactory::Clear()
 
   TProcessID::SetObjectCount(0);
 
+  fCandidates.Clear();
+  fArrays.Clear();
+  fDaughters.clear();
+
   map< const TClass*, ExRootTreeBranch* >::iterator itBranches;
   for(itBranches = fBranches.begin(); itBranches != fBranches.end(); ++itBranches)
   {
     itBranches->second->Clear();
   }
+
+  map< const TObjArray*, DelphesEtaPhiIndex* >::iterator itIndices;
+  for(itIndices = fEtaPhiIndices.begin(); itIndices != fEtaPhiIndices.end(); ++itIndices)
+  {
+    itIndices->second->Clear();
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -87,9 +104,28 @@ TObjArray *DelphesFactory::NewPermanentArray()
 
 //------------------------------------------------------------------------------
 
+TObjArray *DelphesFactory::NewArray()
+{
+  TObjArray *array = fArrays.New();
+  array->Clear();
+  return array;
+}
+
+//------------------------------------------------------------------------------
+
+Int_t DelphesFactory::NewDaughters(Int_t size)
+{
+  Int_t offset = fDaughters.size();
+  fDaughters.resize(offset + size);
+  return offset;
+}
+
+//------------------------------------------------------------------------------
+
 Candidate *DelphesFactory::NewCandidate()
 {
-  Candidate *object = New<Candidate>();
+  Candidate *object = fCandidates.New();
+  object->Clear();
   object->SetFactory(this);
   TProcessID::AssignID(object);
   return object;
@@ -97,6 +133,36 @@ Candidate *DelphesFactory::NewCandidate()
 
 //------------------------------------------------------------------------------
 
+DelphesEtaPhiIndex *DelphesFactory::GetEtaPhiIndex(const TObjArray *array)
+{
+  DelphesEtaPhiIndex *index = 0;
+  map< const TObjArray*, DelphesEtaPhiIndex* >::iterator it = fEtaPhiIndices.find(array);
+
+  if(it != fEtaPhiIndices.end())
+  {
+    index = it->second;
+  }
+  else
+  {
+    index = new DelphesEtaPhiIndex;
+    fEtaPhiIndices.insert(make_pair(array, index));
+  }
+
+  if(!index->IsBuilt()) index->Build(array);
+
+  return index;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesFactory::InvalidateEtaPhiIndex(const TObjArray *array)
+{
+  map< const TObjArray*, DelphesEtaPhiIndex* >::iterator it = fEtaPhiIndices.find(array);
+  if(it != fEtaPhiIndices.end()) it->second->Clear();
+}
+
+//------------------------------------------------------------------------------
+
 TObject *DelphesFactory::New(TClass *cl)
 {
   TObject *object = 0;
@@ -30,11 +30,17 @@
 
 #include "TNamed.h"
 
+#if !defined(__CINT__) && !defined(__CLING__)
+#include "classes/DelphesArena.h"
+#endif
+
 #include <map>
 #include <set>
+#include <vector>
 
 class TObjArray;
 class Candidate;
+class DelphesEtaPhiIndex;
 
 class ExRootTreeBranch;
 
@@ -49,10 +55,25 @@ public:
  
   TObjArray *NewPermanentArray();
 
-  TObjArray *NewArray() { return New<TObjArray>(); }
+  TObjArray *NewArray();
 
   Candidate *NewCandidate();
 
+  Int_t NewDaughters(Int_t size);
+
+#if !defined(__CINT__) && !defined(__CLING__)
+  Candidate **GetDaughters(Int_t offset) { return &fDaughters[offset]; }
+
+  // scratch buffer for the leaf IDs collected by Candidate::Overlaps
+  std::vector< UInt_t > &GetLeafBuffer() { return fLeaves; }
+#endif
+
+  // eta-phi index of the candidates of an array, built at the first request in every event,
+  // must be invalidated if the array or the momenta of its candidates are modified later
+  DelphesEtaPhiIndex *GetEtaPhiIndex(const TObjArray *array);
+
+  void InvalidateEtaPhiIndex(const TObjArray *array);
+
   TObject *New(TClass *cl);
 
   template<typename T>
@@ -64,6 +85,15 @@ private:
 
 #if !defined(__CINT__) && !defined(__CLING__)
   std::map< const TClass*, ExRootTreeBranch* > fBranches; //!
+
+  DelphesArena< Candidate > fCandidates; //!
+  DelphesArena< TObjArray > fArrays; //!
+
+  std::vector< Candidate* > fDaughters; //!
+
+  std::vector< UInt_t > fLeaves; //!
+
+  std::map< const TObjArray*, DelphesEtaPhiIndex* > fEtaPhiIndices; //!
 #endif
 
   std::set< TObject* > fPool; //!
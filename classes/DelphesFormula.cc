@@ -19,23 +19,115 @@
 
 #include "classes/DelphesFormula.h"
 
+#include "TMath.h"
 #include "TString.h"
 
+#include <algorithm>
 #include <stdexcept>
 
+#include <string.h>
+#include <stdlib.h>
+
 using namespace std;
 
+namespace
+{
+  // instructions of the stack machine,
+  // unary operations replace the top of the stack,
+  // binary operations replace the two topmost values
+  enum
+  {
+    kConstant, kVariable,
+    kNegate, kNot,
+    kSqrt, kAbs, kExp, kLog, kLog10,
+    kSin, kCos, kTan, kASin, kACos, kATan,
+    kSinh, kCosh, kTanh,
+    kAdd, kSubtract, kMultiply, kDivide, kPower, kATan2,
+    kLess, kLessEqual, kGreater, kGreaterEqual, kEqual, kNotEqual,
+    kAnd, kOr
+  };
+
+  const Int_t kFirstBinary = kAdd;
+
+  const Int_t kMaxDepth = 64;
+  const Int_t kBatchSize = 64;
+
+  struct Function
+  {
+    const char *name;
+    Int_t code;
+    Int_t arguments;
+  };
+
+  const Function kFunctions[] =
+  {
+    {"sqrt", kSqrt, 1}, {"abs", kAbs, 1}, {"fabs", kAbs, 1},
+    {"exp", kExp, 1}, {"log", kLog, 1}, {"log10", kLog10, 1},
+    {"sin", kSin, 1}, {"cos", kCos, 1}, {"tan", kTan, 1},
+    {"asin", kASin, 1}, {"acos", kACos, 1}, {"atan", kATan, 1},
+    {"sinh", kSinh, 1}, {"cosh", kCosh, 1}, {"tanh", kTanh, 1},
+    {"pow", kPower, 2}, {"atan2", kATan2, 2},
+    {0, 0, 0}
+  };
+
+  inline Double_t Apply(Int_t code, Double_t a, Double_t b)
+  {
+    switch(code)
+    {
+      case kNegate: return -a;
+      case kNot: return !a;
+      case kSqrt: return TMath::Sqrt(a);
+      case kAbs: return TMath::Abs(a);
+      case kExp: return TMath::Exp(a);
+      case kLog: return TMath::Log(a);
+      case kLog10: return TMath::Log10(a);
+      case kSin: return TMath::Sin(a);
+      case kCos: return TMath::Cos(a);
+      case kTan: return TMath::Tan(a);
+      case kASin: return TMath::ASin(a);
+      case kACos: return TMath::ACos(a);
+      case kATan: return TMath::ATan(a);
+      case kSinh: return TMath::SinH(a);
+      case kCosh: return TMath::CosH(a);
+      case kTanh: return TMath::TanH(a);
+      case kAdd: return a + b;
+      case kSubtract: return a - b;
+      case kMultiply: return a * b;
+      case kDivide: return a / b;
+      case kPower: return TMath::Power(a, b);
+      case kATan2: return TMath::ATan2(a, b);
+      case kLess: return a < b;
+      case kLessEqual: return a <= b;
+      case kGreater: return a > b;
+      case kGreaterEqual: return a >= b;
+      case kEqual: return a == b;
+      case kNotEqual: return a != b;
+      case kAnd: return a && b;
+      case kOr: return a || b;
+    }
+    return 0.0;
+  }
+
+  inline Bool_t Match(const char *&it, const char *token)
+  {
+    size_t size = strlen(token);
+    if(strncmp(it, token, size) != 0) return kFALSE;
+    it += size;
+    return kTRUE;
+  }
+}
+
 //------------------------------------------------------------------------------
 
 DelphesFormula::DelphesFormula() :
-  TFormula()
+  TFormula(), fMaxDepth(0)
 {
 }
 
 //------------------------------------------------------------------------------
 
 DelphesFormula::DelphesFormula(const char *name, const char *expression) :
-  TFormula()
+  TFormula(), fMaxDepth(0)
 {
 }
 
@@ -64,6 +156,7 @@ Int_t DelphesFormula::Compile(const char *expression)
   {
     throw runtime_error("Invalid formula.");
   }
+  BuildCode(buffer.Data());
   return 0;
 }
 
@@ -72,7 +165,428 @@ Int_t DelphesFormula::Compile(const char *expression)
 Double_t DelphesFormula::Eval(Double_t pt, Double_t eta, Double_t phi, Double_t energy)
 {
    Double_t x[4] = {pt, eta, phi, energy};
-   return EvalPar(x);
+   if(fCode.empty()) return EvalPar(x);
+   return Execute(x);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesFormula::EvalN(const Double_t *pt, const Double_t *eta, const Double_t *phi, const Double_t *energy, Double_t *out, Int_t n)
+{
+  const Double_t *inputs[4] = {pt, eta, phi, energy};
+  const Double_t *input;
+  vector< Instruction >::const_iterator itCode;
+  Double_t *a, *b;
+  Int_t begin, size, top, i;
+
+  if(fCode.empty())
+  {
+    for(i = 0; i < n; ++i)
+    {
+      out[i] = Eval(pt[i], eta ? eta[i] : 0.0, phi ? phi[i] : 0.0, energy ? energy[i] : 0.0);
+    }
+    return;
+  }
+
+  fBatchStack.resize(fMaxDepth*kBatchSize);
+
+  // run every instruction over a block of points
+  for(begin = 0; begin < n; begin += kBatchSize)
+  {
+    size = min(kBatchSize, n - begin);
+    top = -1;
+    for(itCode = fCode.begin(); itCode != fCode.end(); ++itCode)
+    {
+      switch(itCode->code)
+      {
+        case kConstant:
+          a = &fBatchStack[(++top)*kBatchSize];
+          fill(a, a + size, itCode->value);
+          break;
+        case kVariable:
+          a = &fBatchStack[(++top)*kBatchSize];
+          input = inputs[itCode->index];
+          if(input) copy(input + begin, input + begin + size, a);
+          else fill(a, a + size, 0.0);
+          break;
+        case kAdd:
+          a = &fBatchStack[(--top)*kBatchSize];
+          b = a + kBatchSize;
+          for(i = 0; i < size; ++i) a[i] += b[i];
+          break;
+        case kSubtract:
+          a = &fBatchStack[(--top)*kBatchSize];
+          b = a + kBatchSize;
+          for(i = 0; i < size; ++i) a[i] -= b[i];
+          break;
+        case kMultiply:
+          a = &fBatchStack[(--top)*kBatchSize];
+          b = a + kBatchSize;
+          for(i = 0; i < size; ++i) a[i] *= b[i];
+          break;
+        case kDivide:
+          a = &fBatchStack[(--top)*kBatchSize];
+          b = a + kBatchSize;
+          for(i = 0; i < size; ++i) a[i] /= b[i];
+          break;
+        default:
+          if(itCode->code < kFirstBinary)
+          {
+            a = &fBatchStack[top*kBatchSize];
+            for(i = 0; i < size; ++i) a[i] = Apply(itCode->code, a[i], 0.0);
+          }
+          else
+          {
+            a = &fBatchStack[(--top)*kBatchSize];
+            b = a + kBatchSize;
+            for(i = 0; i < size; ++i) a[i] = Apply(itCode->code, a[i], b[i]);
+          }
+      }
+    }
+    copy(fBatchStack.begin(), fBatchStack.begin() + size, out + begin);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::DependsOn(Int_t variable) const
+{
+  vector< Instruction >::const_iterator itCode;
+
+  if(fCode.empty()) return kTRUE;
+
+  for(itCode = fCode.begin(); itCode != fCode.end(); ++itCode)
+  {
+    if(itCode->code == kVariable && itCode->index == variable) return kTRUE;
+  }
+
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+Double_t DelphesFormula::Execute(const Double_t *x) const
+{
+  Double_t stack[kMaxDepth];
+  vector< Instruction >::const_iterator itCode;
+  Int_t top = -1;
+
+  for(itCode = fCode.begin(); itCode != fCode.end(); ++itCode)
+  {
+    switch(itCode->code)
+    {
+      case kConstant:
+        stack[++top] = itCode->value;
+        break;
+      case kVariable:
+        stack[++top] = x[itCode->index];
+        break;
+      default:
+        if(itCode->code < kFirstBinary)
+        {
+          stack[top] = Apply(itCode->code, stack[top], 0.0);
+        }
+        else
+        {
+          --top;
+          stack[top] = Apply(itCode->code, stack[top], stack[top + 1]);
+        }
+    }
+  }
+
+  return stack[0];
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesFormula::BuildCode(const char *expression)
+{
+  vector< Instruction >::const_iterator itCode;
+  const char *it = expression;
+  Int_t depth;
+
+  // expressions that can't be translated are evaluated by TFormula
+  fCode.clear();
+  fMaxDepth = 0;
+
+  if(!ParseOr(it) || *it != 0)
+  {
+    fCode.clear();
+    return;
+  }
+
+  depth = 0;
+  for(itCode = fCode.begin(); itCode != fCode.end(); ++itCode)
+  {
+    if(itCode->code == kConstant || itCode->code == kVariable) ++depth;
+    else if(itCode->code >= kFirstBinary) --depth;
+    fMaxDepth = max(fMaxDepth, depth);
+  }
+
+  if(fMaxDepth > kMaxDepth || !VerifyCode())
+  {
+    fCode.clear();
+    fMaxDepth = 0;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::VerifyCode()
+{
+  static const Double_t pt[] = {0.0, 0.5, 1.5, 7.0, 25.0, 150.0, 2000.0, -1.3};
+  static const Double_t eta[] = {0.0, 0.8, 1.6, 2.4, 3.3, 4.5, -2.1, -0.3};
+  static const Double_t phi[] = {0.0, 1.2, -2.7};
+  static const Double_t energy[] = {0.0, 3.0, 40.0, 900.0};
+  Double_t x[4], a, b;
+  size_t i, j, k, l;
+
+  // compare with TFormula on a grid of points
+  for(i = 0; i < sizeof(pt)/sizeof(Double_t); ++i)
+  for(j = 0; j < sizeof(eta)/sizeof(Double_t); ++j)
+  for(k = 0; k < sizeof(phi)/sizeof(Double_t); ++k)
+  for(l = 0; l < sizeof(energy)/sizeof(Double_t); ++l)
+  {
+    x[0] = pt[i];
+    x[1] = eta[j];
+    x[2] = phi[k];
+    x[3] = energy[l];
+
+    a = Execute(x);
+    b = EvalPar(x);
+
+    if(a == b || (TMath::IsNaN(a) && TMath::IsNaN(b))) continue;
+    if(TMath::Abs(a - b) > 1.0E-9*TMath::Max(TMath::Abs(a), TMath::Abs(b))) return kFALSE;
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesFormula::Emit(Int_t code, Int_t index, Double_t value)
+{
+  Instruction instruction;
+  Int_t size = fCode.size();
+
+  // fold operations on constants
+  if(code >= kFirstBinary && size >= 2 && fCode[size - 2].code == kConstant && fCode[size - 1].code == kConstant)
+  {
+    fCode[size - 2].value = Apply(code, fCode[size - 2].value, fCode[size - 1].value);
+    fCode.pop_back();
+    return;
+  }
+  if(code != kConstant && code != kVariable && code < kFirstBinary && size >= 1 && fCode[size - 1].code == kConstant)
+  {
+    fCode[size - 1].value = Apply(code, fCode[size - 1].value, 0.0);
+    return;
+  }
+
+  instruction.code = code;
+  instruction.index = index;
+  instruction.value = value;
+  fCode.push_back(instruction);
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::ParseOr(const char *&it)
+{
+  if(!ParseAnd(it)) return kFALSE;
+  while(Match(it, "||"))
+  {
+    if(!ParseAnd(it)) return kFALSE;
+    Emit(kOr);
+  }
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::ParseAnd(const char *&it)
+{
+  if(!ParseEquality(it)) return kFALSE;
+  while(Match(it, "&&"))
+  {
+    if(!ParseEquality(it)) return kFALSE;
+    Emit(kAnd);
+  }
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::ParseEquality(const char *&it)
+{
+  Int_t code;
+  if(!ParseRelation(it)) return kFALSE;
+  while(1)
+  {
+    if(Match(it, "==")) code = kEqual;
+    else if(Match(it, "!=")) code = kNotEqual;
+    else return kTRUE;
+    if(!ParseRelation(it)) return kFALSE;
+    Emit(code);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::ParseRelation(const char *&it)
+{
+  Int_t code;
+  if(!ParseSum(it)) return kFALSE;
+  while(1)
+  {
+    if(Match(it, "<=")) code = kLessEqual;
+    else if(Match(it, ">=")) code = kGreaterEqual;
+    else if(*it == '<' && it[1] != '<') code = kLess;
+    else if(*it == '>' && it[1] != '>') code = kGreater;
+    else return kTRUE;
+    if(code == kLess || code == kGreater) ++it;
+    if(!ParseSum(it)) return kFALSE;
+    Emit(code);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::ParseSum(const char *&it)
+{
+  Int_t code;
+  if(!ParseProduct(it)) return kFALSE;
+  while(1)
+  {
+    if(*it == '+') code = kAdd;
+    else if(*it == '-') code = kSubtract;
+    else return kTRUE;
+    ++it;
+    if(!ParseProduct(it)) return kFALSE;
+    Emit(code);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::ParseProduct(const char *&it)
+{
+  Int_t code;
+  if(!ParseUnary(it)) return kFALSE;
+  while(1)
+  {
+    if(*it == '*' && it[1] != '*') code = kMultiply;
+    else if(*it == '/') code = kDivide;
+    else return kTRUE;
+    ++it;
+    if(!ParseUnary(it)) return kFALSE;
+    Emit(code);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::ParseUnary(const char *&it)
+{
+  if(*it == '-')
+  {
+    ++it;
+    if(!ParseUnary(it)) return kFALSE;
+    Emit(kNegate);
+    return kTRUE;
+  }
+  else if(*it == '+')
+  {
+    ++it;
+    return ParseUnary(it);
+  }
+  else if(*it == '!' && it[1] != '=')
+  {
+    ++it;
+    if(!ParseUnary(it)) return kFALSE;
+    Emit(kNot);
+    return kTRUE;
+  }
+  return ParsePower(it);
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::ParsePower(const char *&it)
+{
+  if(!ParsePrimary(it)) return kFALSE;
+  if(*it == '^')
+  {
+    ++it;
+    // right associative
+    if(!ParseUnary(it)) return kFALSE;
+    Emit(kPower);
+  }
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::ParsePrimary(const char *&it)
+{
+  const Function *function;
+  const char *begin;
+  char *end;
+  Int_t i;
+  size_t size;
+
+  if(*it == '(')
+  {
+    ++it;
+    if(!ParseOr(it) || *it != ')') return kFALSE;
+    ++it;
+    return kTRUE;
+  }
+
+  if((*it >= '0' && *it <= '9') || *it == '.')
+  {
+    Emit(kConstant, 0, strtod(it, &end));
+    if(end == it) return kFALSE;
+    it = end;
+    return kTRUE;
+  }
+
+  begin = it;
+  while((*it >= 'a' && *it <= 'z') || (*it >= 'A' && *it <= 'Z') || (*it >= '0' && *it <= '9') || *it == '_') ++it;
+  size = it - begin;
+  if(size == 0) return kFALSE;
+
+  if(*it != '(')
+  {
+    if(size == 1 && strchr("xyzt", *begin))
+    {
+      Emit(kVariable, strchr("xyzt", *begin) - "xyzt");
+      return kTRUE;
+    }
+    if(size == 2 && strncmp(begin, "pi", 2) == 0)
+    {
+      Emit(kConstant, 0, TMath::Pi());
+      return kTRUE;
+    }
+    return kFALSE;
+  }
+
+  for(function = kFunctions; function->name; ++function)
+  {
+    if(strlen(function->name) == size && strncmp(begin, function->name, size) == 0) break;
+  }
+  if(!function->name) return kFALSE;
+
+  ++it;
+  for(i = 0; i < function->arguments; ++i)
+  {
+    if(i > 0 && !Match(it, ",")) return kFALSE;
+    if(!ParseOr(it)) return kFALSE;
+  }
+  if(*it != ')') return kFALSE;
+  ++it;
+
+  Emit(function->code);
+  return kTRUE;
 }
 
 //------------------------------------------------------------------------------
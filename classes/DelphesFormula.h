@@ -21,6 +21,8 @@
 
 #include "TFormula.h"
 
+#include <vector>
+
 class DelphesFormula: public TFormula
 {
 public:
@@ -34,6 +36,44 @@ public:
   Int_t Compile(const char *expression);
 
   Double_t Eval(Double_t pt, Double_t eta = 0, Double_t phi = 0, Double_t energy = 0);
+
+  // evaluate n points at once, eta, phi and energy are taken as zero if their arrays are null
+  void EvalN(const Double_t *pt, const Double_t *eta, const Double_t *phi, const Double_t *energy, Double_t *out, Int_t n);
+
+  // variable: 0 - pt, 1 - eta, 2 - phi, 3 - energy,
+  // always true for expressions evaluated by TFormula
+  Bool_t DependsOn(Int_t variable) const;
+
+private:
+
+  struct Instruction
+  {
+    Int_t code;
+    Int_t index;
+    Double_t value;
+  };
+
+  void BuildCode(const char *expression);
+  Bool_t VerifyCode();
+
+  void Emit(Int_t code, Int_t index = 0, Double_t value = 0.0);
+
+  Bool_t ParseOr(const char *&it);
+  Bool_t ParseAnd(const char *&it);
+  Bool_t ParseEquality(const char *&it);
+  Bool_t ParseRelation(const char *&it);
+  Bool_t ParseSum(const char *&it);
+  Bool_t ParseProduct(const char *&it);
+  Bool_t ParseUnary(const char *&it);
+  Bool_t ParsePower(const char *&it);
+  Bool_t ParsePrimary(const char *&it);
+
+  Double_t Execute(const Double_t *x) const;
+
+  std::vector< Instruction > fCode; //!
+  Int_t fMaxDepth; //!
+
+  std::vector< Double_t > fBatchStack; //!
 };
 
 #endif /* DelphesFormula_h */
@@ -35,6 +35,7 @@
 #include <vector>
 
 #include <stdio.h>
+#include <string.h>
 
 #include "TObjArray.h"
 #include "TStopwatch.h"
@@ -50,57 +51,221 @@
 
 using namespace std;
 
-static const int kBufferSize  = 1024;
+static const size_t kBufferSize = 1 << 20;
+
+// vertex codes from -kMaxTableSize + 1 to 0 are stored in the tables
+static const int kMaxTableSize = 1 << 20;
 
 //---------------------------------------------------------------------------
 
 DelphesHepMCReader::DelphesHepMCReader() :
-  fInputFile(0), fBuffer(0), fPDG(0),
-  fVertexCounter(-1), fInCounter(-1), fOutCounter(-1),
-  fParticleCounter(0)
+  fInputFile(0), fBuffer(0), fBufferStart(0), fBufferEnd(0),
+  fBufferSize(kBufferSize), fEndOfFile(false), fPDG(0), fCurrentEvent(0)
 {
-  fBuffer = new char[kBufferSize];
+  fBuffer = new char[fBufferSize];
+  fBufferStart = fBuffer;
+  fBufferEnd = fBuffer;
 
   fPDG = TDatabasePDG::Instance();
+
+  ClearEvent(fEvent);
 }
 
 //---------------------------------------------------------------------------
 
 DelphesHepMCReader::~DelphesHepMCReader()
 {
+  Stop();
+
   if(fBuffer) delete[] fBuffer;
 }
 
 //---------------------------------------------------------------------------
 
+void DelphesHepMCReader::SetPipelineDepth(int depth)
+{
+  fCurrentEvent = 0;
+
+  SetDepth(depth);
+}
+
+//---------------------------------------------------------------------------
+
 void DelphesHepMCReader::SetInputFile(FILE *inputFile)
 {
+  Stop();
+
   fInputFile = inputFile;
+  fBufferStart = fBuffer;
+  fBufferEnd = fBuffer;
+  fEndOfFile = false;
+
+  if(inputFile) StartReading();
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesHepMCReader::Stop()
+{
+  StopReading();
+
+  fCurrentEvent = 0;
+}
+
+//---------------------------------------------------------------------------
+
+bool DelphesHepMCReader::ReadRecord(TEventRecord &event)
+{
+  char *line;
+  bool complete;
+
+  ClearEvent(event);
+
+  complete = false;
+  while(!complete)
+  {
+    line = ReadLine();
+    if(!line || !ParseLine(line, event, complete)) return false;
+  }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+char *DelphesHepMCReader::ReadLine()
+{
+  char *line, *end, *buffer;
+  size_t size, count;
+
+  while(true)
+  {
+    end = static_cast<char *>(memchr(fBufferStart, '\n', fBufferEnd - fBufferStart));
+    if(end)
+    {
+      *end = '\0';
+      line = fBufferStart;
+      fBufferStart = end + 1;
+      return line;
+    }
+
+    size = fBufferEnd - fBufferStart;
+
+    if(fEndOfFile)
+    {
+      // last line without end of line character
+      if(size == 0) return 0;
+      *fBufferEnd = '\0';
+      line = fBufferStart;
+      fBufferStart = fBufferEnd;
+      return line;
+    }
+
+    // move the incomplete line to the beginning of the buffer,
+    // one byte is kept free to terminate the last line
+    if(size + 1 >= fBufferSize)
+    {
+      fBufferSize *= 2;
+      buffer = new char[fBufferSize];
+      memcpy(buffer, fBufferStart, size);
+      delete[] fBuffer;
+      fBuffer = buffer;
+    }
+    else if(fBufferStart != fBuffer)
+    {
+      memmove(fBuffer, fBufferStart, size);
+    }
+
+    fBufferStart = fBuffer;
+    fBufferEnd = fBuffer + size;
+
+    // the reading thread gives up between blocks once it is stopped
+    if(IsStopping()) return 0;
+
+    count = fread(fBufferEnd, 1, fBufferSize - size - 1, fInputFile);
+    if(count == 0) fEndOfFile = true;
+    fBufferEnd += count;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+pair< int, int > *DelphesHepMCReader::AddVertex(vector< pair< int, int > > &table,
+  map< int, pair< int, int > > &vertexMap, int code)
+{
+  if(code <= 0 && code > -kMaxTableSize)
+  {
+    if(size_t(-code) >= table.size()) table.resize(-code + 1, make_pair(-1, -1));
+    return &table[-code];
+  }
+  return &vertexMap.insert(make_pair(code, make_pair(-1, -1))).first->second;
+}
+
+//---------------------------------------------------------------------------
+
+const pair< int, int > *DelphesHepMCReader::FindVertex(const vector< pair< int, int > > &table,
+  const map< int, pair< int, int > > &vertexMap, int code)
+{
+  map< int, pair< int, int > >::const_iterator itMap;
+
+  if(code <= 0 && code > -kMaxTableSize)
+  {
+    if(size_t(-code) >= table.size() || table[-code].first < 0) return 0;
+    return &table[-code];
+  }
+
+  itMap = vertexMap.find(code);
+  if(itMap == vertexMap.end()) return 0;
+  return &itMap->second;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesHepMCReader::ClearEvent(TEventRecord &event)
+{
+  event.stateSize = 0;
+  event.state.clear();
+  event.weightSize = 0;
+  event.weight.clear();
+  event.momentumCoefficient = 1.0;
+  event.positionCoefficient = 1.0;
+  event.vertexCounter = -1;
+  event.inCounter = -1;
+  event.outCounter = -1;
+  event.particles.clear();
+  event.motherTable.clear();
+  event.daughterTable.clear();
+  event.motherMap.clear();
+  event.daughterMap.clear();
+}
+
+//---------------------------------------------------------------------------
+
+bool DelphesHepMCReader::EventReady(const TEventRecord &event)
+{
+  return (event.vertexCounter == 0) && (event.inCounter == 0) && (event.outCounter == 0);
 }
 
 //---------------------------------------------------------------------------
 
 void DelphesHepMCReader::Clear()
 {
-  fStateSize = 0;
-  fState.clear();
-  fWeightSize = 0;
-  fWeight.clear();
-  fMomentumCoefficient = 1.0;
-  fPositionCoefficient = 1.0;
-  fVertexCounter = -1;
-  fInCounter = -1;
-  fOutCounter = -1;
-  fMotherMap.clear();
-  fDaughterMap.clear();
-  fParticleCounter = 0;
+  if(!IsReading())
+  {
+    ClearEvent(fEvent);
+  }
+  else if(fCurrentEvent)
+  {
+    ReleaseRecord(fCurrentEvent);
+    fCurrentEvent = 0;
+  }
 }
 
 //---------------------------------------------------------------------------
 
 bool DelphesHepMCReader::EventReady()
 {
-  return (fVertexCounter == 0) && (fInCounter == 0) && (fOutCounter == 0);
+  return IsReading() ? fCurrentEvent != 0 : EventReady(fEvent);
 }
 
 //---------------------------------------------------------------------------
@@ -110,195 +275,337 @@ bool DelphesHepMCReader::ReadBlock(DelphesFactory *factory,
   TObjArray *stableParticleOutputArray,
   TObjArray *partonOutputArray)
 {
-  map< int, pair< int, int > >::iterator itMotherMap;
-  map< int, pair< int, int > >::iterator itDaughterMap;
+  TEventRecord *event;
+  char *line;
+  bool complete;
+
+  if(IsReading())
+  {
+    // the whole next event is taken at once
+    if(fCurrentEvent)
+    {
+      ReleaseRecord(fCurrentEvent);
+      fCurrentEvent = 0;
+    }
+
+    event = NextRecord();
+    if(!event) return kFALSE;
+
+    if(factory)
+    {
+      AddParticles(*event, factory, allParticleOutputArray,
+        stableParticleOutputArray, partonOutputArray);
+    }
+
+    fCurrentEvent = event;
+
+    return kTRUE;
+  }
+
+  line = ReadLine();
+  if(!line) return kFALSE;
+
+  if(!ParseLine(line, fEvent, complete)) return kFALSE;
+
+  if(complete && factory)
+  {
+    AddParticles(fEvent, factory, allParticleOutputArray,
+      stableParticleOutputArray, partonOutputArray);
+  }
+
+  return kTRUE;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesHepMCReader::WriteEvent(vector< char > &buffer)
+{
+  const TEventRecord *event;
+
+  event = fCurrentEvent ? fCurrentEvent : &fEvent;
+
+  // only the values used by AnalyzeEvent and AddParticles are written
+  buffer.clear();
+
+  WriteValue(buffer, event->eventNumber);
+  WriteValue(buffer, event->processID);
+  WriteValue(buffer, event->mpi);
+  WriteValue(buffer, event->scale);
+  WriteValue(buffer, event->alphaQED);
+  WriteValue(buffer, event->alphaQCD);
+
+  WriteValue(buffer, event->id1);
+  WriteValue(buffer, event->id2);
+  WriteValue(buffer, event->x1);
+  WriteValue(buffer, event->x2);
+  WriteValue(buffer, event->scalePDF);
+  WriteValue(buffer, event->pdf1);
+  WriteValue(buffer, event->pdf2);
+
+  WriteArray(buffer, event->weight);
+  WriteArray(buffer, event->particles);
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesHepMCReader::ReadEvent(const vector< char > &buffer, DelphesFactory *factory,
+  TObjArray *allParticleOutputArray,
+  TObjArray *stableParticleOutputArray,
+  TObjArray *partonOutputArray)
+{
+  size_t position = 0;
+
+  ClearEvent(fEvent);
+
+  ReadValue(buffer, position, fEvent.eventNumber);
+  ReadValue(buffer, position, fEvent.processID);
+  ReadValue(buffer, position, fEvent.mpi);
+  ReadValue(buffer, position, fEvent.scale);
+  ReadValue(buffer, position, fEvent.alphaQED);
+  ReadValue(buffer, position, fEvent.alphaQCD);
+
+  ReadValue(buffer, position, fEvent.id1);
+  ReadValue(buffer, position, fEvent.id2);
+  ReadValue(buffer, position, fEvent.x1);
+  ReadValue(buffer, position, fEvent.x2);
+  ReadValue(buffer, position, fEvent.scalePDF);
+  ReadValue(buffer, position, fEvent.pdf1);
+  ReadValue(buffer, position, fEvent.pdf2);
+
+  ReadArray(buffer, position, fEvent.weight);
+  ReadArray(buffer, position, fEvent.particles);
+
+  AddParticles(fEvent, factory, allParticleOutputArray,
+    stableParticleOutputArray, partonOutputArray);
+}
+
+//---------------------------------------------------------------------------
+
+bool DelphesHepMCReader::ParseLine(char *line, TEventRecord &event, bool &complete)
+{
+  TParticleRecord *particle;
+  pair< int, int > *vertex;
   char key, momentumUnit[4], positionUnit[3];
-  int i, rc, state;
-  double weight;
+  int i, rc, state, particleCode, pid, status, inVertexCode, counter;
+  double weight, px, py, pz, e, mass, theta, phi;
 
-  if(!fgets(fBuffer, kBufferSize, fInputFile)) return kFALSE;
+  DelphesStream bufferStream(line + 1);
 
-  DelphesStream bufferStream(fBuffer + 1);
+  key = line[0];
 
-  key = fBuffer[0];
+  complete = false;
 
   if(key == 'E')
   {
-    Clear();
-
-    rc = bufferStream.ReadInt(fEventNumber)
-      && bufferStream.ReadInt(fMPI)
-      && bufferStream.ReadDbl(fScale)
-      && bufferStream.ReadDbl(fAlphaQCD)
-      && bufferStream.ReadDbl(fAlphaQED)
-      && bufferStream.ReadInt(fProcessID)
-      && bufferStream.ReadInt(fSignalCode)
-      && bufferStream.ReadInt(fVertexCounter)
-      && bufferStream.ReadInt(fBeamCode[0])
-      && bufferStream.ReadInt(fBeamCode[1])
-      && bufferStream.ReadInt(fStateSize);
+    ClearEvent(event);
+
+    rc = bufferStream.ReadInt(event.eventNumber)
+      && bufferStream.ReadInt(event.mpi)
+      && bufferStream.ReadDbl(event.scale)
+      && bufferStream.ReadDbl(event.alphaQCD)
+      && bufferStream.ReadDbl(event.alphaQED)
+      && bufferStream.ReadInt(event.processID)
+      && bufferStream.ReadInt(event.signalCode)
+      && bufferStream.ReadInt(event.vertexCounter)
+      && bufferStream.ReadInt(event.beamCode[0])
+      && bufferStream.ReadInt(event.beamCode[1])
+      && bufferStream.ReadInt(event.stateSize);
 
     if(!rc)
     {
       cerr << "** ERROR: " << "invalid event format" << endl;
-      return kFALSE;
+      return false;
     }
 
-    for(i = 0; i < fStateSize; ++i)
+    for(i = 0; i < event.stateSize; ++i)
     {
       rc = rc && bufferStream.ReadInt(state);
-      fState.push_back(state);
+      event.state.push_back(state);
     }
 
-    rc = rc && bufferStream.ReadInt(fWeightSize);
+    rc = rc && bufferStream.ReadInt(event.weightSize);
 
     if(!rc)
     {
       cerr << "** ERROR: " << "invalid event format" << endl;
-      return kFALSE;
+      return false;
     }
 
-    for(i = 0; i < fWeightSize; ++i)
+    for(i = 0; i < event.weightSize; ++i)
     {
       rc = rc && bufferStream.ReadDbl(weight);
-      fWeight.push_back(weight);
+      event.weight.push_back(weight);
     }
 
     if(!rc)
     {
       cerr << "** ERROR: " << "invalid event format" << endl;
-      return kFALSE;
+      return false;
     }
   }
   else if(key == 'U')
   {
-    rc = sscanf(fBuffer + 1, "%3s %2s", momentumUnit, positionUnit);
+    rc = sscanf(line + 1, "%3s %2s", momentumUnit, positionUnit);
 
     if(rc != 2)
     {
       cerr << "** ERROR: " << "invalid units format" << endl;
-      return kFALSE;
+      return false;
     }
 
     if(strncmp(momentumUnit, "GEV", 3) == 0)
     {
-      fMomentumCoefficient = 1.0;
+      event.momentumCoefficient = 1.0;
     }
     else if(strncmp(momentumUnit, "MEV", 3) == 0)
     {
-      fMomentumCoefficient = 0.001;
+      event.momentumCoefficient = 0.001;
     }
     
     if(strncmp(positionUnit, "MM", 3) == 0)
     {
-      fPositionCoefficient = 1.0;
+      event.positionCoefficient = 1.0;
     }
     else if(strncmp(positionUnit, "CM", 3) == 0)
     {
-      fPositionCoefficient = 10.0;
+      event.positionCoefficient = 10.0;
     }
   }
   else if(key == 'F')
   {
-    rc = bufferStream.ReadInt(fID1)
-      && bufferStream.ReadInt(fID2)
-      && bufferStream.ReadDbl(fX1)
-      && bufferStream.ReadDbl(fX2)
-      && bufferStream.ReadDbl(fScalePDF)
-      && bufferStream.ReadDbl(fPDF1)
-      && bufferStream.ReadDbl(fPDF2);
+    rc = bufferStream.ReadInt(event.id1)
+      && bufferStream.ReadInt(event.id2)
+      && bufferStream.ReadDbl(event.x1)
+      && bufferStream.ReadDbl(event.x2)
+      && bufferStream.ReadDbl(event.scalePDF)
+      && bufferStream.ReadDbl(event.pdf1)
+      && bufferStream.ReadDbl(event.pdf2);
 
     if(!rc)
     {
       cerr << "** ERROR: " << "invalid PDF format" << endl;
-      return kFALSE;
+      return false;
     }
   }
-  else if(key == 'V' && fVertexCounter > 0)
+  else if(key == 'V' && event.vertexCounter > 0)
   {
-    rc = bufferStream.ReadInt(fOutVertexCode)
-      && bufferStream.ReadInt(fVertexID)
-      && bufferStream.ReadDbl(fX)
-      && bufferStream.ReadDbl(fY)
-      && bufferStream.ReadDbl(fZ)
-      && bufferStream.ReadDbl(fT)
-      && bufferStream.ReadInt(fInCounter)
-      && bufferStream.ReadInt(fOutCounter);
+    rc = bufferStream.ReadInt(event.outVertexCode)
+      && bufferStream.ReadInt(event.vertexID)
+      && bufferStream.ReadDbl(event.x)
+      && bufferStream.ReadDbl(event.y)
+      && bufferStream.ReadDbl(event.z)
+      && bufferStream.ReadDbl(event.t)
+      && bufferStream.ReadInt(event.inCounter)
+      && bufferStream.ReadInt(event.outCounter);
 
     if(!rc)
     {
       cerr << "** ERROR: " << "invalid vertex format" << endl;
-      return kFALSE;
+      return false;
     }
-    --fVertexCounter;
+    --event.vertexCounter;
+
+    complete = EventReady(event);
   }
-  else if(key == 'P' && fOutCounter > 0)
+  else if(key == 'P' && event.outCounter > 0)
   {
-    rc = bufferStream.ReadInt(fParticleCode)
-      && bufferStream.ReadInt(fPID)
-      && bufferStream.ReadDbl(fPx)
-      && bufferStream.ReadDbl(fPy)
-      && bufferStream.ReadDbl(fPz)
-      && bufferStream.ReadDbl(fE)
-      && bufferStream.ReadDbl(fMass)
-      && bufferStream.ReadInt(fStatus)
-      && bufferStream.ReadDbl(fTheta)
-      && bufferStream.ReadDbl(fPhi)
-      && bufferStream.ReadInt(fInVertexCode);
+    rc = bufferStream.ReadInt(particleCode)
+      && bufferStream.ReadInt(pid)
+      && bufferStream.ReadDbl(px)
+      && bufferStream.ReadDbl(py)
+      && bufferStream.ReadDbl(pz)
+      && bufferStream.ReadDbl(e)
+      && bufferStream.ReadDbl(mass)
+      && bufferStream.ReadInt(status)
+      && bufferStream.ReadDbl(theta)
+      && bufferStream.ReadDbl(phi)
+      && bufferStream.ReadInt(inVertexCode);
 
     if(!rc)
     {
       cerr << "** ERROR: " << "invalid particle format" << endl;
-      return kFALSE;
+      return false;
     }
 
-    if(fInVertexCode < 0)
+    counter = event.particles.size();
+
+    if(inVertexCode < 0)
     {
-      itMotherMap = fMotherMap.find(fInVertexCode);
-      if(itMotherMap == fMotherMap.end())
+      vertex = AddVertex(event.motherTable, event.motherMap, inVertexCode);
+      if(vertex->first < 0)
       {
-        fMotherMap[fInVertexCode] = make_pair(fParticleCounter, -1);
+        *vertex = make_pair(counter, -1);
       }
       else
       {
-        itMotherMap->second.second = fParticleCounter;
+        vertex->second = counter;
       }
     }
 
-    if(fInCounter <= 0)
+    if(event.inCounter <= 0)
     {
-      itDaughterMap = fDaughterMap.find(fOutVertexCode);
-      if(itDaughterMap == fDaughterMap.end())
+      vertex = AddVertex(event.daughterTable, event.daughterMap, event.outVertexCode);
+      if(vertex->first < 0)
       {
-        fDaughterMap[fOutVertexCode] = make_pair(fParticleCounter, fParticleCounter);
+        *vertex = make_pair(counter, counter);
       }
       else
       {
-        itDaughterMap->second.second = fParticleCounter;
+        vertex->second = counter;
       }
     }
 
-    AnalyzeParticle(factory, allParticleOutputArray,
-      stableParticleOutputArray, partonOutputArray);
+    event.particles.push_back(TParticleRecord());
+    particle = &event.particles.back();
 
-    if(fInCounter > 0)
+    particle->pid = pid;
+    particle->status = status;
+    particle->mass = mass;
+
+    particle->px = px*event.momentumCoefficient;
+    particle->py = py*event.momentumCoefficient;
+    particle->pz = pz*event.momentumCoefficient;
+    particle->e = e*event.momentumCoefficient;
+
+    // vertex codes are replaced by particle numbers in FinalizeParticles
+    particle->m2 = 1;
+    particle->d2 = 1;
+    if(event.inCounter > 0)
     {
-      --fInCounter;
+      particle->m1 = 1;
+      particle->x = 0.0;
+      particle->y = 0.0;
+      particle->z = 0.0;
+      particle->t = 0.0;
     }
     else
     {
-      --fOutCounter;
+      particle->m1 = event.outVertexCode;
+      particle->x = event.x*event.positionCoefficient;
+      particle->y = event.y*event.positionCoefficient;
+      particle->z = event.z*event.positionCoefficient;
+      particle->t = event.t*event.positionCoefficient;
     }
+    particle->d1 = inVertexCode < 0 ? inVertexCode : 1;
 
-    ++fParticleCounter;
+    if(event.inCounter > 0)
+    {
+      --event.inCounter;
+    }
+    else
+    {
+      --event.outCounter;
+    }
+
+    complete = EventReady(event);
   }
 
-  if(EventReady())
+  if(complete)
   {
-    FinalizeParticles(allParticleOutputArray);
+    FinalizeParticles(event);
   }
 
-  return kTRUE;
+  return true;
 }
 
 //---------------------------------------------------------------------------
@@ -306,25 +613,28 @@ bool DelphesHepMCReader::ReadBlock(DelphesFactory *factory,
 void DelphesHepMCReader::AnalyzeEvent(ExRootTreeBranch *branch, long long eventNumber,
   TStopwatch *readStopWatch, TStopwatch *procStopWatch)
 {
+  const TEventRecord *event;
   HepMCEvent *element;
 
+  event = fCurrentEvent ? fCurrentEvent : &fEvent;
+
   element = static_cast<HepMCEvent *>(branch->NewEntry());
-  element->Number = fEventNumber;
-
-  element->ProcessID = fProcessID;
-  element->MPI = fMPI;
-  element->Weight = fWeight.size() > 0 ? fWeight[0] : 1.0;
-  element->Scale = fScale;
-  element->AlphaQED = fAlphaQED;
-  element->AlphaQCD = fAlphaQCD;
-
-  element->ID1 = fID1;
-  element->ID2 = fID2;
-  element->X1 = fX1;
-  element->X2 = fX2;
-  element->ScalePDF = fScalePDF;
-  element->PDF1 = fPDF1;
-  element->PDF2 = fPDF2;
+  element->Number = event->eventNumber;
+
+  element->ProcessID = event->processID;
+  element->MPI = event->mpi;
+  element->Weight = event->weight.size() > 0 ? event->weight[0] : 1.0;
+  element->Scale = event->scale;
+  element->AlphaQED = event->alphaQED;
+  element->AlphaQCD = event->alphaQCD;
+
+  element->ID1 = event->id1;
+  element->ID2 = event->id2;
+  element->X1 = event->x1;
+  element->X2 = event->x2;
+  element->ScalePDF = event->scalePDF;
+  element->PDF1 = event->pdf1;
+  element->PDF2 = event->pdf2;
 
   element->ReadTime = readStopWatch->RealTime();
   element->ProcTime = procStopWatch->RealTime();
@@ -332,120 +642,97 @@ void DelphesHepMCReader::AnalyzeEvent(ExRootTreeBranch *branch, long long eventN
 
 //---------------------------------------------------------------------------
 
-void DelphesHepMCReader::AnalyzeParticle(DelphesFactory *factory,
+void DelphesHepMCReader::AddParticles(const TEventRecord &event, DelphesFactory *factory,
   TObjArray *allParticleOutputArray,
   TObjArray *stableParticleOutputArray,
   TObjArray *partonOutputArray)
 {
+  vector< TParticleRecord >::const_iterator itParticles;
   Candidate *candidate;
   TParticlePDG *pdgParticle;
   int pdgCode;
 
-  candidate = factory->NewCandidate();
+  for(itParticles = event.particles.begin(); itParticles != event.particles.end(); ++itParticles)
+  {
+    candidate = factory->NewCandidate();
 
-  candidate->PID = fPID;
-  pdgCode = TMath::Abs(candidate->PID);
+    candidate->PID = itParticles->pid;
+    pdgCode = TMath::Abs(candidate->PID);
 
-  candidate->Status = fStatus;
+    candidate->Status = itParticles->status;
 
-  pdgParticle = fPDG->GetParticle(fPID);
-  candidate->Charge = pdgParticle ? int(pdgParticle->Charge()/3.0) : -999;
-  candidate->Mass = fMass;
+    pdgParticle = fPDG->GetParticle(itParticles->pid);
+    candidate->Charge = pdgParticle ? int(pdgParticle->Charge()/3.0) : -999;
+    candidate->Mass = itParticles->mass;
 
-  candidate->Momentum.SetPxPyPzE(fPx, fPy, fPz, fE);
-  if(fMomentumCoefficient != 1.0)
-  {
-    candidate->Momentum *= fMomentumCoefficient;
-  }
+    candidate->Momentum.SetPxPyPzE(itParticles->px, itParticles->py, itParticles->pz, itParticles->e);
+    candidate->Position.SetXYZT(itParticles->x, itParticles->y, itParticles->z, itParticles->t);
 
-  candidate->M2 = 1;
-  candidate->D2 = 1;
-  if(fInCounter > 0)
-  {
-    candidate->M1 = 1;
-    candidate->Position.SetXYZT(0.0, 0.0, 0.0, 0.0);
-  }
-  else
-  {
-    candidate->M1 = fOutVertexCode;
-    candidate->Position.SetXYZT(fX, fY, fZ, fT);
-    if(fPositionCoefficient != 1.0)
-    {
-      candidate->Position *= fPositionCoefficient;
-    }
-  }
-  if(fInVertexCode < 0)
-  {
-    candidate->D1 = fInVertexCode;
-  }
-  else
-  {
-    candidate->D1 = 1;
-  }
+    candidate->M1 = itParticles->m1;
+    candidate->M2 = itParticles->m2;
+    candidate->D1 = itParticles->d1;
+    candidate->D2 = itParticles->d2;
 
-  allParticleOutputArray->Add(candidate);
+    allParticleOutputArray->Add(candidate);
 
-  if(!pdgParticle) return;
+    if(!pdgParticle) continue;
 
-  if(fStatus == 1 && pdgParticle->Stable())
-  {
-    stableParticleOutputArray->Add(candidate);
-  }
-  else if(pdgCode <= 5 || pdgCode == 21 || pdgCode == 15)
-  {
-    partonOutputArray->Add(candidate);
+    if(itParticles->status == 1 && pdgParticle->Stable())
+    {
+      stableParticleOutputArray->Add(candidate);
+    }
+    else if(pdgCode <= 5 || pdgCode == 21 || pdgCode == 15)
+    {
+      partonOutputArray->Add(candidate);
+    }
   }
 }
 
 //---------------------------------------------------------------------------
 
-void DelphesHepMCReader::FinalizeParticles(TObjArray *allParticleOutputArray)
+void DelphesHepMCReader::FinalizeParticles(TEventRecord &event)
 {
-  Candidate *candidate;
-  map< int, pair< int, int > >::iterator itMotherMap;
-  map< int, pair< int, int > >::iterator itDaughterMap;
-  int i;
+  vector< TParticleRecord >::iterator itParticles;
+  const pair< int, int > *vertex;
 
-  for(i = 0; i < allParticleOutputArray->GetEntriesFast(); ++i)
+  for(itParticles = event.particles.begin(); itParticles != event.particles.end(); ++itParticles)
   {
-    candidate = static_cast<Candidate *>(allParticleOutputArray->At(i));
-
-    if(candidate->M1 > 0)
+    if(itParticles->m1 > 0)
     {
-      candidate->M1 = -1;
-      candidate->M2 = -1;
+      itParticles->m1 = -1;
+      itParticles->m2 = -1;
     }
     else
     {
-      itMotherMap = fMotherMap.find(candidate->M1);
-      if(itMotherMap == fMotherMap.end())
+      vertex = FindVertex(event.motherTable, event.motherMap, itParticles->m1);
+      if(!vertex)
       {
-        candidate->M1 = -1;
-        candidate->M2 = -1;
+        itParticles->m1 = -1;
+        itParticles->m2 = -1;
       }
       else
       {
-        candidate->M1 = itMotherMap->second.first;
-        candidate->M2 = itMotherMap->second.second;
+        itParticles->m1 = vertex->first;
+        itParticles->m2 = vertex->second;
       }
     }
-    if(candidate->D1 > 0)
+    if(itParticles->d1 > 0)
     {
-      candidate->D1 = -1;
-      candidate->D2 = -1;
+      itParticles->d1 = -1;
+      itParticles->d2 = -1;
     }
     else
     {
-      itDaughterMap = fDaughterMap.find(candidate->D1);
-      if(itDaughterMap == fDaughterMap.end())
+      vertex = FindVertex(event.daughterTable, event.daughterMap, itParticles->d1);
+      if(!vertex)
       {
-        candidate->D1 = -1;
-        candidate->D2 = -1;
+        itParticles->d1 = -1;
+        itParticles->d2 = -1;
       }
       else
       {
-        candidate->D1 = itDaughterMap->second.first;
-        candidate->D2 = itDaughterMap->second.second;
+        itParticles->d1 = vertex->first;
+        itParticles->d2 = vertex->second;
       }
     }
   }
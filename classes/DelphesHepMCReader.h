@@ -32,73 +32,138 @@
 
 #include <stdio.h>
 
+#include "classes/DelphesReadAhead.h"
+
 class TObjArray;
 class TStopwatch;
 class TDatabasePDG;
 class ExRootTreeBranch;
 class DelphesFactory;
 
-class DelphesHepMCReader
+// event parsed without ROOT objects, so that it can be filled in the reading thread
+struct DelphesHepMCRecord
+{
+  // particle with momentum and position in GeV and mm
+  struct TParticle
+  {
+    int pid, status, m1, m2, d1, d2;
+    double px, py, pz, e, mass;
+    double x, y, z, t;
+  };
+
+  int eventNumber, mpi, processID, signalCode, vertexCounter, beamCode[2];
+  double scale, alphaQCD, alphaQED;
+
+  double momentumCoefficient, positionCoefficient;
+
+  int stateSize;
+  std::vector< int > state;
+
+  int weightSize;
+  std::vector< double > weight;
+
+  int id1, id2;
+  double x1, x2, scalePDF, pdf1, pdf2;
+
+  int outVertexCode, vertexID, inCounter, outCounter;
+  double x, y, z, t;
+
+  std::vector< TParticle > particles;
+
+  // first and last particles entering and leaving vertex -i are stored in entry i,
+  // (-1, -1) if there is none, vertex codes outside of the tables are kept in the maps
+  std::vector< std::pair < int, int > > motherTable;
+  std::vector< std::pair < int, int > > daughterTable;
+
+  std::map< int, std::pair < int, int > > motherMap;
+  std::map< int, std::pair < int, int > > daughterMap;
+};
+
+//---------------------------------------------------------------------------
+
+class DelphesHepMCReader : private DelphesReadAhead< DelphesHepMCRecord >
 {
 public:
 
   DelphesHepMCReader();
   ~DelphesHepMCReader();
 
+  // number of events parsed ahead in a separate thread while the current event is processed,
+  // 0 parses the input line by line in ReadBlock, must be set before SetInputFile
+  void SetPipelineDepth(int depth);
+
   void SetInputFile(FILE *inputFile);
 
+  // stops reading ahead, must be called before the input file is moved or closed
+  void Stop();
+
   void Clear();
   bool EventReady();
 
+  // with factory 0 the event is parsed without creating candidates,
+  // it can then be written by WriteEvent and sent to a worker process
   bool ReadBlock(DelphesFactory *factory,
     TObjArray *allParticleOutputArray,
     TObjArray *stableParticleOutputArray,
     TObjArray *partonOutputArray);
 
+  // writes the current event to buffer
+  void WriteEvent(std::vector< char > &buffer);
+
+  // reads an event written by WriteEvent and creates its candidates
+  void ReadEvent(const std::vector< char > &buffer, DelphesFactory *factory,
+    TObjArray *allParticleOutputArray,
+    TObjArray *stableParticleOutputArray,
+    TObjArray *partonOutputArray);
+
   void AnalyzeEvent(ExRootTreeBranch *branch, long long eventNumber,
     TStopwatch *readStopWatch, TStopwatch *procStopWatch);
 
 private:
 
-  void AnalyzeParticle(DelphesFactory *factory,
-    TObjArray *allParticleOutputArray,
-    TObjArray *stableParticleOutputArray,
-    TObjArray *partonOutputArray);
+  typedef DelphesHepMCRecord TEventRecord;
+  typedef DelphesHepMCRecord::TParticle TParticleRecord;
 
-  void FinalizeParticles(TObjArray *allParticleOutputArray);
+  // parses the next event in the reading thread
+  bool ReadRecord(TEventRecord &event);
 
-  FILE *fInputFile;
+  static void ClearEvent(TEventRecord &event);
+  static bool EventReady(const TEventRecord &event);
 
-  char *fBuffer;
+  // returns false for invalid lines, complete is set when the line completes the event
+  bool ParseLine(char *line, TEventRecord &event, bool &complete);
 
-  TDatabasePDG *fPDG;
+  void AddParticles(const TEventRecord &event, DelphesFactory *factory,
+    TObjArray *allParticleOutputArray,
+    TObjArray *stableParticleOutputArray,
+    TObjArray *partonOutputArray);
 
-  int fEventNumber, fMPI, fProcessID, fSignalCode, fVertexCounter, fBeamCode[2];
-  double fScale, fAlphaQCD, fAlphaQED;
+  void FinalizeParticles(TEventRecord &event);
 
-  double fMomentumCoefficient, fPositionCoefficient;
+  // returns the next line without the end of line character,
+  // 0 at the end of the file or once the reading thread is stopped
+  char *ReadLine();
 
-  int fStateSize;
-  std::vector< int > fState;
+  static std::pair< int, int > *AddVertex(std::vector< std::pair< int, int > > &table,
+    std::map< int, std::pair< int, int > > &vertexMap, int code);
 
-  int fWeightSize;
-  std::vector< double > fWeight;
+  static const std::pair< int, int > *FindVertex(const std::vector< std::pair< int, int > > &table,
+    const std::map< int, std::pair< int, int > > &vertexMap, int code);
 
-  int fID1, fID2;
-  double fX1, fX2, fScalePDF, fPDF1, fPDF2;
+  FILE *fInputFile;
 
-  int fOutVertexCode, fVertexID, fInCounter, fOutCounter;
-  double fX, fY, fZ, fT;
+  // input is read in large blocks, fBufferStart ... fBufferEnd is not parsed yet
+  char *fBuffer, *fBufferStart, *fBufferEnd;
+  size_t fBufferSize;
+  bool fEndOfFile;
 
-  int fParticleCode, fPID, fStatus, fInVertexCode;
-  double fPx, fPy, fPz, fE, fMass, fTheta, fPhi;
+  TDatabasePDG *fPDG;
 
-  int fParticleCounter;
+  // event parsed line by line when the input is not read ahead
+  TEventRecord fEvent;
 
-  std::map< int, std::pair < int, int > > fMotherMap;
-  std::map< int, std::pair < int, int > > fDaughterMap;
+  // event returned by the last call to ReadBlock when the input is read ahead
+  TEventRecord *fCurrentEvent;
 };
 
 #endif // DelphesHepMCReader_h
-
-
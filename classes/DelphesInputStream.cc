@@ -0,0 +1,820 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \class DelphesInputStream
+ *
+ *  Gives the readers a stream of the decompressed content of an input file.
+ *  Files compressed with gzip, xz or zstd are recognized by their first bytes
+ *  and decompressed in a separate thread into a ring buffer,
+ *  the stream returned by Open reads from this buffer.
+ *  Backward seeks further than the content kept in the buffer
+ *  decompress the file again from its beginning,
+ *  they fail if the compressed input is a pipe.
+ *  Uncompressed files are read directly.
+ *  Pipes are polled, so that Interrupt can end a read waiting for input.
+ *
+ */
+
+#include "classes/DelphesInputStream.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+
+#if defined(HAS_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(HAS_LZMA)
+#include <lzma.h>
+#endif
+
+#if defined(HAS_ZSTD)
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+static const size_t kRingSize = 1 << 22;
+static const size_t kInputSize = 1 << 18;
+static const size_t kStreamBufferSize = 1 << 16;
+
+// stdio aligns seeks to the stream buffer and may seek back up to its size
+static const Long64_t kRingHistory = kStreamBufferSize;
+
+// period of the checks for an interrupt while a pipe is empty, in milliseconds
+static const int kPollTimeout = 100;
+
+//------------------------------------------------------------------------------
+
+class DelphesInputDecoder
+{
+public:
+
+  DelphesInputDecoder(DelphesInputStream *source, const char *head, size_t headSize);
+
+  virtual ~DelphesInputDecoder() {}
+
+  // decompresses at most size bytes to buffer, returns the number of bytes,
+  // 0 at the end of the input and -1 for invalid or truncated input
+  virtual ssize_t Decode(char *buffer, size_t size) = 0;
+
+protected:
+
+  // refills the input buffer, returns the number of bytes read
+  size_t ReadInput();
+
+  DelphesInputStream *fSource;
+
+  std::vector< unsigned char > fInput;
+  size_t fInputSize;
+};
+
+//------------------------------------------------------------------------------
+
+DelphesInputDecoder::DelphesInputDecoder(DelphesInputStream *source, const char *head, size_t headSize) :
+  fSource(source), fInput(kInputSize), fInputSize(headSize)
+{
+  memcpy(&fInput[0], head, headSize);
+}
+
+//------------------------------------------------------------------------------
+
+size_t DelphesInputDecoder::ReadInput()
+{
+  ssize_t count;
+
+  count = fSource->ReadFile(reinterpret_cast<char *>(&fInput[0]), fInput.size());
+  fInputSize = count > 0 ? count : 0;
+  return fInputSize;
+}
+
+//------------------------------------------------------------------------------
+
+#if defined(HAS_ZLIB)
+
+class DelphesGzipDecoder: public DelphesInputDecoder
+{
+public:
+
+  DelphesGzipDecoder(DelphesInputStream *source, const char *head, size_t headSize);
+
+  ~DelphesGzipDecoder();
+
+  ssize_t Decode(char *buffer, size_t size);
+
+private:
+
+  z_stream fStream;
+
+  // true between two gzip members
+  bool fComplete;
+};
+
+//------------------------------------------------------------------------------
+
+DelphesGzipDecoder::DelphesGzipDecoder(DelphesInputStream *source, const char *head, size_t headSize) :
+  DelphesInputDecoder(source, head, headSize), fComplete(false)
+{
+  memset(&fStream, 0, sizeof(fStream));
+
+  // adding 32 to the window size enables the gzip header detection
+  if(inflateInit2(&fStream, 15 + 32) != Z_OK)
+  {
+    throw runtime_error("can't initialize gzip decompression");
+  }
+
+  fStream.next_in = &fInput[0];
+  fStream.avail_in = fInputSize;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesGzipDecoder::~DelphesGzipDecoder()
+{
+  inflateEnd(&fStream);
+}
+
+//------------------------------------------------------------------------------
+
+ssize_t DelphesGzipDecoder::Decode(char *buffer, size_t size)
+{
+  int rc;
+
+  fStream.next_out = reinterpret_cast<Bytef *>(buffer);
+  fStream.avail_out = size;
+
+  while(true)
+  {
+    rc = inflate(&fStream, Z_NO_FLUSH);
+
+    if(rc == Z_STREAM_END)
+    {
+      // concatenated members are decompressed one after the other
+      fComplete = true;
+      inflateReset(&fStream);
+    }
+    else if(rc == Z_OK)
+    {
+      fComplete = false;
+    }
+    else if(rc != Z_BUF_ERROR)
+    {
+      return -1;
+    }
+
+    if(fStream.avail_out < size) return size - fStream.avail_out;
+
+    if(fStream.avail_in > 0) continue;
+
+    if(ReadInput() == 0) return fComplete ? 0 : -1;
+
+    fStream.next_in = &fInput[0];
+    fStream.avail_in = fInputSize;
+  }
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+#if defined(HAS_LZMA)
+
+class DelphesXZDecoder: public DelphesInputDecoder
+{
+public:
+
+  DelphesXZDecoder(DelphesInputStream *source, const char *head, size_t headSize);
+
+  ~DelphesXZDecoder();
+
+  ssize_t Decode(char *buffer, size_t size);
+
+private:
+
+  lzma_stream fStream;
+
+  bool fEndOfFile;
+};
+
+//------------------------------------------------------------------------------
+
+DelphesXZDecoder::DelphesXZDecoder(DelphesInputStream *source, const char *head, size_t headSize) :
+  DelphesInputDecoder(source, head, headSize), fEndOfFile(false)
+{
+  lzma_stream stream = LZMA_STREAM_INIT;
+
+  fStream = stream;
+
+  if(lzma_stream_decoder(&fStream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+  {
+    throw runtime_error("can't initialize xz decompression");
+  }
+
+  fStream.next_in = &fInput[0];
+  fStream.avail_in = fInputSize;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesXZDecoder::~DelphesXZDecoder()
+{
+  lzma_end(&fStream);
+}
+
+//------------------------------------------------------------------------------
+
+ssize_t DelphesXZDecoder::Decode(char *buffer, size_t size)
+{
+  lzma_ret rc;
+
+  fStream.next_out = reinterpret_cast<uint8_t *>(buffer);
+  fStream.avail_out = size;
+
+  while(true)
+  {
+    if(fStream.avail_in == 0 && !fEndOfFile)
+    {
+      fEndOfFile = (ReadInput() == 0);
+      fStream.next_in = &fInput[0];
+      fStream.avail_in = fInputSize;
+    }
+
+    // concatenated streams are finished only at the end of the file
+    rc = lzma_code(&fStream, fEndOfFile ? LZMA_FINISH : LZMA_RUN);
+
+    if(rc != LZMA_OK && rc != LZMA_STREAM_END) return -1;
+
+    if(fStream.avail_out < size) return size - fStream.avail_out;
+
+    if(rc == LZMA_STREAM_END) return 0;
+  }
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+#if defined(HAS_ZSTD)
+
+class DelphesZstdDecoder: public DelphesInputDecoder
+{
+public:
+
+  DelphesZstdDecoder(DelphesInputStream *source, const char *head, size_t headSize);
+
+  ~DelphesZstdDecoder();
+
+  ssize_t Decode(char *buffer, size_t size);
+
+private:
+
+  ZSTD_DStream *fStream;
+  ZSTD_inBuffer fBuffer;
+
+  // true between two frames
+  bool fComplete;
+};
+
+//------------------------------------------------------------------------------
+
+DelphesZstdDecoder::DelphesZstdDecoder(DelphesInputStream *source, const char *head, size_t headSize) :
+  DelphesInputDecoder(source, head, headSize), fStream(0), fComplete(false)
+{
+  fStream = ZSTD_createDStream();
+
+  if(!fStream || ZSTD_isError(ZSTD_initDStream(fStream)))
+  {
+    if(fStream) ZSTD_freeDStream(fStream);
+    throw runtime_error("can't initialize zstd decompression");
+  }
+
+  fBuffer.src = &fInput[0];
+  fBuffer.size = fInputSize;
+  fBuffer.pos = 0;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesZstdDecoder::~DelphesZstdDecoder()
+{
+  ZSTD_freeDStream(fStream);
+}
+
+//------------------------------------------------------------------------------
+
+ssize_t DelphesZstdDecoder::Decode(char *buffer, size_t size)
+{
+  ZSTD_outBuffer output;
+  size_t rc, position;
+
+  output.dst = buffer;
+  output.size = size;
+  output.pos = 0;
+
+  while(true)
+  {
+    position = fBuffer.pos;
+
+    rc = ZSTD_decompressStream(fStream, &output, &fBuffer);
+
+    if(ZSTD_isError(rc)) return -1;
+
+    // concatenated frames are decompressed one after the other
+    if(rc == 0)
+    {
+      fComplete = true;
+    }
+    else if(fBuffer.pos > position)
+    {
+      fComplete = false;
+    }
+
+    if(output.pos > 0) return output.pos;
+
+    if(fBuffer.pos < fBuffer.size) continue;
+
+    if(ReadInput() == 0) return fComplete ? 0 : -1;
+
+    fBuffer.size = fInputSize;
+    fBuffer.pos = 0;
+  }
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+#if defined(__APPLE__) || defined(__FreeBSD__)
+
+static int ReadCookie(void *stream, char *buffer, int size)
+{
+  return DelphesInputStream::ReadStream(stream, buffer, size);
+}
+
+static fpos_t SeekCookie(void *stream, fpos_t offset, int whence)
+{
+  return DelphesInputStream::SeekStream(stream, offset, whence);
+}
+
+#else
+
+static ssize_t ReadCookie(void *stream, char *buffer, size_t size)
+{
+  return DelphesInputStream::ReadStream(stream, buffer, size);
+}
+
+static int SeekCookie(void *stream, off64_t *offset, int whence)
+{
+  Long64_t position = DelphesInputStream::SeekStream(stream, *offset, whence);
+  if(position < 0) return -1;
+  *offset = position;
+  return 0;
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+DelphesInputStream::DelphesInputStream() :
+  fFile(0), fStream(0), fPipe(kFALSE), fDecoder(0), fHeadStart(0), fHeadSize(0),
+  fPosition(0), fRingRead(0), fRingWritten(0),
+  fRunning(kFALSE), fStop(kFALSE), fDone(kFALSE), fError(kFALSE), fInterrupted(kFALSE)
+{
+  pthread_mutex_init(&fMutex, 0);
+  pthread_cond_init(&fDataCondition, 0);
+  pthread_cond_init(&fSpaceCondition, 0);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesInputStream::~DelphesInputStream()
+{
+  Close();
+
+  pthread_cond_destroy(&fSpaceCondition);
+  pthread_cond_destroy(&fDataCondition);
+  pthread_mutex_destroy(&fMutex);
+}
+
+//------------------------------------------------------------------------------
+
+FILE *DelphesInputStream::Open(FILE *file)
+{
+  Close();
+
+  fFile = file;
+  fPosition = 0;
+  fHeadStart = 0;
+  fInterrupted = kFALSE;
+
+  // pipes are read with read after poll, stdio must not buffer their content
+  fPipe = (fseeko(fFile, 0, SEEK_CUR) != 0);
+  if(fPipe) setvbuf(fFile, 0, _IONBF, 0);
+
+  fDecoder = NewDecoder();
+
+  if(!fDecoder && fseeko(fFile, -off_t(fHeadSize), SEEK_CUR) == 0)
+  {
+    fHeadSize = 0;
+    fStream = fFile;
+    return fStream;
+  }
+
+  // uncompressed pipes are read through the stream to return the first bytes
+  if(fDecoder) fHeadSize = 0;
+
+#if defined(__APPLE__) || defined(__FreeBSD__)
+  fStream = funopen(this, ReadCookie, 0, SeekCookie, 0);
+#else
+  cookie_io_functions_t functions = {ReadCookie, 0, SeekCookie, 0};
+  fStream = fopencookie(this, "r", functions);
+#endif
+
+  if(!fStream)
+  {
+    throw runtime_error("can't create input stream");
+  }
+
+  setvbuf(fStream, 0, _IOFBF, kStreamBufferSize);
+
+  if(!fDecoder) return fStream;
+
+  fRing.resize(kRingSize);
+
+  StartDecoder();
+
+  return fStream;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesInputDecoder *DelphesInputStream::NewDecoder()
+{
+  const unsigned char *head;
+
+  fHeadSize = fread(fHead, 1, 6, fFile);
+
+  head = reinterpret_cast<const unsigned char *>(fHead);
+
+  if(fHeadSize >= 2 && head[0] == 0x1F && head[1] == 0x8B)
+  {
+#if defined(HAS_ZLIB)
+    return new DelphesGzipDecoder(this, fHead, fHeadSize);
+#else
+    throw runtime_error("gzip compressed input requires Delphes built with zlib");
+#endif
+  }
+  else if(fHeadSize >= 6 && memcmp(head, "\xFD\x37\x7A\x58\x5A\x00", 6) == 0)
+  {
+#if defined(HAS_LZMA)
+    return new DelphesXZDecoder(this, fHead, fHeadSize);
+#else
+    throw runtime_error("xz compressed input requires Delphes built with liblzma");
+#endif
+  }
+  else if(fHeadSize >= 4 && memcmp(head, "\x28\xB5\x2F\xFD", 4) == 0)
+  {
+#if defined(HAS_ZSTD)
+    return new DelphesZstdDecoder(this, fHead, fHeadSize);
+#else
+    throw runtime_error("zstd compressed input requires Delphes built with libzstd");
+#endif
+  }
+
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputStream::StartDecoder()
+{
+  fRingRead = 0;
+  fRingWritten = 0;
+  fStop = kFALSE;
+  fDone = kFALSE;
+  fError = kFALSE;
+
+  if(pthread_create(&fThread, 0, Work, this) != 0)
+  {
+    throw runtime_error("can't create decompression thread");
+  }
+
+  fRunning = kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputStream::StopDecoder()
+{
+  if(!fRunning) return;
+
+  pthread_mutex_lock(&fMutex);
+  fStop = kTRUE;
+  pthread_cond_broadcast(&fSpaceCondition);
+  pthread_mutex_unlock(&fMutex);
+
+  pthread_join(fThread, 0);
+
+  fRunning = kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputStream::Close()
+{
+  StopDecoder();
+
+  if(fStream && fStream != fFile) fclose(fStream);
+  if(fFile && fFile != stdin) fclose(fFile);
+
+  if(fDecoder) delete fDecoder;
+
+  fStream = 0;
+  fFile = 0;
+  fDecoder = 0;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesInputStream::Rewind()
+{
+  DelphesInputDecoder *decoder;
+
+  // pipes can't be decompressed again
+  if(fPipe) return kFALSE;
+
+  StopDecoder();
+
+  delete fDecoder;
+  fDecoder = 0;
+
+  if(fseeko(fFile, 0, SEEK_SET) != 0 || !(decoder = NewDecoder()))
+  {
+    throw runtime_error("can't rewind compressed input");
+  }
+
+  fDecoder = decoder;
+  fHeadSize = 0;
+  fPosition = 0;
+
+  StartDecoder();
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputStream::Interrupt()
+{
+  pthread_mutex_lock(&fMutex);
+  fInterrupted = kTRUE;
+  pthread_cond_broadcast(&fDataCondition);
+  pthread_cond_broadcast(&fSpaceCondition);
+  pthread_mutex_unlock(&fMutex);
+}
+
+//------------------------------------------------------------------------------
+
+ssize_t DelphesInputStream::ReadFile(char *buffer, size_t size)
+{
+  struct pollfd descriptor;
+  ssize_t count;
+  Bool_t stop;
+  int rc;
+
+  if(!fPipe)
+  {
+    count = fread(buffer, 1, size, fFile);
+    return (count == 0 && ferror(fFile)) ? -1 : count;
+  }
+
+  descriptor.fd = fileno(fFile);
+  descriptor.events = POLLIN;
+
+  while(true)
+  {
+    pthread_mutex_lock(&fMutex);
+    stop = fStop || fInterrupted;
+    pthread_mutex_unlock(&fMutex);
+
+    if(stop) return 0;
+
+    // waits for input at most kPollTimeout before checking for an interrupt again
+    rc = poll(&descriptor, 1, kPollTimeout);
+
+    if(rc < 0 && errno != EINTR) return -1;
+    if(rc <= 0) continue;
+
+    count = read(descriptor.fd, buffer, size);
+
+    if(count >= 0) return count;
+    if(errno != EINTR && errno != EAGAIN) return -1;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Long64_t DelphesInputStream::GetPosition() const
+{
+  return fFile ? ftello(fFile) : -1;
+}
+
+//------------------------------------------------------------------------------
+
+void *DelphesInputStream::Work(void *stream)
+{
+  static_cast<DelphesInputStream *>(stream)->Loop();
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesInputStream::Loop()
+{
+  Long64_t ringSize, offset;
+  ssize_t count;
+  size_t size;
+
+  ringSize = fRing.size();
+
+  while(true)
+  {
+    pthread_mutex_lock(&fMutex);
+    while(fRingWritten - fRingRead >= ringSize - kRingHistory && !fStop)
+    {
+      pthread_cond_wait(&fSpaceCondition, &fMutex);
+    }
+
+    if(fStop)
+    {
+      pthread_mutex_unlock(&fMutex);
+      return;
+    }
+
+    // the free part of the ring from fRingWritten up to its end or up to the kept content
+    offset = fRingWritten % ringSize;
+    size = min(ringSize - offset, ringSize - kRingHistory - (fRingWritten - fRingRead));
+    pthread_mutex_unlock(&fMutex);
+
+    count = fDecoder->Decode(&fRing[offset], size);
+
+    pthread_mutex_lock(&fMutex);
+    if(count > 0)
+    {
+      fRingWritten += count;
+    }
+    else
+    {
+      // input cut short by Interrupt or Close is not an error
+      fDone = kTRUE;
+      fError = (count < 0) && !fStop && !fInterrupted;
+    }
+    pthread_cond_signal(&fDataCondition);
+    pthread_mutex_unlock(&fMutex);
+
+    if(count < 0 && fError)
+    {
+      cerr << "** ERROR: " << "invalid or truncated compressed input" << endl;
+    }
+
+    if(count <= 0) return;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+ssize_t DelphesInputStream::Read(char *buffer, size_t size)
+{
+  Long64_t ringSize, offset, available;
+  ssize_t count;
+  Bool_t error;
+
+  if(!fDecoder)
+  {
+    if(fHeadStart < fHeadSize)
+    {
+      count = min(size, fHeadSize - fHeadStart);
+      memcpy(buffer, fHead + fHeadStart, count);
+      fHeadStart += count;
+    }
+    else
+    {
+      count = ReadFile(buffer, size);
+      if(count < 0) return -1;
+    }
+    fPosition += count;
+    return count;
+  }
+
+  ringSize = fRing.size();
+
+  pthread_mutex_lock(&fMutex);
+  while(fRingRead == fRingWritten && !fDone && !fInterrupted)
+  {
+    pthread_cond_wait(&fDataCondition, &fMutex);
+  }
+
+  available = fInterrupted ? 0 : fRingWritten - fRingRead;
+  error = fError;
+  pthread_mutex_unlock(&fMutex);
+
+  if(available == 0) return error ? -1 : 0;
+
+  // the decompression thread doesn't write between fRingRead and fRingWritten
+  offset = fRingRead % ringSize;
+  count = min(Long64_t(size), min(available, ringSize - offset));
+  memcpy(buffer, &fRing[offset], count);
+
+  pthread_mutex_lock(&fMutex);
+  fRingRead += count;
+  pthread_cond_signal(&fSpaceCondition);
+  pthread_mutex_unlock(&fMutex);
+
+  fPosition += count;
+  return count;
+}
+
+//------------------------------------------------------------------------------
+
+ssize_t DelphesInputStream::ReadStream(void *stream, char *buffer, size_t size)
+{
+  return static_cast<DelphesInputStream *>(stream)->Read(buffer, size);
+}
+
+//------------------------------------------------------------------------------
+
+Long64_t DelphesInputStream::SeekStream(void *stream, Long64_t offset, Int_t whence)
+{
+  DelphesInputStream *input = static_cast<DelphesInputStream *>(stream);
+
+  if(whence == SEEK_CUR)
+  {
+    offset += input->fPosition;
+  }
+  else if(whence != SEEK_SET)
+  {
+    return -1;
+  }
+
+  return input->Seek(offset);
+}
+
+//------------------------------------------------------------------------------
+
+Long64_t DelphesInputStream::Seek(Long64_t position)
+{
+  char buffer[16384];
+  ssize_t count;
+
+  if(position < fPosition)
+  {
+    if(!fDecoder || position < 0) return -1;
+
+    if(fPosition - position > kRingHistory)
+    {
+      // content before the ring is decompressed again from the beginning of the file
+      if(!Rewind()) return -1;
+    }
+    else
+    {
+      // in the decompressed content fPosition is equal to fRingRead
+      pthread_mutex_lock(&fMutex);
+      fRingRead = position;
+      pthread_mutex_unlock(&fMutex);
+
+      fPosition = position;
+    }
+  }
+
+  while(fPosition < position)
+  {
+    count = Read(buffer, min(position - fPosition, Long64_t(sizeof(buffer))));
+    if(count <= 0) return -1;
+  }
+
+  return fPosition;
+}
+
+//------------------------------------------------------------------------------
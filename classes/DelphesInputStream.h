@@ -0,0 +1,127 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesInputStream_h
+#define DelphesInputStream_h
+
+/** \class DelphesInputStream
+ *
+ *  Gives the readers a stream of the decompressed content of an input file.
+ *  Files compressed with gzip, xz or zstd are recognized by their first bytes
+ *  and decompressed in a separate thread into a ring buffer,
+ *  the stream returned by Open reads from this buffer.
+ *  Backward seeks further than the content kept in the buffer
+ *  decompress the file again from its beginning,
+ *  they fail if the compressed input is a pipe.
+ *  Uncompressed files are read directly.
+ *  Pipes are polled, so that Interrupt can end a read waiting for input.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+#include <stdio.h>
+#include <sys/types.h>
+
+#include <pthread.h>
+
+class DelphesInputDecoder;
+
+class DelphesInputStream
+{
+public:
+
+  DelphesInputStream();
+
+  ~DelphesInputStream();
+
+  // takes ownership of file and returns the stream to read from,
+  // file is closed by Close unless it is the standard input
+  FILE *Open(FILE *file);
+
+  void Close();
+
+  // makes pending and later reads of the stream return the end of the input,
+  // to be called before stopping a thread that may wait for input from a pipe
+  void Interrupt();
+
+  // position in the file on disk, can be compared to the size of the compressed file
+  Long64_t GetPosition() const;
+
+  Bool_t IsCompressed() const { return fDecoder != 0; }
+
+  // read and seek functions of the stream returned by Open,
+  // forward seeks skip the decompressed content,
+  // backward seeks restart the decompression unless the content is still in the ring buffer
+  static ssize_t ReadStream(void *stream, char *buffer, size_t size);
+  static Long64_t SeekStream(void *stream, Long64_t offset, Int_t whence);
+
+private:
+
+  friend class DelphesInputDecoder;
+
+  // reads from the file, polls pipes and returns 0 once the stream is stopped or interrupted
+  ssize_t ReadFile(char *buffer, size_t size);
+
+  // creates the decoder for the first bytes of the file, 0 for uncompressed files
+  DelphesInputDecoder *NewDecoder();
+
+  void StartDecoder();
+  void StopDecoder();
+
+  // restarts the decompression from the beginning of the file, false for pipes
+  Bool_t Rewind();
+
+  static void *Work(void *stream);
+
+  void Loop();
+
+  ssize_t Read(char *buffer, size_t size);
+  Long64_t Seek(Long64_t position);
+
+  FILE *fFile, *fStream;
+
+  // file can't be seeked and is read without stdio buffering
+  Bool_t fPipe;
+
+  DelphesInputDecoder *fDecoder;
+
+  // first bytes of the file when it can't be rewound
+  char fHead[8];
+  size_t fHeadStart, fHeadSize;
+
+  // position in the decompressed content
+  Long64_t fPosition;
+
+  // decompressed content from fRingRead to fRingWritten is not read yet,
+  // both positions are counted from the beginning of the content,
+  // the content just before fRingRead is kept for backward seeks
+  std::vector< char > fRing;
+  Long64_t fRingRead, fRingWritten;
+
+  pthread_t fThread;
+  pthread_mutex_t fMutex;
+  pthread_cond_t fDataCondition;
+  pthread_cond_t fSpaceCondition;
+
+  Bool_t fRunning, fStop, fDone, fError, fInterrupted;
+};
+
+#endif // DelphesInputStream_h
@@ -52,43 +52,102 @@ static const int kBufferSize  = 1024;
 //---------------------------------------------------------------------------
 
 DelphesLHEFReader::DelphesLHEFReader() :
-  fInputFile(0), fBuffer(0), fPDG(0),
-  fEventReady(kFALSE), fEventCounter(-1), fParticleCounter(-1)
+  fInputFile(0), fBuffer(0), fPDG(0), fCurrentEvent(0)
 {
   fBuffer = new char[kBufferSize];
 
   fPDG = TDatabasePDG::Instance();
+
+  ClearEvent(fEvent);
 }
 
 //---------------------------------------------------------------------------
 
 DelphesLHEFReader::~DelphesLHEFReader()
 {
+  Stop();
+
   if(fBuffer) delete[] fBuffer;
 }
 
 //---------------------------------------------------------------------------
 
+void DelphesLHEFReader::SetPipelineDepth(int depth)
+{
+  fCurrentEvent = 0;
+
+  SetDepth(depth);
+}
+
+//---------------------------------------------------------------------------
+
 void DelphesLHEFReader::SetInputFile(FILE *inputFile)
 {
+  Stop();
+
   fInputFile = inputFile;
+
+  if(inputFile) StartReading();
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesLHEFReader::Stop()
+{
+  StopReading();
+
+  fCurrentEvent = 0;
+}
+
+//---------------------------------------------------------------------------
+
+bool DelphesLHEFReader::ReadRecord(TEventRecord &event)
+{
+  bool complete;
+
+  ClearEvent(event);
+
+  complete = false;
+  while(!complete)
+  {
+    if(!fgets(fBuffer, kBufferSize, fInputFile)) return false;
+    if(!ParseLine(fBuffer, event, complete)) return false;
+  }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesLHEFReader::ClearEvent(TEventRecord &event)
+{
+  event.ready = false;
+  event.eventCounter = -1;
+  event.particleCounter = -1;
+  event.particles.clear();
+  event.weightList.clear();
 }
 
 //---------------------------------------------------------------------------
 
 void DelphesLHEFReader::Clear()
 {
-  fEventReady = kFALSE;
-  fEventCounter = -1;
-  fParticleCounter = -1;
-  fWeightList.clear();
+  if(!IsReading())
+  {
+    ClearEvent(fEvent);
+  }
+  else if(fCurrentEvent)
+  {
+    ReleaseRecord(fCurrentEvent);
+    fCurrentEvent = 0;
+  }
 }
 
 //---------------------------------------------------------------------------
 
 bool DelphesLHEFReader::EventReady()
 {
-  return fEventReady;
+  return IsReading() ? fCurrentEvent != 0 : fEvent.ready;
 }
 
 //---------------------------------------------------------------------------
@@ -98,80 +157,170 @@ bool DelphesLHEFReader::ReadBlock(DelphesFactory *factory,
   TObjArray *stableParticleOutputArray,
   TObjArray *partonOutputArray)
 {
+  TEventRecord *event;
+  bool complete;
+
+  if(IsReading())
+  {
+    // the whole next event is taken at once
+    if(fCurrentEvent)
+    {
+      ReleaseRecord(fCurrentEvent);
+      fCurrentEvent = 0;
+    }
+
+    event = NextRecord();
+    if(!event) return kFALSE;
+
+    if(factory)
+    {
+      AddParticles(*event, factory, allParticleOutputArray,
+        stableParticleOutputArray, partonOutputArray);
+    }
+
+    fCurrentEvent = event;
+
+    return kTRUE;
+  }
+
+  if(!fgets(fBuffer, kBufferSize, fInputFile)) return kFALSE;
+
+  if(!ParseLine(fBuffer, fEvent, complete)) return kFALSE;
+
+  if(complete && factory)
+  {
+    AddParticles(fEvent, factory, allParticleOutputArray,
+      stableParticleOutputArray, partonOutputArray);
+  }
+
+  return kTRUE;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesLHEFReader::WriteEvent(vector< char > &buffer)
+{
+  const TEventRecord *event;
+
+  event = fCurrentEvent ? fCurrentEvent : &fEvent;
+
+  buffer.clear();
+
+  WriteValue(buffer, event->processID);
+  WriteValue(buffer, event->weight);
+  WriteValue(buffer, event->scalePDF);
+  WriteValue(buffer, event->alphaQED);
+  WriteValue(buffer, event->alphaQCD);
+
+  WriteArray(buffer, event->particles);
+  WriteArray(buffer, event->weightList);
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesLHEFReader::ReadEvent(const vector< char > &buffer, DelphesFactory *factory,
+  TObjArray *allParticleOutputArray,
+  TObjArray *stableParticleOutputArray,
+  TObjArray *partonOutputArray)
+{
+  size_t position = 0;
+
+  ClearEvent(fEvent);
+
+  ReadValue(buffer, position, fEvent.processID);
+  ReadValue(buffer, position, fEvent.weight);
+  ReadValue(buffer, position, fEvent.scalePDF);
+  ReadValue(buffer, position, fEvent.alphaQED);
+  ReadValue(buffer, position, fEvent.alphaQCD);
+
+  ReadArray(buffer, position, fEvent.particles);
+  ReadArray(buffer, position, fEvent.weightList);
+
+  fEvent.ready = true;
+
+  AddParticles(fEvent, factory, allParticleOutputArray,
+    stableParticleOutputArray, partonOutputArray);
+}
+
+//---------------------------------------------------------------------------
+
+bool DelphesLHEFReader::ParseLine(char *line, TEventRecord &event, bool &complete)
+{
+  TParticleRecord *particle;
   int rc, id;
   char *pch;
   double weight;
 
-  if(!fgets(fBuffer, kBufferSize, fInputFile)) return kFALSE;
+  complete = false;
 
-  if(strstr(fBuffer, "<event>"))
+  if(strstr(line, "<event>"))
   {
-    Clear();
-    fEventCounter = 1;
+    ClearEvent(event);
+    event.eventCounter = 1;
   }
-  else if(fEventCounter > 0)
+  else if(event.eventCounter > 0)
   {
-    DelphesStream bufferStream(fBuffer);
+    DelphesStream bufferStream(line);
 
-    rc = bufferStream.ReadInt(fParticleCounter)
-      && bufferStream.ReadInt(fProcessID)
-      && bufferStream.ReadDbl(fWeight)
-      && bufferStream.ReadDbl(fScalePDF)
-      && bufferStream.ReadDbl(fAlphaQED)
-      && bufferStream.ReadDbl(fAlphaQCD);
+    rc = bufferStream.ReadInt(event.particleCounter)
+      && bufferStream.ReadInt(event.processID)
+      && bufferStream.ReadDbl(event.weight)
+      && bufferStream.ReadDbl(event.scalePDF)
+      && bufferStream.ReadDbl(event.alphaQED)
+      && bufferStream.ReadDbl(event.alphaQCD);
 
     if(!rc)
     {
       cerr << "** ERROR: " << "invalid event format" << endl;
-      return kFALSE;
+      return false;
     }
 
-    --fEventCounter;
+    --event.eventCounter;
   }
-  else if(fParticleCounter > 0)
+  else if(event.particleCounter > 0)
   {
-    DelphesStream bufferStream(fBuffer);
-
-    rc = bufferStream.ReadInt(fPID)
-      && bufferStream.ReadInt(fStatus)
-      && bufferStream.ReadInt(fM1)
-      && bufferStream.ReadInt(fM2)
-      && bufferStream.ReadInt(fC1)
-      && bufferStream.ReadInt(fC2)
-      && bufferStream.ReadDbl(fPx)
-      && bufferStream.ReadDbl(fPy)
-      && bufferStream.ReadDbl(fPz)
-      && bufferStream.ReadDbl(fE)
-      && bufferStream.ReadDbl(fMass);
+    DelphesStream bufferStream(line);
+
+    event.particles.push_back(TParticleRecord());
+    particle = &event.particles.back();
+
+    rc = bufferStream.ReadInt(particle->pid)
+      && bufferStream.ReadInt(particle->status)
+      && bufferStream.ReadInt(particle->m1)
+      && bufferStream.ReadInt(particle->m2)
+      && bufferStream.ReadInt(particle->c1)
+      && bufferStream.ReadInt(particle->c2)
+      && bufferStream.ReadDbl(particle->px)
+      && bufferStream.ReadDbl(particle->py)
+      && bufferStream.ReadDbl(particle->pz)
+      && bufferStream.ReadDbl(particle->e)
+      && bufferStream.ReadDbl(particle->mass);
 
     if(!rc)
     {
       cerr << "** ERROR: " << "invalid particle format" << endl;
-      return kFALSE;
+      return false;
     }
 
-    AnalyzeParticle(factory, allParticleOutputArray,
-      stableParticleOutputArray, partonOutputArray);
-
-    --fParticleCounter;
+    --event.particleCounter;
   }
-  else if(strstr(fBuffer, "<wgt"))
+  else if(strstr(line, "<wgt"))
   {
-    pch = strpbrk(fBuffer, "\"'");
+    pch = strpbrk(line, "\"'");
     if(!pch)
     {
       cerr << "** ERROR: " << "invalid weight format" << endl;
-      return kFALSE;
+      return false;
     }
 
     DelphesStream idStream(pch + 1);
     rc = idStream.ReadInt(id);
 
-    pch = strchr(fBuffer, '>');
+    pch = strchr(line, '>');
     if(!pch)
     {
       cerr << "** ERROR: " << "invalid weight format" << endl;
-      return kFALSE;
+      return false;
     }
 
     DelphesStream weightStream(pch + 1);
@@ -180,17 +329,18 @@ bool DelphesLHEFReader::ReadBlock(DelphesFactory *factory,
     if(!rc)
     {
       cerr << "** ERROR: " << "invalid weight format" << endl;
-      return kFALSE;
+      return false;
     }
 
-    fWeightList.push_back(make_pair(id, weight));
+    event.weightList.push_back(make_pair(id, weight));
   }
-  else if(strstr(fBuffer, "</event>"))
+  else if(strstr(line, "</event>"))
   {
-    fEventReady = kTRUE;
+    event.ready = true;
+    complete = true;
   }
 
-  return kTRUE;
+  return true;
 }
 
 //---------------------------------------------------------------------------
@@ -198,16 +348,19 @@ bool DelphesLHEFReader::ReadBlock(DelphesFactory *factory,
 void DelphesLHEFReader::AnalyzeEvent(ExRootTreeBranch *branch, long long eventNumber,
   TStopwatch *readStopWatch, TStopwatch *procStopWatch)
 {
+  const TEventRecord *event;
   LHEFEvent *element;
 
+  event = fCurrentEvent ? fCurrentEvent : &fEvent;
+
   element = static_cast<LHEFEvent *>(branch->NewEntry());
   element->Number = eventNumber;
 
-  element->ProcessID = fProcessID;
-  element->Weight = fWeight;
-  element->ScalePDF = fScalePDF;
-  element->AlphaQED = fAlphaQED;
-  element->AlphaQCD = fAlphaQCD;
+  element->ProcessID = event->processID;
+  element->Weight = event->weight;
+  element->ScalePDF = event->scalePDF;
+  element->AlphaQED = event->alphaQED;
+  element->AlphaQCD = event->alphaQCD;
 
   element->ReadTime = readStopWatch->RealTime();
   element->ProcTime = procStopWatch->RealTime();
@@ -217,10 +370,13 @@ void DelphesLHEFReader::AnalyzeEvent(ExRootTreeBranch *branch, long long eventNu
 
 void DelphesLHEFReader::AnalyzeWeight(ExRootTreeBranch *branch)
 {
+  const TEventRecord *event;
   LHEFWeight *element;
   vector< pair< int, double > >::const_iterator itWeightList;
 
-  for(itWeightList = fWeightList.begin(); itWeightList != fWeightList.end(); ++itWeightList)
+  event = fCurrentEvent ? fCurrentEvent : &fEvent;
+
+  for(itWeightList = event->weightList.begin(); itWeightList != event->weightList.end(); ++itWeightList)
   {
     element = static_cast<LHEFWeight *>(branch->NewEntry());
 
@@ -231,46 +387,50 @@ void DelphesLHEFReader::AnalyzeWeight(ExRootTreeBranch *branch)
 
 //---------------------------------------------------------------------------
 
-void DelphesLHEFReader::AnalyzeParticle(DelphesFactory *factory,
+void DelphesLHEFReader::AddParticles(const TEventRecord &event, DelphesFactory *factory,
   TObjArray *allParticleOutputArray,
   TObjArray *stableParticleOutputArray,
   TObjArray *partonOutputArray)
 {
+  vector< TParticleRecord >::const_iterator itParticles;
   Candidate *candidate;
   TParticlePDG *pdgParticle;
   int pdgCode;
 
-  candidate = factory->NewCandidate();
+  for(itParticles = event.particles.begin(); itParticles != event.particles.end(); ++itParticles)
+  {
+    candidate = factory->NewCandidate();
 
-  candidate->PID = fPID;
-  pdgCode = TMath::Abs(candidate->PID);
+    candidate->PID = itParticles->pid;
+    pdgCode = TMath::Abs(candidate->PID);
 
-  candidate->Status = fStatus;
+    candidate->Status = itParticles->status;
 
-  pdgParticle = fPDG->GetParticle(fPID);
-  candidate->Charge = pdgParticle ? int(pdgParticle->Charge()/3.0) : -999;
-  candidate->Mass = fMass;
+    pdgParticle = fPDG->GetParticle(itParticles->pid);
+    candidate->Charge = pdgParticle ? int(pdgParticle->Charge()/3.0) : -999;
+    candidate->Mass = itParticles->mass;
 
-  candidate->Momentum.SetPxPyPzE(fPx, fPy, fPz, fE);
-  candidate->Position.SetXYZT(0.0, 0.0, 0.0, 0.0);
+    candidate->Momentum.SetPxPyPzE(itParticles->px, itParticles->py, itParticles->pz, itParticles->e);
+    candidate->Position.SetXYZT(0.0, 0.0, 0.0, 0.0);
 
-  candidate->M1 = fM1 - 1;
-  candidate->M2 = fM2 - 1;
+    candidate->M1 = itParticles->m1 - 1;
+    candidate->M2 = itParticles->m2 - 1;
 
-  candidate->D1 = -1;
-  candidate->D2 = -1;
+    candidate->D1 = -1;
+    candidate->D2 = -1;
 
-  allParticleOutputArray->Add(candidate);
+    allParticleOutputArray->Add(candidate);
 
-  if(!pdgParticle) return;
+    if(!pdgParticle) continue;
 
-  if(fStatus == 1 && pdgParticle->Stable())
-  {
-    stableParticleOutputArray->Add(candidate);
-  }
-  else if(pdgCode <= 5 || pdgCode == 21 || pdgCode == 15)
-  {
-    partonOutputArray->Add(candidate);
+    if(itParticles->status == 1 && pdgParticle->Stable())
+    {
+      stableParticleOutputArray->Add(candidate);
+    }
+    else if(pdgCode <= 5 || pdgCode == 21 || pdgCode == 15)
+    {
+      partonOutputArray->Add(candidate);
+    }
   }
 }
 
@@ -32,29 +32,72 @@
 #include <vector>
 #include <utility>
 
+#include "classes/DelphesReadAhead.h"
+
 class TObjArray;
 class TStopwatch;
 class TDatabasePDG;
 class ExRootTreeBranch;
 class DelphesFactory;
 
-class DelphesLHEFReader
+// event parsed without ROOT objects, so that it can be filled in the reading thread
+struct DelphesLHEFRecord
+{
+  struct TParticle
+  {
+    int pid, status, m1, m2, c1, c2;
+    double px, py, pz, e, mass;
+  };
+
+  bool ready;
+
+  int eventCounter;
+
+  int particleCounter, processID;
+  double weight, scalePDF, alphaQCD, alphaQED;
+
+  std::vector< TParticle > particles;
+
+  std::vector< std::pair< int, double > > weightList;
+};
+
+//---------------------------------------------------------------------------
+
+class DelphesLHEFReader : private DelphesReadAhead< DelphesLHEFRecord >
 {
 public:
 
   DelphesLHEFReader();
   ~DelphesLHEFReader();
 
+  // number of events parsed ahead in a separate thread while the current event is processed,
+  // 0 parses the input line by line in ReadBlock, must be set before SetInputFile
+  void SetPipelineDepth(int depth);
+
   void SetInputFile(FILE *inputFile);
 
+  // stops reading ahead, must be called before the input file is moved or closed
+  void Stop();
+
   void Clear();
   bool EventReady();
 
+  // with factory 0 the event is parsed without creating candidates,
+  // it can then be written by WriteEvent and sent to a worker process
   bool ReadBlock(DelphesFactory *factory,
     TObjArray *allParticleOutputArray,
     TObjArray *stableParticleOutputArray,
     TObjArray *partonOutputArray);
 
+  // writes the current event to buffer
+  void WriteEvent(std::vector< char > &buffer);
+
+  // reads an event written by WriteEvent and creates its candidates
+  void ReadEvent(const std::vector< char > &buffer, DelphesFactory *factory,
+    TObjArray *allParticleOutputArray,
+    TObjArray *stableParticleOutputArray,
+    TObjArray *partonOutputArray);
+
   void AnalyzeEvent(ExRootTreeBranch *branch, long long eventNumber,
     TStopwatch *readStopWatch, TStopwatch *procStopWatch);
 
@@ -62,7 +105,18 @@ public:
 
 private:
 
-  void AnalyzeParticle(DelphesFactory *factory,
+  typedef DelphesLHEFRecord TEventRecord;
+  typedef DelphesLHEFRecord::TParticle TParticleRecord;
+
+  // parses the next event in the reading thread
+  bool ReadRecord(TEventRecord &event);
+
+  static void ClearEvent(TEventRecord &event);
+
+  // returns false for invalid lines, complete is set when the line completes the event
+  bool ParseLine(char *line, TEventRecord &event, bool &complete);
+
+  void AddParticles(const TEventRecord &event, DelphesFactory *factory,
     TObjArray *allParticleOutputArray,
     TObjArray *stableParticleOutputArray,
     TObjArray *partonOutputArray);
@@ -73,19 +127,11 @@ private:
 
   TDatabasePDG *fPDG;
 
-  bool fEventReady;
-
-  int fEventCounter;
+  // event parsed line by line when the input is not read ahead
+  TEventRecord fEvent;
 
-  int fParticleCounter, fProcessID;
-  double fWeight, fScalePDF, fAlphaQCD, fAlphaQED;
-
-  int fPID, fStatus, fM1, fM2, fC1, fC2;
-  double fPx, fPy, fPz, fE, fMass;
-  
-  std::vector< std::pair< int, double > > fWeightList;
+  // event returned by the last call to ReadBlock when the input is read ahead
+  TEventRecord *fCurrentEvent;
 };
 
 #endif // DelphesLHEFReader_h
-
-
@@ -28,6 +28,9 @@
 #include "classes/DelphesModule.h"
 
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesRandom.h"
+#include "classes/DelphesEtaPhiIndex.h"
+#include "classes/DelphesEfficiencyMap.h"
 
 #include "ExRootAnalysis/ExRootTreeReader.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
@@ -38,6 +41,7 @@
 #include "TClass.h"
 #include "TFolder.h"
 #include "TObjArray.h"
+#include "TRandom.h"
 
 #include <iostream>
 #include <stdexcept>
@@ -46,7 +50,7 @@
 using namespace std;
 
 DelphesModule::DelphesModule() :
-  fTreeWriter(0), fFactory(0), fPlots(0),
+  fTreeWriter(0), fFactory(0), fPlots(0), fRandom(0),
   fPlotFolder(0), fExportFolder(0)
 {
 }
@@ -55,6 +59,7 @@ DelphesModule::DelphesModule() :
 
 DelphesModule::~DelphesModule()
 {
+  if(fRandom) delete fRandom;
 }
 
 //------------------------------------------------------------------------------
@@ -113,7 +118,7 @@ TObjArray *DelphesModule::ExportArray(const char *name)
 
 //------------------------------------------------------------------------------
 
-ExRootTreeBranch *DelphesModule::NewBranch(const char *name, TClass *cl)
+ExRootTreeWriter *DelphesModule::GetTreeWriter()
 {
   stringstream message;
   if(!fTreeWriter)
@@ -125,7 +130,22 @@ ExRootTreeBranch *DelphesModule::NewBranch(const char *name, TClass *cl)
       throw runtime_error(message.str());
     }
   }
-  return fTreeWriter->NewBranch(name, cl);
+  return fTreeWriter;
+}
+
+//------------------------------------------------------------------------------
+
+ExRootTreeBranch *DelphesModule::NewBranch(const char *name, TClass *cl)
+{
+  return GetTreeWriter()->NewBranch(name, cl);
+}
+
+//------------------------------------------------------------------------------
+
+ExRootTreeBranch *DelphesModule::NewFlatBranch(const char *name, TClass *cl, Int_t basketSize,
+  Int_t compressionAlgorithm, Int_t compressionLevel)
+{
+  return GetTreeWriter()->NewFlatBranch(name, cl, basketSize, compressionAlgorithm, compressionLevel);
 }
 
 //------------------------------------------------------------------------------
@@ -157,4 +177,87 @@ DelphesFactory *DelphesModule::GetFactory()
   return fFactory;
 }
 
+DelphesEtaPhiIndex *DelphesModule::GetKinematics(const TObjArray *array)
+{
+  return GetFactory()->GetEtaPhiIndex(array);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesEfficiencyMap *DelphesModule::NewEfficiencyMap(ExRootConfParam param)
+{
+  DelphesEfficiencyMap *efficiency;
+  Int_t i, size;
+
+  efficiency = new DelphesEfficiencyMap;
+  SetEfficiencyTable(efficiency);
+
+  size = param.GetSize();
+  for(i = 0; i < size/2; ++i)
+  {
+    efficiency->SetFormula(param[i*2].GetInt(), param[i*2 + 1].GetString());
+  }
+
+  return efficiency;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesModule::SetEfficiencyTable(DelphesEfficiencyMap *efficiency)
+{
+  // formulas are evaluated directly if EfficiencyTablePTBins is zero
+  efficiency->SetTable(GetInt("EfficiencyTablePTBins", 0),
+    GetDouble("EfficiencyTablePTMin", 0.0), GetDouble("EfficiencyTablePTMax", 1000.0),
+    GetInt("EfficiencyTableEtaBins", 100), GetDouble("EfficiencyTableEtaMax", 5.0),
+    GetBool("EfficiencyTableInterpolate", false));
+}
 
+//------------------------------------------------------------------------------
+
+TRandom *DelphesModule::GetRandom()
+{
+  return fRandom ? fRandom : gRandom;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesModule::SetRandomStream(ULong64_t seed, Long64_t event)
+{
+  if(!fRandom) fRandom = new DelphesRandom;
+  fRandom->SetStream(seed, GetName(), event);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesModule::Exec(Option_t *option)
+{
+  TRandom *random = gRandom;
+  TObject *array;
+
+  // modules and the ROOT functions they call draw from the stream of the module
+  if(fRandom) gRandom = fRandom;
+
+  try
+  {
+    ExRootTask::Exec(option);
+  }
+  catch(...)
+  {
+    gRandom = random;
+    throw;
+  }
+
+  gRandom = random;
+
+  // the module may have modified its output arrays after their kinematics were cached
+  if(fExportFolder && fFactory)
+  {
+    TIter itExport(fExportFolder->GetListOfFolders());
+    while((array = itExport()))
+    {
+      fFactory->InvalidateEtaPhiIndex(static_cast<TObjArray *>(array));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
@@ -32,6 +32,7 @@
 class TClass;
 class TObject;
 class TFolder;
+class TRandom;
 class TClonesArray;
 
 class ExRootResult;
@@ -39,6 +40,9 @@ class ExRootTreeBranch;
 class ExRootTreeWriter;
 
 class DelphesFactory;
+class DelphesRandom;
+class DelphesEtaPhiIndex;
+class DelphesEfficiencyMap;
 
 class DelphesModule: public ExRootTask 
 {
@@ -55,10 +59,31 @@ public:
   TObjArray *ExportArray(const char *name);
 
   ExRootTreeBranch *NewBranch(const char *name, TClass *cl);
+  ExRootTreeBranch *NewFlatBranch(const char *name, TClass *cl, Int_t basketSize,
+    Int_t compressionAlgorithm, Int_t compressionLevel);
 
   ExRootResult *GetPlots();
   DelphesFactory *GetFactory();
 
+  // cached eta, phi and pT of the candidates of an array for the current event,
+  // the caches of the exported arrays are invalidated after every call of Process
+  DelphesEtaPhiIndex *GetKinematics(const TObjArray *array);
+
+  // efficiency formulas from a list of flavors and formulas,
+  // tabulated according to the EfficiencyTable parameters of the module
+  DelphesEfficiencyMap *NewEfficiencyMap(ExRootConfParam param);
+
+  // reads the EfficiencyTable parameters of the module
+  void SetEfficiencyTable(DelphesEfficiencyMap *efficiency);
+
+  // random stream of this module for the current event, gRandom before the first event
+  // or if the streams are disabled, gRandom points to it while the module is processed
+  TRandom *GetRandom();
+
+  void SetRandomStream(ULong64_t seed, Long64_t event);
+
+  void Exec(Option_t *option);
+
 protected:
 
   ExRootTreeWriter *fTreeWriter;
@@ -66,8 +91,12 @@ protected:
 
 private:
 
+  ExRootTreeWriter *GetTreeWriter();
+
   ExRootResult *fPlots;
 
+  DelphesRandom *fRandom; //!
+
   TFolder *fPlotFolder, *fExportFolder;
 
   ClassDef(DelphesModule, 1)
@@ -0,0 +1,173 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \class DelphesOverlapIndex
+ *
+ *  Hash set of the unique IDs of the leaves (candidates without daughters)
+ *  of all claimed candidates.
+ *  Two candidates overlap if their daughter trees share a candidate,
+ *  and then they also share the leaves of this candidate,
+ *  so a candidate overlaps with the claimed candidates
+ *  if one of its leaves is in the set.
+ *
+ */
+
+#include "classes/DelphesOverlapIndex.h"
+#include "classes/DelphesClasses.h"
+
+using namespace std;
+
+static const UInt_t kEmpty = 0xFFFFFFFF;
+
+//------------------------------------------------------------------------------
+
+static inline UInt_t Hash(UInt_t id)
+{
+  // unique IDs are consecutive numbers, Fibonacci hashing spreads them
+  return id*2654435769U;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesOverlapIndex::DelphesOverlapIndex() :
+  fSize(0), fMask(63), fContainsEmpty(kFALSE)
+{
+  fTable.assign(fMask + 1, kEmpty);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesOverlapIndex::~DelphesOverlapIndex()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesOverlapIndex::Clear()
+{
+  if(fSize > 0) fTable.assign(fTable.size(), kEmpty);
+  fSize = 0;
+  fContainsEmpty = kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesOverlapIndex::CollectLeaves(const Candidate *candidate, vector< UInt_t > &leaves)
+{
+  Int_t i, size = candidate->GetNumberOfCandidates();
+
+  if(size == 0)
+  {
+    leaves.push_back(candidate->GetUniqueID());
+    return;
+  }
+
+  for(i = 0; i < size; ++i)
+  {
+    CollectLeaves(candidate->GetCandidate(i), leaves);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesOverlapIndex::Add(const Candidate *candidate)
+{
+  vector< UInt_t >::const_iterator itLeaves;
+
+  fLeaves.clear();
+  CollectLeaves(candidate, fLeaves);
+
+  for(itLeaves = fLeaves.begin(); itLeaves != fLeaves.end(); ++itLeaves)
+  {
+    Insert(*itLeaves);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesOverlapIndex::Overlaps(const Candidate *candidate)
+{
+  vector< UInt_t >::const_iterator itLeaves;
+
+  if(fSize == 0 && !fContainsEmpty) return kFALSE;
+
+  fLeaves.clear();
+  CollectLeaves(candidate, fLeaves);
+
+  for(itLeaves = fLeaves.begin(); itLeaves != fLeaves.end(); ++itLeaves)
+  {
+    if(Contains(*itLeaves)) return kTRUE;
+  }
+
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesOverlapIndex::Contains(UInt_t id) const
+{
+  UInt_t slot;
+
+  if(id == kEmpty) return fContainsEmpty;
+
+  for(slot = Hash(id) & fMask; fTable[slot] != kEmpty; slot = (slot + 1) & fMask)
+  {
+    if(fTable[slot] == id) return kTRUE;
+  }
+
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesOverlapIndex::Insert(UInt_t id)
+{
+  UInt_t slot;
+  vector< UInt_t > table;
+  vector< UInt_t >::const_iterator itTable;
+
+  if(id == kEmpty)
+  {
+    fContainsEmpty = kTRUE;
+    return;
+  }
+
+  for(slot = Hash(id) & fMask; fTable[slot] != kEmpty; slot = (slot + 1) & fMask)
+  {
+    if(fTable[slot] == id) return;
+  }
+
+  fTable[slot] = id;
+  ++fSize;
+
+  // keep the table at most half full
+  if(2*UInt_t(fSize) > fMask)
+  {
+    table.swap(fTable);
+    fMask = 2*fMask + 1;
+    fTable.assign(fMask + 1, kEmpty);
+    fSize = 0;
+    for(itTable = table.begin(); itTable != table.end(); ++itTable)
+    {
+      if(*itTable != kEmpty) Insert(*itTable);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
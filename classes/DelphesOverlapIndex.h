@@ -0,0 +1,74 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesOverlapIndex_h
+#define DelphesOverlapIndex_h
+
+/** \class DelphesOverlapIndex
+ *
+ *  Hash set of the unique IDs of the leaves (candidates without daughters)
+ *  of all claimed candidates.
+ *  Two candidates overlap if their daughter trees share a candidate,
+ *  and then they also share the leaves of this candidate,
+ *  so a candidate overlaps with the claimed candidates
+ *  if one of its leaves is in the set.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class Candidate;
+
+class DelphesOverlapIndex
+{
+public:
+
+  DelphesOverlapIndex();
+  ~DelphesOverlapIndex();
+
+  void Clear();
+
+  // claims all leaves of the candidate
+  void Add(const Candidate *candidate);
+
+  // same result as Candidate::Overlaps with any of the claimed candidates
+  Bool_t Overlaps(const Candidate *candidate);
+
+  // appends unique IDs of all leaves of the candidate, may contain duplicates
+  static void CollectLeaves(const Candidate *candidate, std::vector< UInt_t > &leaves);
+
+private:
+
+  Bool_t Contains(UInt_t id) const;
+  void Insert(UInt_t id);
+
+  Int_t fSize;
+  UInt_t fMask;
+
+  // the ID used to mark free slots is stored separately
+  Bool_t fContainsEmpty;
+
+  // open addressing with linear probing, kEmpty marks free slots
+  std::vector< UInt_t > fTable;
+
+  std::vector< UInt_t > fLeaves;
+};
+
+#endif // DelphesOverlapIndex_h
@@ -0,0 +1,92 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \class DelphesPDGTable
+ *
+ *  Dense table of charges and masses indexed by PDG code.
+ *  Particles with |PDG code| below the table size are looked up
+ *  in TDatabasePDG once, all other particles of TDatabasePDG
+ *  are copied to a map, so that the table can be read from several threads.
+ *
+ */
+
+#include "classes/DelphesPDGTable.h"
+
+#include "TDatabasePDG.h"
+#include "TParticlePDG.h"
+#include "TCollection.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+DelphesPDGTable::DelphesPDGTable(Int_t size) :
+  fSize(size)
+{
+  TParticlePDG *pdgParticle;
+  Int_t pid, charge;
+  Double_t mass;
+
+  fCharges.resize(2*fSize);
+  fMasses.resize(2*fSize);
+
+  for(pid = -fSize; pid < fSize; ++pid)
+  {
+    LookUp(pid, fCharges[pid + fSize], fMasses[pid + fSize]);
+  }
+
+  // TDatabasePDG is loaded by the first look-up and is not read after the constructor
+  TIter itParticles(TDatabasePDG::Instance()->ParticleList());
+  while((pdgParticle = static_cast<TParticlePDG *>(itParticles.Next())))
+  {
+    pid = pdgParticle->PdgCode();
+    if(pid >= -fSize && pid < fSize) continue;
+    LookUp(pid, charge, mass);
+    fParticles[pid] = make_pair(charge, mass);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPDGTable::GetParticle(Int_t pid, Int_t &charge, Double_t &mass) const
+{
+  if(pid >= -fSize && pid < fSize)
+  {
+    charge = fCharges[pid + fSize];
+    mass = fMasses[pid + fSize];
+  }
+  else
+  {
+    map< Int_t, pair< Int_t, Double_t > >::const_iterator itParticles = fParticles.find(pid);
+    charge = itParticles != fParticles.end() ? itParticles->second.first : -999;
+    mass = itParticles != fParticles.end() ? itParticles->second.second : -999.9;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPDGTable::LookUp(Int_t pid, Int_t &charge, Double_t &mass) const
+{
+  TParticlePDG *pdgParticle = TDatabasePDG::Instance()->GetParticle(pid);
+
+  charge = pdgParticle ? Int_t(pdgParticle->Charge()/3.0) : -999;
+  mass = pdgParticle ? pdgParticle->Mass() : -999.9;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,58 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesPDGTable_h
+#define DelphesPDGTable_h
+
+/** \class DelphesPDGTable
+ *
+ *  Dense table of charges and masses indexed by PDG code.
+ *  Particles with |PDG code| below the table size are looked up
+ *  in TDatabasePDG once, all other particles of TDatabasePDG
+ *  are copied to a map, so that the table can be read from several threads.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <map>
+#include <vector>
+#include <utility>
+
+class DelphesPDGTable
+{
+public:
+
+  DelphesPDGTable(Int_t size = 10000);
+
+  // charge in units of e and mass in GeV, -999 and -999.9 for unknown particles
+  void GetParticle(Int_t pid, Int_t &charge, Double_t &mass) const;
+
+private:
+
+  void LookUp(Int_t pid, Int_t &charge, Double_t &mass) const;
+
+  Int_t fSize;
+
+  std::vector< Int_t > fCharges;
+  std::vector< Double_t > fMasses;
+
+  std::map< Int_t, std::pair< Int_t, Double_t > > fParticles;
+};
+
+#endif // DelphesPDGTable_h
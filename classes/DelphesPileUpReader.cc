@@ -21,6 +21,9 @@
  *
  *  Reads pile-up binary file
  *
+ *  Columnar pile-up files written by DelphesColumnarPileUpWriter
+ *  are memory-mapped and their particles are read without copying.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -32,31 +35,51 @@
 #include <sstream>
 
 #include <stdio.h>
+#include <string.h>
 #include <rpc/types.h>
 #include <rpc/xdr.h>
 
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 using namespace std;
 
 static const int kIndexSize = 10000000;
 static const int kBufferSize = 1000000;
 static const int kRecordSize = 9;
 
+static const char kMagic[8] = {'D', 'P', 'U', 'C', 'O', 'L', '0', '1'};
+static const int kHeaderSize = 128;
+static const int kColumns = 9;
+
+//------------------------------------------------------------------------------
+
+static u_quad_t DecodeQuad(const char *input)
+{
+  u_quad_t value = 0;
+  int i;
+  for(i = 7; i >= 0; --i)
+  {
+    value = (value << 8) | static_cast<unsigned char>(input[i]);
+  }
+  return value;
+}
+
 //------------------------------------------------------------------------------
 
 DelphesPileUpReader::DelphesPileUpReader(const char *fileName) :
   fEntries(0), fEntrySize(0), fCounter(0),
   fPileUpFile(0), fIndex(0), fBuffer(0),
-  fInputXDR(0), fIndexXDR(0), fBufferXDR(0)
+  fInputXDR(0), fIndexXDR(0), fBufferXDR(0),
+  fMap(0), fMapSize(0), fParticles(0), fMappedIndex(0), fMappedPID(0)
 {
   stringstream message;
+  char magic[8];
+  int i;
 
-  fIndex = new char[kIndexSize*8];
-  fBuffer = new char[kBufferSize*kRecordSize*4];
-  fInputXDR = new XDR;
-  fIndexXDR = new XDR;
-  fBufferXDR = new XDR;
-  xdrmem_create(fIndexXDR, fIndex, kIndexSize*8, XDR_DECODE);
-  xdrmem_create(fBufferXDR, fBuffer, kBufferSize*kRecordSize*4, XDR_DECODE);
+  for(i = 0; i < kColumns - 1; ++i) fMappedColumns[i] = 0;
+  memset(&fEntry, 0, sizeof(fEntry));
 
   fPileUpFile = fopen(fileName, "r");
 
@@ -66,6 +89,22 @@ DelphesPileUpReader::DelphesPileUpReader(const char *fileName) :
     throw runtime_error(message.str());
   }
 
+  if(fread(magic, 1, 8, fPileUpFile) == 8 && memcmp(magic, kMagic, 8) == 0)
+  {
+    OpenMapped(fileName);
+    return;
+  }
+
+  rewind(fPileUpFile);
+
+  fIndex = new char[kIndexSize*8];
+  fBuffer = new char[kBufferSize*kRecordSize*4];
+  fInputXDR = new XDR;
+  fIndexXDR = new XDR;
+  fBufferXDR = new XDR;
+  xdrmem_create(fIndexXDR, fIndex, kIndexSize*8, XDR_DECODE);
+  xdrmem_create(fBufferXDR, fBuffer, kBufferSize*kRecordSize*4, XDR_DECODE);
+
   xdrstdio_create(fInputXDR, fPileUpFile, XDR_DECODE);
 
   // read number of events
@@ -87,10 +126,11 @@ DelphesPileUpReader::DelphesPileUpReader(const char *fileName) :
 
 DelphesPileUpReader::~DelphesPileUpReader()
 {
-  xdr_destroy(fInputXDR);
+  if(fMap) munmap(fMap, fMapSize);
+  if(fInputXDR) xdr_destroy(fInputXDR);
   if(fPileUpFile) fclose(fPileUpFile);
-  xdr_destroy(fBufferXDR);
-  xdr_destroy(fIndexXDR);
+  if(fBufferXDR) xdr_destroy(fBufferXDR);
+  if(fIndexXDR) xdr_destroy(fIndexXDR);
   if(fBufferXDR) delete fBufferXDR;
   if(fIndexXDR) delete fIndexXDR;
   if(fInputXDR) delete fInputXDR;
@@ -100,12 +140,139 @@ DelphesPileUpReader::~DelphesPileUpReader()
 
 //------------------------------------------------------------------------------
 
+void DelphesPileUpReader::OpenMapped(const char *fileName)
+{
+  stringstream message;
+  struct stat status;
+  void *map;
+  const unsigned int one = 1;
+  u_quad_t offset;
+  int i;
+
+  // columns are used in place, so they must match the host byte order
+  if(*reinterpret_cast<const char *>(&one) != 1)
+  {
+    message << "can't read columnar pile-up file " << fileName << " on a big-endian host";
+    throw runtime_error(message.str());
+  }
+
+  if(fstat(fileno(fPileUpFile), &status) != 0 || status.st_size < kHeaderSize)
+  {
+    message << "can't read pile-up file " << fileName;
+    throw runtime_error(message.str());
+  }
+
+  fMapSize = status.st_size;
+  map = mmap(0, fMapSize, PROT_READ, MAP_SHARED, fileno(fPileUpFile), 0);
+
+  // the mapping stays valid after the file is closed
+  fclose(fPileUpFile);
+  fPileUpFile = 0;
+
+  if(map == MAP_FAILED)
+  {
+    message << "can't map pile-up file " << fileName;
+    throw runtime_error(message.str());
+  }
+
+  fMap = static_cast<char *>(map);
+
+  fEntries = DecodeQuad(fMap + 8);
+  fParticles = DecodeQuad(fMap + 16);
+
+  // values from the file can be large enough to overflow,
+  // sizes are compared with the space left after the offsets
+  offset = DecodeQuad(fMap + 24);
+  if(offset % 8 != 0 || offset > fMapSize || fEntries < 0
+  || u_quad_t(fEntries) >= (fMapSize - offset)/8)
+  {
+    message << "corrupted index in pile-up file " << fileName;
+    throw runtime_error(message.str());
+  }
+  fMappedIndex = fMap + offset;
+
+  for(i = 0; i < kColumns; ++i)
+  {
+    offset = DecodeQuad(fMap + 32 + i*8);
+    if(offset % 4 != 0 || offset > fMapSize || fParticles > (fMapSize - offset)/4)
+    {
+      message << "corrupted columns in pile-up file " << fileName;
+      throw runtime_error(message.str());
+    }
+
+    if(i == 0)
+    {
+      fMappedPID = reinterpret_cast<const int *>(fMap + offset);
+    }
+    else
+    {
+      fMappedColumns[i - 1] = reinterpret_cast<const float *>(fMap + offset);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPileUpReader::GetMappedEntry(quad_t entry, DelphesPileUpEntry &particles) const
+{
+  u_quad_t first, last;
+
+  if(entry < 0 || entry >= fEntries)
+  {
+    throw runtime_error("invalid entry in pile-up file");
+  }
+
+  first = DecodeQuad(fMappedIndex + 8*entry);
+  last = DecodeQuad(fMappedIndex + 8*entry + 8);
+
+  // the columns hold fParticles values
+  if(last < first || last > fParticles)
+  {
+    throw runtime_error("corrupted index in pile-up file");
+  }
+
+  if(last - first >= u_quad_t(kBufferSize))
+  {
+    throw runtime_error("too many particles in pile-up event");
+  }
+
+  particles.size = last - first;
+  particles.pid = fMappedPID + first;
+  particles.x = fMappedColumns[0] + first;
+  particles.y = fMappedColumns[1] + first;
+  particles.z = fMappedColumns[2] + first;
+  particles.t = fMappedColumns[3] + first;
+  particles.px = fMappedColumns[4] + first;
+  particles.py = fMappedColumns[5] + first;
+  particles.pz = fMappedColumns[6] + first;
+  particles.e = fMappedColumns[7] + first;
+}
+
+//------------------------------------------------------------------------------
+
 bool DelphesPileUpReader::ReadParticle(int &pid,
   float &x, float &y, float &z, float &t,
   float &px, float &py, float &pz, float &e)
 {
   if(fCounter >= fEntrySize) return false;
 
+  if(fMap)
+  {
+    pid = fEntry.pid[fCounter];
+    x = fEntry.x[fCounter];
+    y = fEntry.y[fCounter];
+    z = fEntry.z[fCounter];
+    t = fEntry.t[fCounter];
+    px = fEntry.px[fCounter];
+    py = fEntry.py[fCounter];
+    pz = fEntry.pz[fCounter];
+    e = fEntry.e[fCounter];
+
+    ++fCounter;
+
+    return true;
+  }
+
   xdr_int(fBufferXDR, &pid);
   xdr_float(fBufferXDR, &x);
   xdr_float(fBufferXDR, &y);
@@ -126,23 +293,43 @@ bool DelphesPileUpReader::ReadParticle(int &pid,
 bool DelphesPileUpReader::ReadEntry(quad_t entry)
 {
   quad_t offset;
+  ssize_t size;
 
   if(entry >= fEntries) return false;
 
+  if(fMap)
+  {
+    GetMappedEntry(entry, fEntry);
+    fEntrySize = fEntry.size;
+    fCounter = 0;
+    return true;
+  }
+
   // read event position
   xdr_setpos(fIndexXDR, 8*entry);
   xdr_hyper(fIndexXDR, &offset);
 
-  // read event
-  fseeko(fPileUpFile, offset, SEEK_SET);
-  xdr_int(fInputXDR, &fEntrySize);
+  // read event, pread doesn't move the file offset
+  // that is shared with the forked worker processes
+  if(pread(fileno(fPileUpFile), fBuffer, 4, offset) != 4)
+  {
+    throw runtime_error("can't read pile-up event");
+  }
 
-  if(fEntrySize >= kBufferSize)
+  xdr_setpos(fBufferXDR, 0);
+  xdr_int(fBufferXDR, &fEntrySize);
+
+  if(fEntrySize < 0 || fEntrySize >= kBufferSize)
   {
     throw runtime_error("too many particles in pile-up event");
   }
 
-  xdr_opaque(fInputXDR, fBuffer, fEntrySize*kRecordSize*4);
+  size = fEntrySize*kRecordSize*4;
+  if(pread(fileno(fPileUpFile), fBuffer, size, offset + 4) != size)
+  {
+    throw runtime_error("can't read pile-up event");
+  }
+
   xdr_setpos(fBufferXDR, 0);
   fCounter = 0;
 
@@ -150,3 +337,44 @@ bool DelphesPileUpReader::ReadEntry(quad_t entry)
 }
 
 //------------------------------------------------------------------------------
+
+bool DelphesPileUpReader::ReadEntry(quad_t entry, DelphesPileUpEntry &particles)
+{
+  int i, j;
+
+  if(entry >= fEntries) return false;
+
+  if(fMap)
+  {
+    GetMappedEntry(entry, particles);
+    return true;
+  }
+
+  // decode XDR records into columns
+  ReadEntry(entry);
+
+  fPIDBuffer.resize(fEntrySize + 1);
+  for(j = 0; j < kRecordSize - 1; ++j) fBuffers[j].resize(fEntrySize + 1);
+
+  for(i = 0; i < fEntrySize; ++i)
+  {
+    ReadParticle(fPIDBuffer[i],
+      fBuffers[0][i], fBuffers[1][i], fBuffers[2][i], fBuffers[3][i],
+      fBuffers[4][i], fBuffers[5][i], fBuffers[6][i], fBuffers[7][i]);
+  }
+
+  particles.size = fEntrySize;
+  particles.pid = &fPIDBuffer[0];
+  particles.x = &fBuffers[0][0];
+  particles.y = &fBuffers[1][0];
+  particles.z = &fBuffers[2][0];
+  particles.t = &fBuffers[3][0];
+  particles.px = &fBuffers[4][0];
+  particles.py = &fBuffers[5][0];
+  particles.pz = &fBuffers[6][0];
+  particles.e = &fBuffers[7][0];
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
@@ -23,6 +23,9 @@
  *
  *  Reads pile-up binary file
  *
+ *  Columnar pile-up files written by DelphesColumnarPileUpWriter
+ *  are memory-mapped and their particles are read without copying.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -31,6 +34,16 @@
 #include <rpc/types.h>
 #include <rpc/xdr.h>
 
+#include <vector>
+
+struct DelphesPileUpEntry
+{
+  int size;
+  const int *pid;
+  const float *x, *y, *z, *t;
+  const float *px, *py, *pz, *e;
+};
+
 class DelphesPileUpReader
 {
 public:
@@ -45,10 +58,21 @@ public:
 
   bool ReadEntry(quad_t entry);
 
+  // arrays of particle properties of the entry,
+  // they stay valid until the next call for XDR files
+  // and as long as the reader exists for columnar files
+  bool ReadEntry(quad_t entry, DelphesPileUpEntry &particles);
+
   quad_t GetEntries() const { return fEntries; }
 
+  bool IsMapped() const { return fMap != 0; }
+
 private:
 
+  void OpenMapped(const char *fileName);
+
+  void GetMappedEntry(quad_t entry, DelphesPileUpEntry &particles) const;
+
   quad_t fEntries;
 
   int fEntrySize;
@@ -61,6 +85,21 @@ private:
   XDR *fInputXDR;
   XDR *fIndexXDR;
   XDR *fBufferXDR;
+
+  char *fMap;
+  size_t fMapSize;
+
+  // number of particles in the columns of a columnar file
+  u_quad_t fParticles;
+
+  const char *fMappedIndex;
+  const int *fMappedPID;
+  const float *fMappedColumns[8];
+
+  DelphesPileUpEntry fEntry;
+
+  std::vector< int > fPIDBuffer;
+  std::vector< float > fBuffers[8];
 };
 
 #endif // DelphesPileUpReader_h
@@ -0,0 +1,330 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \class DelphesPropagationBatch
+ *
+ *  Propagates a batch of particles to a cylinder centered at (0,0,0)
+ *  with its axis oriented along the z-axis.
+ *  Neutral particles follow straight lines, charged particles follow helices.
+ *  Positions and momenta are stored as structure of arrays,
+ *  each kind of trajectory is solved in one branch-free loop
+ *  that the compiler can vectorize.
+ *
+ */
+
+#include "classes/DelphesPropagationBatch.h"
+
+#include "TMath.h"
+
+#include <cmath>
+
+using namespace std;
+
+static const Double_t kCLight = 2.99792458E8;
+
+// with GCC on x86-64 the kernels are compiled for AVX-512, AVX2 and the default
+// instruction set, the best version is selected when the library is loaded
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define PROPAGATION_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define PROPAGATION_KERNEL
+#endif
+
+//------------------------------------------------------------------------------
+
+void DelphesPropagationBatch::Arrays::Clear()
+{
+  x.clear(); y.clear(); z.clear();
+  px.clear(); py.clear(); pz.clear();
+  pt2.clear(); e.clear(); q.clear();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPropagationBatch::Arrays::Resize(Int_t size)
+{
+  xOut.resize(size); yOut.resize(size); zOut.resize(size); tOut.resize(size);
+  dxy.resize(size); xd.resize(size); yd.resize(size); zd.resize(size);
+  valid.resize(size);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesPropagationBatch::DelphesPropagationBatch() :
+  fRadius(1.0), fRadius2(1.0), fHalfLength(3.0), fBz(0.0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+DelphesPropagationBatch::~DelphesPropagationBatch()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPropagationBatch::SetCylinder(Double_t radius, Double_t halfLength, Double_t bz)
+{
+  fRadius = radius;
+  fRadius2 = radius*radius;
+  fHalfLength = halfLength;
+  fBz = bz;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPropagationBatch::Clear()
+{
+  fLine.Clear();
+  fHelix.Clear();
+  fOrder.clear();
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesPropagationBatch::Add(Double_t x, Double_t y, Double_t z, Double_t px, Double_t py, Double_t pz, Double_t e, Double_t q)
+{
+  Arrays *arrays;
+  Double_t pt2;
+
+  x *= 1.0E-3;
+  y *= 1.0E-3;
+  z *= 1.0E-3;
+
+  // check that particle position is inside the cylinder
+  if(x*x + y*y > fRadius2 || TMath::Abs(z) > fHalfLength) return kFALSE;
+
+  pt2 = px*px + py*py;
+  if(pt2 < 1.0E-9) return kFALSE;
+
+  if(TMath::Abs(q) < 1.0E-9 || TMath::Abs(fBz) < 1.0E-9)
+  {
+    fOrder.push_back(fLine.x.size());
+    arrays = &fLine;
+  }
+  else
+  {
+    fOrder.push_back(~Int_t(fHelix.x.size()));
+    arrays = &fHelix;
+  }
+
+  arrays->x.push_back(x);
+  arrays->y.push_back(y);
+  arrays->z.push_back(z);
+  arrays->px.push_back(px);
+  arrays->py.push_back(py);
+  arrays->pz.push_back(pz);
+  arrays->pt2.push_back(pt2);
+  arrays->e.push_back(e);
+  arrays->q.push_back(q);
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPropagationBatch::Propagate()
+{
+  PropagateLines();
+  PropagateHelices();
+}
+
+//------------------------------------------------------------------------------
+
+// the kernels take restricted pointers, so that the compiler doesn't
+// have to check that the input and output arrays don't overlap
+
+PROPAGATION_KERNEL
+static void PropagateLinesKernel(Int_t size, Double_t radius2, Double_t halfLength,
+  const Double_t *__restrict__ x, const Double_t *__restrict__ y, const Double_t *__restrict__ z,
+  const Double_t *__restrict__ px, const Double_t *__restrict__ py, const Double_t *__restrict__ pz,
+  const Double_t *__restrict__ pt2, const Double_t *__restrict__ e,
+  Double_t *__restrict__ xOut, Double_t *__restrict__ yOut, Double_t *__restrict__ zOut, Double_t *__restrict__ tOut,
+  Char_t *__restrict__ valid)
+{
+  Int_t i;
+  Double_t tmp, discr, discr2, t, t1, t2, t3, t4, z_t, pzInv;
+
+  for(i = 0; i < size; ++i)
+  {
+    // solve pt2*t^2 + 2*(px*x + py*y)*t - (fRadius2 - x*x - y*y) = 0
+    tmp = px[i]*y[i] - py[i]*x[i];
+    discr2 = pt2[i]*radius2 - tmp*tmp;
+
+    // no solutions for negative discriminant
+    valid[i] = discr2 >= 0.0;
+
+    tmp = px[i]*x[i] + py[i]*y[i];
+    discr = sqrt(discr2 > 0.0 ? discr2 : 0.0);
+    t1 = (-tmp + discr)/pt2[i];
+    t2 = (-tmp - discr)/pt2[i];
+    t = (t1 < 0.0) ? t2 : t1;
+
+    // exit from the front or the back, pz can't be zero in this case
+    z_t = z[i] + pz[i]*t;
+    pzInv = 1.0/((pz[i] != 0.0) ? pz[i] : 1.0);
+    t3 = (+halfLength - z[i])*pzInv;
+    t4 = (-halfLength - z[i])*pzInv;
+    t = (TMath::Abs(z_t) > halfLength) ? ((t3 < 0.0) ? t4 : t3) : t;
+
+    xOut[i] = (x[i] + px[i]*t)*1.0E3;
+    yOut[i] = (y[i] + py[i]*t)*1.0E3;
+    zOut[i] = (z[i] + pz[i]*t)*1.0E3;
+    tOut[i] = t*e[i]*1.0E3;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+PROPAGATION_KERNEL
+static void PropagateHelicesKernel(Int_t size, Double_t radius, Double_t halfLength, Double_t bz,
+  const Double_t *__restrict__ x, const Double_t *__restrict__ y, const Double_t *__restrict__ z,
+  const Double_t *__restrict__ px, const Double_t *__restrict__ py, const Double_t *__restrict__ pz,
+  const Double_t *__restrict__ pt2, const Double_t *__restrict__ e, const Double_t *__restrict__ q,
+  Double_t *__restrict__ xOut, Double_t *__restrict__ yOut, Double_t *__restrict__ zOut, Double_t *__restrict__ tOut,
+  Double_t *__restrict__ dxy, Double_t *__restrict__ xd, Double_t *__restrict__ yd, Double_t *__restrict__ zd,
+  Char_t *__restrict__ valid)
+{
+  Int_t i;
+  Double_t pt, gammam, omega, r, rcu, phi_0, sinPhi0, cosPhi0;
+  Double_t x_c, y_c, r_c, rc2, phi, xdi, ydi, t, t_r, t_z;
+  Double_t t1, t2, t3, t4, t5, t6;
+  Double_t asinrho, delta, x_t, y_t, z_t;
+
+  const Double_t radius2 = radius*radius;
+  const Double_t pi = TMath::Pi();
+
+  for(i = 0; i < size; ++i)
+  {
+    // 1.  initial transverse momentum p_{T0}
+    //     initial transverse momentum direction phi_0
+    //     relativistic gamma: gamma = E/mc^2; gammam = gamma * m
+    //     gyration frequency omega = q/(gamma m) fBz
+    //     helix radius r = p_{T0} / (omega gamma m)
+
+    pt = sqrt(pt2[i]);
+    gammam = e[i]*1.0E9/(kCLight*kCLight);   // gammam in [eV/c^2]
+    omega = q[i]*bz/gammam;                 // omega is here in [89875518/s]
+    r = pt/(q[i]*bz)*1.0E9/kCLight;         // in [m]
+
+    phi_0 = atan2(py[i], px[i]); // [rad] in [-pi, pi]
+    sinPhi0 = py[i]/pt;
+    cosPhi0 = px[i]/pt;
+
+    // 2. helix axis coordinates
+    x_c = x[i] + r*sinPhi0;
+    y_c = y[i] - r*cosPhi0;
+    rc2 = x_c*x_c + y_c*y_c;
+    r_c = sqrt(rc2);
+    phi = atan2(y_c, x_c) + ((x_c < 0.0) ? pi : 0.0);
+
+    rcu = TMath::Abs(r);
+
+    // calculate coordinates of closest approach to track circle in transverse plane xd, yd, zd
+    xdi = (rc2 > 0.0) ? (x_c*x_c*x_c - x_c*rcu*r_c + x_c*y_c*y_c)/rc2 : -999;
+    ydi = (rc2 > 0.0) ? (y_c*(-rcu*r_c + rc2))/rc2 : -999;
+
+    xd[i] = xdi*1.0E3;
+    yd[i] = ydi*1.0E3;
+    zd[i] = (z[i] + (sqrt(xdi*xdi + ydi*ydi) - sqrt(x[i]*x[i] + y[i]*y[i]))*pz[i]/pt)*1.0E3;
+
+    // calculate impact paramater
+    dxy[i] = (xdi*py[i] - ydi*px[i])/pt*1.0E3;
+
+    // 3. time evaluation t = TMath::Min(t_r, t_z)
+    //    t_r : time to exit from the sides
+    //    t_z : time to exit from the front or the back
+    t_z = (pz[i] == 0.0) ? 1.0E99 : gammam/(pz[i]*1.0E9/kCLight)*(-z[i] + ((pz[i] > 0.0) ? halfLength : -halfLength));
+
+    asinrho = asin((radius2 - rc2 - r*r)/(2*rcu*r_c));
+    delta = phi_0 - phi;
+    delta += (delta < -pi) ? 2*pi : 0.0;
+    delta -= (delta > pi) ? 2*pi : 0.0;
+
+    t1 = (delta + asinrho)/omega;
+    t2 = (delta + pi - asinrho)/omega;
+    t3 = (delta + pi + asinrho)/omega;
+    t4 = (delta - asinrho)/omega;
+    t5 = (delta - pi - asinrho)/omega;
+    t6 = (delta - pi + asinrho)/omega;
+
+    t1 = (t1 < 0.0) ? 1.0E99 : t1;
+    t2 = (t2 < 0.0) ? 1.0E99 : t2;
+    t3 = (t3 < 0.0) ? 1.0E99 : t3;
+    t4 = (t4 < 0.0) ? 1.0E99 : t4;
+    t5 = (t5 < 0.0) ? 1.0E99 : t5;
+    t6 = (t6 < 0.0) ? 1.0E99 : t6;
+
+    t_r = TMath::Min(TMath::Min(t1, TMath::Min(t2, t3)), TMath::Min(t4, TMath::Min(t5, t6)));
+
+    // the helix does not cross the cylinder sides if r_c + |r| < fRadius
+    t = (r_c + rcu < radius) ? t_z : TMath::Min(t_r, t_z);
+
+    // 4. position in terms of x(t), y(t), z(t)
+    x_t = x_c + r*sin(omega*t - phi_0);
+    y_t = y_c + r*cos(omega*t - phi_0);
+    z_t = z[i] + pz[i]*1.0E9/kCLight/gammam*t;
+
+    valid[i] = x_t*x_t + y_t*y_t > 0.0;
+
+    xOut[i] = x_t*1.0E3;
+    yOut[i] = y_t*1.0E3;
+    zOut[i] = z_t*1.0E3;
+    tOut[i] = t*kCLight*1.0E3;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPropagationBatch::PropagateLines()
+{
+  Int_t size = fLine.x.size();
+
+  if(size == 0) return;
+
+  fLine.Resize(size);
+
+  PropagateLinesKernel(size, fRadius2, fHalfLength,
+    &fLine.x[0], &fLine.y[0], &fLine.z[0],
+    &fLine.px[0], &fLine.py[0], &fLine.pz[0],
+    &fLine.pt2[0], &fLine.e[0],
+    &fLine.xOut[0], &fLine.yOut[0], &fLine.zOut[0], &fLine.tOut[0],
+    &fLine.valid[0]);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesPropagationBatch::PropagateHelices()
+{
+  Int_t size = fHelix.x.size();
+
+  if(size == 0) return;
+
+  fHelix.Resize(size);
+
+  PropagateHelicesKernel(size, fRadius, fHalfLength, fBz,
+    &fHelix.x[0], &fHelix.y[0], &fHelix.z[0],
+    &fHelix.px[0], &fHelix.py[0], &fHelix.pz[0],
+    &fHelix.pt2[0], &fHelix.e[0], &fHelix.q[0],
+    &fHelix.xOut[0], &fHelix.yOut[0], &fHelix.zOut[0], &fHelix.tOut[0],
+    &fHelix.dxy[0], &fHelix.xd[0], &fHelix.yd[0], &fHelix.zd[0],
+    &fHelix.valid[0]);
+}
+
+//------------------------------------------------------------------------------
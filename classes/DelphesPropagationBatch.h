@@ -0,0 +1,100 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesPropagationBatch_h
+#define DelphesPropagationBatch_h
+
+/** \class DelphesPropagationBatch
+ *
+ *  Propagates a batch of particles to a cylinder centered at (0,0,0)
+ *  with its axis oriented along the z-axis.
+ *  Neutral particles follow straight lines, charged particles follow helices.
+ *  Positions and momenta are stored as structure of arrays,
+ *  each kind of trajectory is solved in one branch-free loop
+ *  that the compiler can vectorize.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class DelphesPropagationBatch
+{
+public:
+
+  DelphesPropagationBatch();
+  ~DelphesPropagationBatch();
+
+  // radius and half-length in [m], magnetic field in [T]
+  void SetCylinder(Double_t radius, Double_t halfLength, Double_t bz);
+
+  void Clear();
+
+  // position in [mm], momentum and energy in [GeV],
+  // returns false and ignores the particle if it starts outside of the cylinder
+  // or if its transverse momentum is too low
+  Bool_t Add(Double_t x, Double_t y, Double_t z, Double_t px, Double_t py, Double_t pz, Double_t e, Double_t q);
+
+  void Propagate();
+
+  // results are indexed in the order of the accepted particles
+  Int_t GetSize() const { return fOrder.size(); }
+
+  Bool_t IsHelix(Int_t i) const { return fOrder[i] < 0; }
+
+  // returns false if the particle doesn't reach the cylinder
+  Bool_t IsValid(Int_t i) const { return fOrder[i] < 0 ? fHelix.valid[~fOrder[i]] : fLine.valid[fOrder[i]]; }
+
+  // exit position in [mm] and time offset in [mm/c]
+  Double_t GetX(Int_t i) const { return fOrder[i] < 0 ? fHelix.xOut[~fOrder[i]] : fLine.xOut[fOrder[i]]; }
+  Double_t GetY(Int_t i) const { return fOrder[i] < 0 ? fHelix.yOut[~fOrder[i]] : fLine.yOut[fOrder[i]]; }
+  Double_t GetZ(Int_t i) const { return fOrder[i] < 0 ? fHelix.zOut[~fOrder[i]] : fLine.zOut[fOrder[i]]; }
+  Double_t GetT(Int_t i) const { return fOrder[i] < 0 ? fHelix.tOut[~fOrder[i]] : fLine.tOut[fOrder[i]]; }
+
+  // impact parameter and point of closest approach in [mm], only for helices
+  Double_t GetDxy(Int_t i) const { return fHelix.dxy[~fOrder[i]]; }
+  Double_t GetXd(Int_t i) const { return fHelix.xd[~fOrder[i]]; }
+  Double_t GetYd(Int_t i) const { return fHelix.yd[~fOrder[i]]; }
+  Double_t GetZd(Int_t i) const { return fHelix.zd[~fOrder[i]]; }
+
+private:
+
+  struct Arrays
+  {
+    void Clear();
+    void Resize(Int_t size);
+
+    std::vector< Double_t > x, y, z, px, py, pz, pt2, e, q;
+    std::vector< Double_t > xOut, yOut, zOut, tOut;
+    std::vector< Double_t > dxy, xd, yd, zd;
+    std::vector< Char_t > valid;
+  };
+
+  void PropagateLines();
+  void PropagateHelices();
+
+  Double_t fRadius, fRadius2, fHalfLength, fBz;
+
+  Arrays fLine, fHelix;
+
+  // index in fLine if positive or zero, bitwise complement of index in fHelix otherwise
+  std::vector< Int_t > fOrder;
+};
+
+#endif // DelphesPropagationBatch_h
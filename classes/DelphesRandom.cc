@@ -0,0 +1,206 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \class DelphesRandom
+ *
+ *  Counter-based random number generator (Philox4x32-10).
+ *  The numbers depend only on the run seed, the stream name
+ *  and the event number, so any event gives the same numbers
+ *  independently of the order in which events and modules are processed.
+ *
+ */
+
+#include "classes/DelphesRandom.h"
+
+#include "TMath.h"
+
+using namespace std;
+
+static const UInt_t kPhiloxM0 = 0xD2511F53;
+static const UInt_t kPhiloxM1 = 0xCD9E8D57;
+static const UInt_t kPhiloxW0 = 0x9E3779B9;
+static const UInt_t kPhiloxW1 = 0xBB67AE85;
+
+// 2^-53
+static const Double_t kScale53 = 1.0/9007199254740992.0;
+
+//------------------------------------------------------------------------------
+
+static ULong64_t Mix(ULong64_t value)
+{
+  // splitmix64 finalizer
+  value += 0x9E3779B97F4A7C15ULL;
+  value = (value ^ (value >> 30))*0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27))*0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesRandom::DelphesRandom() :
+  TRandom(), fPosition(4)
+{
+  SetStream(0, "", 0);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesRandom::SetStream(ULong64_t seed, const char *name, ULong64_t event)
+{
+  ULong64_t hash, key;
+  const char *it;
+
+  // FNV-1a hash of the stream name
+  hash = 0xCBF29CE484222325ULL;
+  for(it = name; *it; ++it)
+  {
+    hash = (hash ^ static_cast<unsigned char>(*it))*0x100000001B3ULL;
+  }
+
+  key = Mix(Mix(seed) ^ hash);
+
+  fKey[0] = key & 0xFFFFFFFF;
+  fKey[1] = key >> 32;
+
+  // the event number is the upper half of the counter,
+  // the lower half counts blocks of random numbers
+  fCounter[0] = 0;
+  fCounter[1] = 0;
+  fCounter[2] = event & 0xFFFFFFFF;
+  fCounter[3] = event >> 32;
+
+  fPosition = 4;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesRandom::Generate()
+{
+  UInt_t key[2], block[4];
+  ULong64_t product0, product1;
+  Int_t round;
+
+  key[0] = fKey[0];
+  key[1] = fKey[1];
+
+  block[0] = fCounter[0];
+  block[1] = fCounter[1];
+  block[2] = fCounter[2];
+  block[3] = fCounter[3];
+
+  for(round = 0; round < 10; ++round)
+  {
+    product0 = ULong64_t(kPhiloxM0)*block[0];
+    product1 = ULong64_t(kPhiloxM1)*block[2];
+
+    block[0] = UInt_t(product1 >> 32) ^ block[1] ^ key[0];
+    block[1] = UInt_t(product1);
+    block[2] = UInt_t(product0 >> 32) ^ block[3] ^ key[1];
+    block[3] = UInt_t(product0);
+
+    key[0] += kPhiloxW0;
+    key[1] += kPhiloxW1;
+  }
+
+  fBlock[0] = block[0];
+  fBlock[1] = block[1];
+  fBlock[2] = block[2];
+  fBlock[3] = block[3];
+
+  if(++fCounter[0] == 0) ++fCounter[1];
+
+  fPosition = 0;
+}
+
+//------------------------------------------------------------------------------
+
+inline Double_t DelphesRandom::Next()
+{
+  UInt_t high, low;
+
+  if(fPosition >= 4) Generate();
+
+  high = fBlock[fPosition] >> 5;
+  low = fBlock[fPosition + 1] >> 6;
+  fPosition += 2;
+
+  // 53 random bits, in (0, 1)
+  return (high*67108864.0 + low + 0.5)*kScale53;
+}
+
+//------------------------------------------------------------------------------
+
+Double_t DelphesRandom::Rndm()
+{
+  return Next();
+}
+
+//------------------------------------------------------------------------------
+
+Double_t DelphesRandom::Rndm(Int_t)
+{
+  return Next();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesRandom::RndmArray(Int_t n, Float_t *array)
+{
+  Int_t i;
+  Float_t value;
+
+  for(i = 0; i < n; ++i)
+  {
+    // rounding to float may give 1.0
+    do value = Next(); while(value >= 1.0f);
+    array[i] = value;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesRandom::RndmArray(Int_t n, Double_t *array)
+{
+  Int_t i;
+
+  for(i = 0; i < n; ++i)
+  {
+    array[i] = Next();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesRandom::GausArray(Int_t n, Double_t *array, Double_t mean, Double_t sigma)
+{
+  Int_t i;
+  Double_t radius, phi;
+
+  // Box-Muller transformation, two numbers per pair of uniform numbers
+  for(i = 0; i < n; i += 2)
+  {
+    radius = sigma*TMath::Sqrt(-2.0*TMath::Log(Next()));
+    phi = TMath::TwoPi()*Next();
+
+    array[i] = mean + radius*TMath::Cos(phi);
+    if(i + 1 < n) array[i + 1] = mean + radius*TMath::Sin(phi);
+  }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,66 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesRandom_h
+#define DelphesRandom_h
+
+/** \class DelphesRandom
+ *
+ *  Counter-based random number generator (Philox4x32-10).
+ *  The numbers depend only on the run seed, the stream name
+ *  and the event number, so any event gives the same numbers
+ *  independently of the order in which events and modules are processed.
+ *
+ */
+
+#include "TRandom.h"
+
+class DelphesRandom: public TRandom
+{
+public:
+
+  DelphesRandom();
+
+  // selects the stream and restarts it from the beginning
+  void SetStream(ULong64_t seed, const char *name, ULong64_t event);
+
+  // TRandom::Rndm lost its unused argument in newer ROOT versions,
+  // both signatures are provided so that one of them overrides it
+  virtual Double_t Rndm();
+  virtual Double_t Rndm(Int_t);
+
+  virtual void RndmArray(Int_t n, Float_t *array);
+  virtual void RndmArray(Int_t n, Double_t *array);
+
+  // n Gaussian random numbers
+  void GausArray(Int_t n, Double_t *array, Double_t mean = 0.0, Double_t sigma = 1.0);
+
+private:
+
+  Double_t Next();
+
+  void Generate();
+
+  UInt_t fKey[2];
+  UInt_t fCounter[4];
+
+  UInt_t fBlock[4];
+  Int_t fPosition;
+};
+
+#endif // DelphesRandom_h
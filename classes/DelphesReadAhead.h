@@ -0,0 +1,293 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesReadAhead_h
+#define DelphesReadAhead_h
+
+/** \class DelphesReadAhead
+ *
+ *  Fills event records in a separate thread while the current event is processed.
+ *  Readers implement ReadRecord, which parses the next event of the input
+ *  into a record without ROOT objects.
+ *  Records are handed out by NextRecord in the order of the input
+ *  and are reused once they are returned with ReleaseRecord.
+ *  Records can be written to byte buffers and read back,
+ *  so that they can be sent to worker processes.
+ *
+ */
+
+#include <deque>
+#include <vector>
+#include <stdexcept>
+
+#include <string.h>
+#include <pthread.h>
+
+template< typename T >
+class DelphesReadAhead
+{
+public:
+
+  DelphesReadAhead() :
+    fDepth(0), fRunning(false), fStop(false), fEndOfInput(false)
+  {
+    pthread_mutex_init(&fMutex, 0);
+    pthread_cond_init(&fFreeCondition, 0);
+    pthread_cond_init(&fReadyCondition, 0);
+  }
+
+  // derived classes must call StopReading in their destructor
+  virtual ~DelphesReadAhead()
+  {
+    typename std::vector< T * >::iterator itRecords;
+
+    for(itRecords = fRecords.begin(); itRecords != fRecords.end(); ++itRecords)
+    {
+      delete *itRecords;
+    }
+
+    pthread_cond_destroy(&fReadyCondition);
+    pthread_cond_destroy(&fFreeCondition);
+    pthread_mutex_destroy(&fMutex);
+  }
+
+  // number of events parsed ahead, 0 disables the reading thread
+  void SetDepth(int depth)
+  {
+    int i;
+
+    StopReading();
+
+    fDepth = depth < 0 ? 0 : depth;
+
+    // one more record is kept by the caller while the next ones are filled
+    for(i = fRecords.size(); i < fDepth + 1; ++i)
+    {
+      fRecords.push_back(new T);
+    }
+  }
+
+  int GetDepth() const { return fDepth; }
+
+  bool IsReading() const { return fRunning; }
+
+protected:
+
+  // fills the next record in the reading thread,
+  // returns false at the end of the input or after invalid input
+  virtual bool ReadRecord(T &record) = 0;
+
+  void StartReading()
+  {
+    StopReading();
+
+    if(fDepth == 0) return;
+
+    fEndOfInput = false;
+    fFreeRecords.assign(fRecords.begin(), fRecords.begin() + fDepth + 1);
+
+    if(pthread_create(&fThread, 0, Work, this) != 0)
+    {
+      throw std::runtime_error("can't create reading thread");
+    }
+
+    fRunning = true;
+  }
+
+  void StopReading()
+  {
+    if(!fRunning) return;
+
+    pthread_mutex_lock(&fMutex);
+    fStop = true;
+    pthread_cond_broadcast(&fFreeCondition);
+    pthread_mutex_unlock(&fMutex);
+
+    pthread_join(fThread, 0);
+
+    fRunning = false;
+    fStop = false;
+    fFreeRecords.clear();
+    fReadyRecords.clear();
+  }
+
+  // can be checked by ReadRecord between blocks of input
+  bool IsStopping()
+  {
+    bool stop;
+
+    pthread_mutex_lock(&fMutex);
+    stop = fStop;
+    pthread_mutex_unlock(&fMutex);
+
+    return stop;
+  }
+
+  // waits for the next record, returns 0 at the end of the input
+  T *NextRecord()
+  {
+    T *record = 0;
+
+    pthread_mutex_lock(&fMutex);
+    while(fReadyRecords.empty() && !fEndOfInput)
+    {
+      pthread_cond_wait(&fReadyCondition, &fMutex);
+    }
+    if(!fReadyRecords.empty())
+    {
+      record = fReadyRecords.front();
+      fReadyRecords.pop_front();
+    }
+    pthread_mutex_unlock(&fMutex);
+
+    return record;
+  }
+
+  void ReleaseRecord(T *record)
+  {
+    pthread_mutex_lock(&fMutex);
+    fFreeRecords.push_back(record);
+    pthread_cond_signal(&fFreeCondition);
+    pthread_mutex_unlock(&fMutex);
+  }
+
+  // append plain values and arrays of plain values to buffer
+  template< typename V >
+  static void WriteValue(std::vector< char > &buffer, const V &value)
+  {
+    const char *data = reinterpret_cast< const char * >(&value);
+    buffer.insert(buffer.end(), data, data + sizeof(V));
+  }
+
+  template< typename V >
+  static void WriteArray(std::vector< char > &buffer, const std::vector< V > &array)
+  {
+    const char *data;
+    size_t size = array.size();
+
+    WriteValue(buffer, size);
+
+    if(size == 0) return;
+
+    data = reinterpret_cast< const char * >(&array[0]);
+    buffer.insert(buffer.end(), data, data + size*sizeof(V));
+  }
+
+  // read values back in the order they were written, position is moved past each value
+  template< typename V >
+  static void ReadValue(const std::vector< char > &buffer, size_t &position, V &value)
+  {
+    if(position + sizeof(V) > buffer.size())
+    {
+      throw std::runtime_error("truncated event record");
+    }
+
+    memcpy(&value, &buffer[position], sizeof(V));
+    position += sizeof(V);
+  }
+
+  template< typename V >
+  static void ReadArray(const std::vector< char > &buffer, size_t &position, std::vector< V > &array)
+  {
+    size_t size;
+
+    ReadValue(buffer, position, size);
+
+    if(position + size*sizeof(V) > buffer.size())
+    {
+      throw std::runtime_error("truncated event record");
+    }
+
+    array.resize(size);
+
+    if(size == 0) return;
+
+    memcpy(&array[0], &buffer[position], size*sizeof(V));
+    position += size*sizeof(V);
+  }
+
+private:
+
+  static void *Work(void *reader)
+  {
+    static_cast< DelphesReadAhead< T > * >(reader)->Loop();
+    return 0;
+  }
+
+  void Loop()
+  {
+    T *record;
+    bool valid;
+
+    while(true)
+    {
+      pthread_mutex_lock(&fMutex);
+      while(fFreeRecords.empty() && !fStop)
+      {
+        pthread_cond_wait(&fFreeCondition, &fMutex);
+      }
+
+      if(fStop)
+      {
+        pthread_mutex_unlock(&fMutex);
+        return;
+      }
+
+      record = fFreeRecords.back();
+      fFreeRecords.pop_back();
+      pthread_mutex_unlock(&fMutex);
+
+      valid = ReadRecord(*record);
+
+      pthread_mutex_lock(&fMutex);
+      if(valid)
+      {
+        fReadyRecords.push_back(record);
+      }
+      else
+      {
+        fFreeRecords.push_back(record);
+        fEndOfInput = true;
+      }
+      pthread_cond_signal(&fReadyCondition);
+      pthread_mutex_unlock(&fMutex);
+
+      if(!valid) return;
+    }
+  }
+
+  DelphesReadAhead(const DelphesReadAhead &);
+  DelphesReadAhead &operator=(const DelphesReadAhead &);
+
+  int fDepth;
+
+  std::vector< T * > fRecords;
+
+  pthread_t fThread;
+  pthread_mutex_t fMutex;
+  pthread_cond_t fFreeCondition;
+  pthread_cond_t fReadyCondition;
+
+  bool fRunning, fStop, fEndOfInput;
+
+  // records owned by the reading thread and records waiting for NextRecord
+  std::vector< T * > fFreeRecords;
+  std::deque< T * > fReadyRecords;
+};
+
+#endif // DelphesReadAhead_h
@@ -32,6 +32,7 @@
 #include <sstream>
 
 #include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include <rpc/types.h>
 #include <rpc/xdr.h>
@@ -53,8 +54,46 @@ static const int kBufferSize  = 1000000;
 
 //---------------------------------------------------------------------------
 
+// converts arrays of big-endian XDR values in one pass,
+// gives the same results as xdr_int and xdr_double
+
+static void DecodeInts(const char *input, vector< int > &output, int size)
+{
+  u_int word;
+  int i;
+
+  output.resize(size);
+
+  for(i = 0; i < size; ++i)
+  {
+    memcpy(&word, input + 4*i, 4);
+    output[i] = ntohl(word);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+static void DecodeDoubles(const char *input, vector< double > &output, int size)
+{
+  u_int high, low;
+  ULong64_t word;
+  int i;
+
+  output.resize(size);
+
+  for(i = 0; i < size; ++i)
+  {
+    memcpy(&high, input + 8*i, 4);
+    memcpy(&low, input + 8*i + 4, 4);
+    word = (ULong64_t(ntohl(high)) << 32) | ntohl(low);
+    memcpy(&output[i], &word, 8);
+  }
+}
+
+//---------------------------------------------------------------------------
+
 DelphesSTDHEPReader::DelphesSTDHEPReader() :
-  fInputFile(0), fInputXDR(0), fBuffer(0), fPDG(0), fBlockType(-1)
+  fInputFile(0), fInputXDR(0), fBuffer(0), fPDG(0), fBlockType(-1), fCurrentEvent(0)
 {
   fInputXDR = new XDR;
   fBuffer = new char[kBufferSize*96 + 24];
@@ -66,29 +105,65 @@ DelphesSTDHEPReader::DelphesSTDHEPReader() :
 
 DelphesSTDHEPReader::~DelphesSTDHEPReader()
 {
+  Stop();
+
   if(fBuffer) delete fBuffer;
   if(fInputXDR) delete fInputXDR;
 }
 
 //---------------------------------------------------------------------------
 
+void DelphesSTDHEPReader::SetPipelineDepth(int depth)
+{
+  fCurrentEvent = 0;
+
+  SetDepth(depth);
+}
+
+//---------------------------------------------------------------------------
+
 void DelphesSTDHEPReader::SetInputFile(FILE *inputFile)
 {
+  Stop();
+
   fInputFile = inputFile;
   xdrstdio_create(fInputXDR, inputFile, XDR_DECODE);
+
+  fError.clear();
+
+  if(inputFile) StartReading();
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesSTDHEPReader::Stop()
+{
+  StopReading();
+
+  fCurrentEvent = 0;
 }
 
 //---------------------------------------------------------------------------
 
 void DelphesSTDHEPReader::Clear()
 {
-  fBlockType = -1;
+  if(!IsReading())
+  {
+    fBlockType = -1;
+  }
+  else if(fCurrentEvent)
+  {
+    ReleaseRecord(fCurrentEvent);
+    fCurrentEvent = 0;
+  }
 }
 
 //---------------------------------------------------------------------------
 
 bool DelphesSTDHEPReader::EventReady()
 {
+  if(IsReading()) return fCurrentEvent != 0;
+
   return (fBlockType == MCFIO_STDHEP) || (fBlockType == MCFIO_STDHEP4);
 }
 
@@ -99,7 +174,127 @@ bool DelphesSTDHEPReader::ReadBlock(DelphesFactory *factory,
   TObjArray *stableParticleOutputArray,
   TObjArray *partonOutputArray)
 {
-  if(feof(fInputFile)) return kFALSE;
+  TEventRecord *event;
+
+  if(IsReading())
+  {
+    // the whole next event is taken at once
+    if(fCurrentEvent)
+    {
+      ReleaseRecord(fCurrentEvent);
+      fCurrentEvent = 0;
+    }
+
+    event = NextRecord();
+    if(!event)
+    {
+      if(!fError.empty()) throw runtime_error(fError);
+      return kFALSE;
+    }
+
+    if(factory)
+    {
+      AddParticles(*event, factory, allParticleOutputArray,
+        stableParticleOutputArray, partonOutputArray);
+    }
+
+    fCurrentEvent = event;
+
+    return kTRUE;
+  }
+
+  if(!ReadNextBlock(fEvent)) return kFALSE;
+
+  if(EventReady() && factory)
+  {
+    AddParticles(fEvent, factory, allParticleOutputArray,
+      stableParticleOutputArray, partonOutputArray);
+  }
+
+  return kTRUE;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesSTDHEPReader::WriteEvent(vector< char > &buffer)
+{
+  const TEventRecord *event;
+
+  event = fCurrentEvent ? fCurrentEvent : &fEvent;
+
+  buffer.clear();
+
+  WriteValue(buffer, event->eventNumber);
+  WriteValue(buffer, event->eventSize);
+  WriteValue(buffer, event->weight);
+  WriteValue(buffer, event->alphaQED);
+  WriteValue(buffer, event->alphaQCD);
+  WriteValue(buffer, event->scaleSize);
+  WriteValue(buffer, event->scale);
+
+  WriteArray(buffer, event->status);
+  WriteArray(buffer, event->pid);
+  WriteArray(buffer, event->mothers);
+  WriteArray(buffer, event->daughters);
+  WriteArray(buffer, event->momentum);
+  WriteArray(buffer, event->position);
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesSTDHEPReader::ReadEvent(const vector< char > &buffer, DelphesFactory *factory,
+  TObjArray *allParticleOutputArray,
+  TObjArray *stableParticleOutputArray,
+  TObjArray *partonOutputArray)
+{
+  size_t position = 0;
+
+  ReadValue(buffer, position, fEvent.eventNumber);
+  ReadValue(buffer, position, fEvent.eventSize);
+  ReadValue(buffer, position, fEvent.weight);
+  ReadValue(buffer, position, fEvent.alphaQED);
+  ReadValue(buffer, position, fEvent.alphaQCD);
+  ReadValue(buffer, position, fEvent.scaleSize);
+  ReadValue(buffer, position, fEvent.scale);
+
+  ReadArray(buffer, position, fEvent.status);
+  ReadArray(buffer, position, fEvent.pid);
+  ReadArray(buffer, position, fEvent.mothers);
+  ReadArray(buffer, position, fEvent.daughters);
+  ReadArray(buffer, position, fEvent.momentum);
+  ReadArray(buffer, position, fEvent.position);
+
+  AddParticles(fEvent, factory, allParticleOutputArray,
+    stableParticleOutputArray, partonOutputArray);
+}
+
+//---------------------------------------------------------------------------
+
+bool DelphesSTDHEPReader::ReadRecord(TEventRecord &event)
+{
+  // the block type is reset after each event as by Clear
+  fBlockType = -1;
+
+  try
+  {
+    while(ReadNextBlock(event))
+    {
+      if(fBlockType == MCFIO_STDHEP || fBlockType == MCFIO_STDHEP4) return true;
+    }
+  }
+  catch(runtime_error &e)
+  {
+    fError = e.what();
+  }
+
+  return false;
+}
+
+//---------------------------------------------------------------------------
+
+bool DelphesSTDHEPReader::ReadNextBlock(TEventRecord &event)
+{
+  if(feof(fInputFile)) return false;
 
   xdr_int(fInputXDR, &fBlockType);
 
@@ -124,23 +319,19 @@ bool DelphesSTDHEPReader::ReadBlock(DelphesFactory *factory,
   }
   else if(fBlockType == MCFIO_STDHEP)
   {
-    ReadSTDHEP();
-    AnalyzeParticles(factory, allParticleOutputArray,
-      stableParticleOutputArray, partonOutputArray);
+    ReadSTDHEP(event);
   }
   else if(fBlockType == MCFIO_STDHEP4)
   {
-    ReadSTDHEP();
-    AnalyzeParticles(factory, allParticleOutputArray,
-      stableParticleOutputArray, partonOutputArray);
-    ReadSTDHEP4();
+    ReadSTDHEP(event);
+    ReadSTDHEP4(event);
   }
   else
   {
     throw runtime_error("Unsupported block type.");
   }
 
-  return kTRUE;
+  return true;
 }
 
 //---------------------------------------------------------------------------
@@ -342,7 +533,7 @@ void DelphesSTDHEPReader::ReadSTDCM1()
 
 //---------------------------------------------------------------------------
 
-void DelphesSTDHEPReader::ReadSTDHEP()
+void DelphesSTDHEPReader::ReadSTDHEP(TEventRecord &event)
 {
   u_int idhepSize, isthepSize, jmohepSize, jdahepSize, phepSize, vhepSize;
 
@@ -350,12 +541,12 @@ void DelphesSTDHEPReader::ReadSTDHEP()
   xdr_string(fInputXDR, &fBuffer, 100);
 
   // Extracting the event number
-  xdr_int(fInputXDR, &fEventNumber);
+  xdr_int(fInputXDR, &event.eventNumber);
 
   // Extracting the number of particles
-  xdr_int(fInputXDR, &fEventSize);
+  xdr_int(fInputXDR, &event.eventSize);
 
-  if(fEventSize >= kBufferSize)
+  if(event.eventSize >= kBufferSize)
   {
     throw runtime_error("too many particles in event");
   }
@@ -363,50 +554,57 @@ void DelphesSTDHEPReader::ReadSTDHEP()
   // 4*n + 4*n + 8*n + 8*n + 40*n + 32*n +
   // 4 + 4 + 4 + 4 + 4 + 4 = 96*n + 24
 
-  xdr_opaque(fInputXDR, fBuffer, 96*fEventSize + 24);
+  xdr_opaque(fInputXDR, fBuffer, 96*event.eventSize + 24);
 
   idhepSize = ntohl(*(u_int*)(fBuffer));
-  isthepSize = ntohl(*(u_int*)(fBuffer + 4*1 + 4*1*fEventSize));
-  jmohepSize = ntohl(*(u_int*)(fBuffer + 4*2 + 4*2*fEventSize));
-  jdahepSize = ntohl(*(u_int*)(fBuffer + 4*3 + 4*4*fEventSize));
-  phepSize = ntohl(*(u_int*)(fBuffer + 4*4 + 4*6*fEventSize));
-  vhepSize = ntohl(*(u_int*)(fBuffer + 4*5 + 4*16*fEventSize));
-
-  if(fEventSize < 0 ||
-     fEventSize != (int)idhepSize      || fEventSize != (int)isthepSize     ||
-     (2*fEventSize) != (int)jmohepSize || (2*fEventSize) != (int)jdahepSize ||
-     (5*fEventSize) != (int)phepSize   || (4*fEventSize) != (int)vhepSize)
+  isthepSize = ntohl(*(u_int*)(fBuffer + 4*1 + 4*1*event.eventSize));
+  jmohepSize = ntohl(*(u_int*)(fBuffer + 4*2 + 4*2*event.eventSize));
+  jdahepSize = ntohl(*(u_int*)(fBuffer + 4*3 + 4*4*event.eventSize));
+  phepSize = ntohl(*(u_int*)(fBuffer + 4*4 + 4*6*event.eventSize));
+  vhepSize = ntohl(*(u_int*)(fBuffer + 4*5 + 4*16*event.eventSize));
+
+  if(event.eventSize < 0 ||
+     event.eventSize != (int)idhepSize      || event.eventSize != (int)isthepSize     ||
+     (2*event.eventSize) != (int)jmohepSize || (2*event.eventSize) != (int)jdahepSize ||
+     (5*event.eventSize) != (int)phepSize   || (4*event.eventSize) != (int)vhepSize)
   {
     throw runtime_error("Inconsistent size of arrays. File is probably corrupted.");
   }
 
-  fWeight = 1.0;
-  fAlphaQED = 0.0;
-  fAlphaQCD = 0.0;
-  fScaleSize = 0;
-  memset(fScale, 0, 10*sizeof(double));
+  DecodeInts(fBuffer + 4*1, event.status, event.eventSize);
+  DecodeInts(fBuffer + 4*2 + 4*1*event.eventSize, event.pid, event.eventSize);
+  DecodeInts(fBuffer + 4*3 + 4*2*event.eventSize, event.mothers, 2*event.eventSize);
+  DecodeInts(fBuffer + 4*4 + 4*4*event.eventSize, event.daughters, 2*event.eventSize);
+  DecodeDoubles(fBuffer + 4*5 + 4*6*event.eventSize, event.momentum, 5*event.eventSize);
+  DecodeDoubles(fBuffer + 4*6 + 4*16*event.eventSize, event.position, 4*event.eventSize);
+
+  event.weight = 1.0;
+  event.alphaQED = 0.0;
+  event.alphaQCD = 0.0;
+  event.scaleSize = 0;
+  memset(event.scale, 0, 10*sizeof(double));
 }
 
 //---------------------------------------------------------------------------
 
-void DelphesSTDHEPReader::ReadSTDHEP4()
+void DelphesSTDHEPReader::ReadSTDHEP4(TEventRecord &event)
 {
   u_int number;
 
   // Extracting the event weight
-  xdr_double(fInputXDR, &fWeight);
+  xdr_double(fInputXDR, &event.weight);
 
   // Extracting alpha QED
-  xdr_double(fInputXDR, &fAlphaQED);
+  xdr_double(fInputXDR, &event.alphaQED);
 
   // Extracting alpha QCD
-  xdr_double(fInputXDR, &fAlphaQCD);
+  xdr_double(fInputXDR, &event.alphaQCD);
 
   // Extracting the event scale
-  xdr_u_int(fInputXDR, &fScaleSize);
-  for(number = 0; number < fScaleSize; ++number)
+  xdr_u_int(fInputXDR, &event.scaleSize);
+  for(number = 0; number < event.scaleSize; ++number)
   {
-    xdr_double(fInputXDR, &fScale[number]);
+    xdr_double(fInputXDR, &event.scale[number]);
   }
 
   SkipArray(8);
@@ -420,18 +618,21 @@ void DelphesSTDHEPReader::ReadSTDHEP4()
 void DelphesSTDHEPReader::AnalyzeEvent(ExRootTreeBranch *branch, long long eventNumber,
   TStopwatch *readStopWatch, TStopwatch *procStopWatch)
 {
+  const TEventRecord *event;
   LHEFEvent *element;
 
+  event = fCurrentEvent ? fCurrentEvent : &fEvent;
+
   element = static_cast<LHEFEvent *>(branch->NewEntry());
 
-  element->Number = fEventNumber;
+  element->Number = event->eventNumber;
 
   element->ProcessID = 0;
 
-  element->Weight = fWeight;
-  element->ScalePDF = fScale[0];
-  element->AlphaQED = fAlphaQED;
-  element->AlphaQCD = fAlphaQCD;
+  element->Weight = event->weight;
+  element->ScalePDF = event->scale[0];
+  element->AlphaQED = event->alphaQED;
+  element->AlphaQCD = event->alphaQCD;
 
   element->ReadTime = readStopWatch->RealTime();
   element->ProcTime = procStopWatch->RealTime();
@@ -439,7 +640,7 @@ void DelphesSTDHEPReader::AnalyzeEvent(ExRootTreeBranch *branch, long long event
 
 //---------------------------------------------------------------------------
 
-void DelphesSTDHEPReader::AnalyzeParticles(DelphesFactory *factory,
+void DelphesSTDHEPReader::AddParticles(const TEventRecord &event, DelphesFactory *factory,
   TObjArray *allParticleOutputArray,
   TObjArray *stableParticleOutputArray,
   TObjArray *partonOutputArray)
@@ -453,33 +654,25 @@ void DelphesSTDHEPReader::AnalyzeParticles(DelphesFactory *factory,
   double px, py, pz, e, mass;
   double x, y, z, t;
 
-  XDR bufferXDR[6];
-  xdrmem_create(&bufferXDR[0], fBuffer + 4*1, 4*fEventSize, XDR_DECODE);
-  xdrmem_create(&bufferXDR[1], fBuffer + 4*2 + 4*1*fEventSize, 4*fEventSize, XDR_DECODE);
-  xdrmem_create(&bufferXDR[2], fBuffer + 4*3 + 4*2*fEventSize, 8*fEventSize, XDR_DECODE);
-  xdrmem_create(&bufferXDR[3], fBuffer + 4*4 + 4*4*fEventSize, 8*fEventSize, XDR_DECODE);
-  xdrmem_create(&bufferXDR[4], fBuffer + 4*5 + 4*6*fEventSize, 40*fEventSize, XDR_DECODE);
-  xdrmem_create(&bufferXDR[5], fBuffer + 4*6 + 4*16*fEventSize, 32*fEventSize, XDR_DECODE);
-
-  for(number = 0; number < fEventSize; ++number)
-  {
-    xdr_int(&bufferXDR[0], &status);
-    xdr_int(&bufferXDR[1], &pid);
-    xdr_int(&bufferXDR[2], &m1);
-    xdr_int(&bufferXDR[2], &m2);
-    xdr_int(&bufferXDR[3], &d1);
-    xdr_int(&bufferXDR[3], &d2);
-
-    xdr_double(&bufferXDR[4], &px);
-    xdr_double(&bufferXDR[4], &py);
-    xdr_double(&bufferXDR[4], &pz);
-    xdr_double(&bufferXDR[4], &e);
-    xdr_double(&bufferXDR[4], &mass);
-
-    xdr_double(&bufferXDR[5], &x);
-    xdr_double(&bufferXDR[5], &y);
-    xdr_double(&bufferXDR[5], &z);
-    xdr_double(&bufferXDR[5], &t);
+  for(number = 0; number < event.eventSize; ++number)
+  {
+    status = event.status[number];
+    pid = event.pid[number];
+    m1 = event.mothers[2*number];
+    m2 = event.mothers[2*number + 1];
+    d1 = event.daughters[2*number];
+    d2 = event.daughters[2*number + 1];
+
+    px = event.momentum[5*number];
+    py = event.momentum[5*number + 1];
+    pz = event.momentum[5*number + 2];
+    e = event.momentum[5*number + 3];
+    mass = event.momentum[5*number + 4];
+
+    x = event.position[4*number];
+    y = event.position[4*number + 1];
+    z = event.position[4*number + 2];
+    t = event.position[4*number + 3];
 
     candidate = factory->NewCandidate();
 
@@ -27,17 +27,40 @@
  *
  */
 
+#include <string>
+#include <vector>
+
 #include <stdio.h>
 #include <rpc/types.h>
 #include <rpc/xdr.h>
 
+#include "classes/DelphesReadAhead.h"
+
 class TObjArray;
 class TStopwatch;
 class TDatabasePDG;
 class ExRootTreeBranch;
 class DelphesFactory;
 
-class DelphesSTDHEPReader
+// event decoded without ROOT objects, so that it can be filled in the reading thread
+struct DelphesSTDHEPRecord
+{
+  int eventNumber, eventSize;
+  double weight, alphaQCD, alphaQED;
+
+  u_int scaleSize;
+  double scale[10];
+
+  // HEPEVT arrays of the event,
+  // two entries per particle in mothers and daughters,
+  // five in momentum (px, py, pz, e, mass) and four in position (x, y, z, t)
+  std::vector< int > status, pid, mothers, daughters;
+  std::vector< double > momentum, position;
+};
+
+//---------------------------------------------------------------------------
+
+class DelphesSTDHEPReader : private DelphesReadAhead< DelphesSTDHEPRecord >
 {
 public:
   enum STDHEPBlock
@@ -55,22 +78,48 @@ public:
   DelphesSTDHEPReader();
   ~DelphesSTDHEPReader();
 
+  // number of events decoded ahead in a separate thread while the current event is processed,
+  // 0 decodes the input block by block in ReadBlock, must be set before SetInputFile
+  void SetPipelineDepth(int depth);
+
   void SetInputFile(FILE *inputFile);
 
+  // stops reading ahead, must be called before the input file is moved or closed
+  void Stop();
+
   void Clear();
   bool EventReady();
 
+  // with factory 0 the event is decoded without creating candidates,
+  // it can then be written by WriteEvent and sent to a worker process
   bool ReadBlock(DelphesFactory *factory,
     TObjArray *allParticleOutputArray,
     TObjArray *stableParticleOutputArray,
     TObjArray *partonOutputArray);
 
+  // writes the current event to buffer
+  void WriteEvent(std::vector< char > &buffer);
+
+  // reads an event written by WriteEvent and creates its candidates
+  void ReadEvent(const std::vector< char > &buffer, DelphesFactory *factory,
+    TObjArray *allParticleOutputArray,
+    TObjArray *stableParticleOutputArray,
+    TObjArray *partonOutputArray);
+
   void AnalyzeEvent(ExRootTreeBranch *branch, long long eventNumber,
     TStopwatch *readStopWatch, TStopwatch *procStopWatch);
 
 private:
 
-  void AnalyzeParticles(DelphesFactory *factory,
+  typedef DelphesSTDHEPRecord TEventRecord;
+
+  // decodes blocks up to the next event in the reading thread
+  bool ReadRecord(TEventRecord &event);
+
+  // decodes the next block into fBlockType and event, returns false at the end of the file
+  bool ReadNextBlock(TEventRecord &event);
+
+  void AddParticles(const TEventRecord &event, DelphesFactory *factory,
     TObjArray *allParticleOutputArray,
     TObjArray *stableParticleOutputArray,
     TObjArray *partonOutputArray);
@@ -82,8 +131,8 @@ private:
   void ReadEventTable();
   void ReadEventHeader();
   void ReadSTDCM1();
-  void ReadSTDHEP();
-  void ReadSTDHEP4();
+  void ReadSTDHEP(TEventRecord &event);
+  void ReadSTDHEP4(TEventRecord &event);
 
   FILE *fInputFile;
 
@@ -94,13 +143,16 @@ private:
   TDatabasePDG *fPDG;
 
   u_int fEntries;
-  int fBlockType, fEventNumber, fEventSize;
-  double fWeight, fAlphaQCD, fAlphaQED;
+  int fBlockType;
 
-  u_int fScaleSize;
-  double fScale[10];
-};
+  // event decoded block by block when the input is not read ahead
+  TEventRecord fEvent;
 
-#endif // DelphesSTDHEPReader_h
+  // event returned by the last call to ReadBlock when the input is read ahead
+  TEventRecord *fCurrentEvent;
 
+  // error thrown in the reading thread, thrown again by ReadBlock
+  std::string fError;
+};
 
+#endif // DelphesSTDHEPReader_h
@@ -33,6 +33,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <math.h>
+#include <float.h>
 
 #include <iostream>
 
@@ -46,6 +47,33 @@ bool DelphesStream::fFirstHugePos = true;
 bool DelphesStream::fFirstHugeNeg = true;
 bool DelphesStream::fFirstZero = true;
 
+// powers of ten that are exactly representable
+
+static const double kPow10[] =
+{
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#if LDBL_MANT_DIG == 64
+static const long double kPow10L[] =
+{
+  1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L, 1e11L,
+  1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L,
+  1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+};
+#endif
+
+static inline bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool IsDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
 //------------------------------------------------------------------------------
 
 DelphesStream::DelphesStream(char *buffer) :
@@ -57,6 +85,8 @@ DelphesStream::DelphesStream(char *buffer) :
 
 bool DelphesStream::ReadDbl(double &value)
 {
+  if(ReadDblFast(value)) return true;
+
   char *start = fBuffer;
   errno = 0;
   value = strtod(start, &fBuffer);
@@ -86,6 +116,8 @@ bool DelphesStream::ReadDbl(double &value)
 
 bool DelphesStream::ReadInt(int &value)
 {
+  if(ReadIntFast(value)) return true;
+
   char *start = fBuffer;
   errno = 0;
   value = strtol(start, &fBuffer, 10);
@@ -106,3 +138,123 @@ bool DelphesStream::ReadInt(int &value)
 }
 
 //------------------------------------------------------------------------------
+
+bool DelphesStream::ReadDblFast(double &value)
+{
+  char *p = fBuffer;
+  unsigned long long mantissa = 0;
+  int digits = 0, exponent = 0, exponentPart = 0;
+  bool negative = false, negativeExponent = false, found = false;
+
+  while(IsSpace(*p)) ++p;
+
+  if(*p == '-' || *p == '+') negative = (*p++ == '-');
+
+  // at most 19 significant digits fit in the mantissa
+  for(; IsDigit(*p); ++p)
+  {
+    found = true;
+    if(mantissa == 0 && *p == '0') continue;
+    if(digits == 19) return false;
+    mantissa = mantissa*10 + (*p - '0');
+    ++digits;
+  }
+
+  if(*p == '.')
+  {
+    for(++p; IsDigit(*p); ++p)
+    {
+      found = true;
+      if(mantissa == 0 && *p == '0')
+      {
+        --exponent;
+        continue;
+      }
+      if(digits == 19) return false;
+      mantissa = mantissa*10 + (*p - '0');
+      ++digits;
+      --exponent;
+    }
+  }
+
+  // hexadecimal numbers, infinities and nans are left to strtod
+  if(!found || *p == 'x' || *p == 'X') return false;
+
+  if(*p == 'e' || *p == 'E')
+  {
+    ++p;
+    if(*p == '-' || *p == '+') negativeExponent = (*p++ == '-');
+    if(!IsDigit(*p)) return false;
+    for(; IsDigit(*p); ++p)
+    {
+      if(exponentPart > 1000) return false;
+      exponentPart = exponentPart*10 + (*p - '0');
+    }
+    exponent += negativeExponent ? -exponentPart : exponentPart;
+  }
+
+  if(mantissa == 0)
+  {
+    value = negative ? -0.0 : 0.0;
+  }
+  else if(digits <= 15 && exponent >= -22 && exponent <= 22)
+  {
+    // mantissa and power of ten are exact, the result is correctly rounded
+    value = exponent < 0 ? double(mantissa)/kPow10[-exponent] : double(mantissa)*kPow10[exponent];
+    if(negative) value = -value;
+  }
+  else
+  {
+#if LDBL_MANT_DIG == 64
+    long double result, fraction;
+    unsigned long long bits;
+    int binaryExponent;
+
+    if(exponent < -27 || exponent > 27) return false;
+
+    // one rounding in extended precision, the rounding to double is correct
+    // unless the extended result is next to a midpoint between two doubles
+    result = exponent < 0 ? (long double)(mantissa)/kPow10L[-exponent] : (long double)(mantissa)*kPow10L[exponent];
+    fraction = frexpl(result, &binaryExponent);
+    bits = (unsigned long long)(ldexpl(fraction, 64)) & 0x7FF;
+    if(bits >= 0x3FF && bits <= 0x401) return false;
+
+    value = double(result);
+    if(negative) value = -value;
+#else
+    return false;
+#endif
+  }
+
+  fBuffer = p;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+
+bool DelphesStream::ReadIntFast(int &value)
+{
+  char *p = fBuffer;
+  int result = 0, digits = 0;
+  bool negative = false;
+
+  while(IsSpace(*p)) ++p;
+
+  if(*p == '-' || *p == '+') negative = (*p++ == '-');
+
+  // at most 9 digits cannot overflow, longer numbers are left to strtol
+  for(; IsDigit(*p); ++p)
+  {
+    if(digits == 9) return false;
+    result = result*10 + (*p - '0');
+    ++digits;
+  }
+
+  if(digits == 0) return false;
+
+  value = negative ? -result : result;
+  fBuffer = p;
+  return true;
+}
+
+//------------------------------------------------------------------------------
@@ -38,6 +38,11 @@ public:
 
 private:
 
+  // locale-free conversion of the common cases with the same result as strtod and strtol,
+  // return false without moving in the buffer for the other cases
+  bool ReadDblFast(double &value);
+  bool ReadIntFast(int &value);
+
   char *fBuffer;
   
   static bool fFirstLongMin;
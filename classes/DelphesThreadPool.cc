@@ -0,0 +1,165 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \class DelphesThreadPool
+ *
+ *  Runs a task over a range of items in several threads.
+ *  The range is split into one contiguous block per thread,
+ *  so tasks writing results only to per-item slots
+ *  give the same output for any number of threads.
+ *
+ */
+
+#include "classes/DelphesThreadPool.h"
+
+#include <stdexcept>
+#include <sstream>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+DelphesThreadPool::DelphesThreadPool(Int_t numberOfThreads) :
+  fNumberOfThreads(numberOfThreads < 1 ? 1 : numberOfThreads),
+  fTask(0), fSize(0), fGeneration(0), fStarted(0), fPending(0), fStop(kFALSE)
+{
+  stringstream message;
+  pthread_t thread;
+  Int_t i;
+
+  pthread_mutex_init(&fMutex, 0);
+  pthread_cond_init(&fStartCondition, 0);
+  pthread_cond_init(&fDoneCondition, 0);
+
+  // the calling thread is used as thread number 0
+  for(i = 1; i < fNumberOfThreads; ++i)
+  {
+    if(pthread_create(&thread, 0, Work, this) != 0)
+    {
+      Stop();
+      message << "can't create thread number " << i;
+      throw runtime_error(message.str());
+    }
+    fThreads.push_back(thread);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+DelphesThreadPool::~DelphesThreadPool()
+{
+  Stop();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesThreadPool::Stop()
+{
+  vector< pthread_t >::iterator itThreads;
+
+  pthread_mutex_lock(&fMutex);
+  fStop = kTRUE;
+  pthread_cond_broadcast(&fStartCondition);
+  pthread_mutex_unlock(&fMutex);
+
+  for(itThreads = fThreads.begin(); itThreads != fThreads.end(); ++itThreads)
+  {
+    pthread_join(*itThreads, 0);
+  }
+
+  pthread_cond_destroy(&fDoneCondition);
+  pthread_cond_destroy(&fStartCondition);
+  pthread_mutex_destroy(&fMutex);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesThreadPool::Run(DelphesThreadTask *task, Int_t size)
+{
+  Int_t numberOfThreads = GetNumberOfThreads();
+
+  if(numberOfThreads == 1 || size < 2)
+  {
+    task->Execute(0, size, 0);
+    return;
+  }
+
+  pthread_mutex_lock(&fMutex);
+  fTask = task;
+  fSize = size;
+  fPending = fThreads.size();
+  ++fGeneration;
+  pthread_cond_broadcast(&fStartCondition);
+  pthread_mutex_unlock(&fMutex);
+
+  if(size/numberOfThreads > 0) task->Execute(0, size/numberOfThreads, 0);
+
+  pthread_mutex_lock(&fMutex);
+  while(fPending > 0) pthread_cond_wait(&fDoneCondition, &fMutex);
+  fTask = 0;
+  pthread_mutex_unlock(&fMutex);
+}
+
+//------------------------------------------------------------------------------
+
+void *DelphesThreadPool::Work(void *pool)
+{
+  static_cast<DelphesThreadPool *>(pool)->Loop();
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesThreadPool::Loop()
+{
+  DelphesThreadTask *task;
+  Long64_t generation = 0;
+  Int_t thread, size, begin, end, numberOfThreads;
+
+  numberOfThreads = GetNumberOfThreads();
+
+  pthread_mutex_lock(&fMutex);
+  thread = ++fStarted;
+
+  while(1)
+  {
+    while(fGeneration == generation && !fStop)
+    {
+      pthread_cond_wait(&fStartCondition, &fMutex);
+    }
+
+    if(fStop) break;
+
+    generation = fGeneration;
+    task = fTask;
+    size = fSize;
+    pthread_mutex_unlock(&fMutex);
+
+    begin = Long64_t(size)*thread/numberOfThreads;
+    end = Long64_t(size)*(thread + 1)/numberOfThreads;
+    if(begin < end) task->Execute(begin, end, thread);
+
+    pthread_mutex_lock(&fMutex);
+    if(--fPending == 0) pthread_cond_signal(&fDoneCondition);
+  }
+
+  pthread_mutex_unlock(&fMutex);
+}
+
+//------------------------------------------------------------------------------
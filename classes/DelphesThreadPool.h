@@ -0,0 +1,86 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesThreadPool_h
+#define DelphesThreadPool_h
+
+/** \class DelphesThreadPool
+ *
+ *  Runs a task over a range of items in several threads.
+ *  The range is split into one contiguous block per thread,
+ *  so tasks writing results only to per-item slots
+ *  give the same output for any number of threads.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+#include <pthread.h>
+
+class DelphesThreadTask
+{
+public:
+
+  virtual ~DelphesThreadTask() {}
+
+  // process items [begin, end) in thread number thread,
+  // must not throw exceptions
+  virtual void Execute(Int_t begin, Int_t end, Int_t thread) = 0;
+};
+
+class DelphesThreadPool
+{
+public:
+
+  DelphesThreadPool(Int_t numberOfThreads = 1);
+
+  ~DelphesThreadPool();
+
+  // runs task over items [0, size) and returns when all threads are done
+  void Run(DelphesThreadTask *task, Int_t size);
+
+  Int_t GetNumberOfThreads() const { return fNumberOfThreads; }
+
+private:
+
+  static void *Work(void *pool);
+
+  void Stop();
+
+  void Loop();
+
+  Int_t fNumberOfThreads;
+
+  std::vector< pthread_t > fThreads;
+
+  pthread_mutex_t fMutex;
+  pthread_cond_t fStartCondition;
+  pthread_cond_t fDoneCondition;
+
+  DelphesThreadTask *fTask;
+  Int_t fSize;
+
+  Long64_t fGeneration;
+  Int_t fStarted;
+  Int_t fPending;
+  Bool_t fStop;
+};
+
+#endif // DelphesThreadPool_h
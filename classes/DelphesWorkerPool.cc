@@ -0,0 +1,365 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/** \class DelphesWorkerPool
+ *
+ *  Runs the event loop in several worker processes
+ *  forked after the initialization of all modules.
+ *  Memory filled during the initialization (pile-up index,
+ *  calorimeter binning, formulas) is shared between workers.
+ *  The main process reads the input and sends every N-th event record
+ *  to the same worker through a pipe, the pipe bounds the number of events
+ *  waiting for a worker. Each worker writes a partial output file.
+ *  The partial outputs are merged in the original event order.
+ *  The output doesn't depend on the number of workers
+ *  unless the random streams are disabled with RandomStreams false.
+ *
+ */
+
+#include "classes/DelphesWorkerPool.h"
+
+#include "modules/Delphes.h"
+
+#include "ExRootAnalysis/ExRootTreeWriter.h"
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TSystem.h"
+#include "TRandom3.h"
+#include "TStopwatch.h"
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+// capacity requested for each pipe, the default capacity is used if it can't be set
+static const int kPipeSize = 1 << 20;
+
+//------------------------------------------------------------------------------
+
+static Bool_t WriteAll(int fd, const char *data, size_t size)
+{
+  ssize_t count;
+
+  while(size > 0)
+  {
+    count = write(fd, data, size);
+    if(count < 0 && errno == EINTR) continue;
+    if(count <= 0) return kFALSE;
+    data += count;
+    size -= count;
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+static Bool_t ReadAll(int fd, char *data, size_t size)
+{
+  ssize_t count;
+
+  while(size > 0)
+  {
+    count = read(fd, data, size);
+    if(count < 0 && errno == EINTR) continue;
+    if(count <= 0) return kFALSE;
+    data += count;
+    size -= count;
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+DelphesWorkerPool::DelphesWorkerPool(Int_t numberOfWorkers) :
+  fNumberOfWorkers(numberOfWorkers), fWorkerIndex(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+DelphesWorkerPool::~DelphesWorkerPool()
+{
+  vector< int >::iterator itPipes;
+
+  for(itPipes = fPipes.begin(); itPipes != fPipes.end(); ++itPipes)
+  {
+    close(*itPipes);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesWorkerPool::Start(ExRootTreeWriter *treeWriter, const char *outputFileName)
+{
+  stringstream message;
+  vector< UInt_t > seeds;
+  vector< int > readEnds, writeEnds;
+  TFile *file = 0;
+  int fds[2];
+  pid_t pid;
+  Int_t i, j;
+
+  if(fNumberOfWorkers <= 1) return kFALSE;
+
+  fOutputFileName = outputFileName;
+
+  // the modules draw from per-event random streams that don't depend on the worker,
+  // with RandomStreams false they use gRandom, so each worker gets its own sequence
+  // to avoid correlated events, the output then depends on the number of workers
+  for(i = 0; i < fNumberOfWorkers; ++i)
+  {
+    seeds.push_back(gRandom->Integer(kMaxInt) + 1);
+  }
+
+  // all pipes exist before the first fork, each worker keeps only its read end
+  for(i = 0; i < fNumberOfWorkers; ++i)
+  {
+    if(pipe(fds) != 0)
+    {
+      throw runtime_error("can't create worker pipe");
+    }
+
+#if defined(F_SETPIPE_SZ)
+    fcntl(fds[1], F_SETPIPE_SZ, kPipeSize);
+#endif
+
+    readEnds.push_back(fds[0]);
+    writeEnds.push_back(fds[1]);
+  }
+
+  // a stopped worker is reported by Send and Finish
+  signal(SIGPIPE, SIG_IGN);
+
+  cout << "** Starting " << fNumberOfWorkers << " worker processes" << endl;
+
+  fflush(stdout);
+  fflush(stderr);
+
+  for(i = 0; i < fNumberOfWorkers; ++i)
+  {
+    pid = fork();
+    if(pid < 0)
+    {
+      message << "can't start worker process " << i;
+      throw runtime_error(message.str());
+    }
+    else if(pid == 0)
+    {
+      fWorkerIndex = i;
+      fWorkers.clear();
+
+      for(j = 0; j < fNumberOfWorkers; ++j)
+      {
+        close(writeEnds[j]);
+        if(j != i) close(readEnds[j]);
+      }
+
+      fPipes.assign(1, readEnds[i]);
+
+      gRandom->SetSeed(seeds[i]);
+
+      file = TFile::Open(fOutputFileName + Form(".worker%d", i), "RECREATE");
+      if(file == NULL)
+      {
+        cerr << "** ERROR: can't create output file of worker " << i << endl;
+        _exit(1);
+      }
+
+      treeWriter->SetTreeFile(file);
+
+      return kTRUE;
+    }
+
+    fWorkers.push_back(pid);
+  }
+
+  for(i = 0; i < fNumberOfWorkers; ++i)
+  {
+    close(readEnds[i]);
+  }
+
+  fPipes = writeEnds;
+
+  fWorkerIndex = -1;
+
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesWorkerPool::Send(Long64_t entry, Long64_t eventNumber, const vector< char > &buffer)
+{
+  Long64_t header[3];
+
+  header[0] = entry;
+  header[1] = eventNumber;
+  header[2] = buffer.size();
+
+  // entry N*k + i is processed by worker i
+  return WriteAll(fPipes[entry % fNumberOfWorkers], reinterpret_cast<const char *>(header), sizeof(header))
+    && (buffer.empty() || WriteAll(fPipes[entry % fNumberOfWorkers], &buffer[0], buffer.size()));
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesWorkerPool::Receive(Long64_t &entry, Long64_t &eventNumber, vector< char > &buffer)
+{
+  Long64_t header[3];
+
+  if(!ReadAll(fPipes[0], reinterpret_cast<char *>(header), sizeof(header))) return kFALSE;
+
+  entry = header[0];
+  eventNumber = header[1];
+  buffer.resize(header[2]);
+
+  return buffer.empty() || ReadAll(fPipes[0], &buffer[0], buffer.size());
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesWorkerPool::Process(Delphes *modularDelphes, Long64_t entry,
+  TStopwatch *readStopWatch, TStopwatch *procStopWatch)
+{
+  readStopWatch->Stop();
+
+  modularDelphes->SetEventNumber(entry);
+
+  procStopWatch->Start();
+  modularDelphes->ProcessTask();
+  procStopWatch->Stop();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesWorkerPool::Finish(ExRootTreeWriter *treeWriter)
+{
+  stringstream message;
+  vector< TFile * > files;
+  vector< TTree * > trees;
+  TFile *file = 0;
+  TTree *tree = 0, *workerTree = 0;
+  Long64_t entry, workerEntry, entries;
+  Bool_t failed = kFALSE;
+  int status;
+  Int_t i;
+
+  if(fNumberOfWorkers <= 1) return;
+
+  // workers see the end of their pipes once all events are sent
+  for(i = 0; i < Int_t(fPipes.size()); ++i)
+  {
+    close(fPipes[i]);
+  }
+  fPipes.clear();
+
+  if(fWorkerIndex >= 0)
+  {
+    tree = treeWriter->GetTree();
+    file = tree ? tree->GetCurrentFile() : 0;
+
+    treeWriter->Write();
+    if(file) file->Close();
+
+    fflush(stdout);
+    fflush(stderr);
+
+    _exit(0);
+  }
+
+  for(i = 0; i < fNumberOfWorkers; ++i)
+  {
+    if(waitpid(fWorkers[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+      failed = kTRUE;
+    }
+  }
+
+  if(failed)
+  {
+    throw runtime_error("worker process failed");
+  }
+
+  cout << "** Merging output of " << fNumberOfWorkers << " worker processes" << endl;
+
+  tree = treeWriter->GetTree();
+  if(!tree) return;
+
+  entries = 0;
+  for(i = 0; i < fNumberOfWorkers; ++i)
+  {
+    file = TFile::Open(fOutputFileName + Form(".worker%d", i), "READ");
+    if(file == NULL || file->IsZombie())
+    {
+      message << "can't open output file of worker " << i;
+      throw runtime_error(message.str());
+    }
+
+    workerTree = static_cast<TTree *>(file->Get(tree->GetName()));
+    if(!workerTree)
+    {
+      message << "can't find tree '" << tree->GetName() << "' in output file of worker " << i;
+      throw runtime_error(message.str());
+    }
+
+    treeWriter->Reserve(workerTree);
+
+    entries += workerTree->GetEntries();
+
+    files.push_back(file);
+    trees.push_back(workerTree);
+  }
+
+  // leaf arrays of flat branches are read directly into the buffers of the output tree,
+  // the buffers can't move once they are shared
+  for(i = 0; i < fNumberOfWorkers; ++i)
+  {
+    tree->CopyAddresses(trees[i]);
+  }
+
+  // entry N*k + i was processed by worker i
+  for(entry = 0; entry < entries; ++entry)
+  {
+    workerTree = trees[entry % fNumberOfWorkers];
+    workerEntry = entry / fNumberOfWorkers;
+    if(workerEntry >= workerTree->GetEntries()) break;
+    workerTree->GetEntry(workerEntry);
+    tree->Fill();
+  }
+
+  for(i = 0; i < fNumberOfWorkers; ++i)
+  {
+    trees[i]->ResetBranchAddresses();
+    delete files[i];
+    gSystem->Unlink(fOutputFileName + Form(".worker%d", i));
+  }
+}
+
+//------------------------------------------------------------------------------
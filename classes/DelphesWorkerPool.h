@@ -0,0 +1,119 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesWorkerPool_h
+#define DelphesWorkerPool_h
+
+/** \class DelphesWorkerPool
+ *
+ *  Runs the event loop in several worker processes
+ *  forked after the initialization of all modules.
+ *  Memory filled during the initialization (pile-up index,
+ *  calorimeter binning, formulas) is shared between workers.
+ *  The main process reads the input and sends every N-th event record
+ *  to the same worker through a pipe, the pipe bounds the number of events
+ *  waiting for a worker. Each worker writes a partial output file.
+ *  The partial outputs are merged in the original event order.
+ *  The output doesn't depend on the number of workers
+ *  unless the random streams are disabled with RandomStreams false.
+ *
+ */
+
+#include "Rtypes.h"
+#include "TString.h"
+
+#include <vector>
+
+#include <sys/types.h>
+
+class TObjArray;
+class TStopwatch;
+
+class ExRootTreeWriter;
+
+class Delphes;
+class DelphesFactory;
+
+class DelphesWorkerPool
+{
+public:
+
+  DelphesWorkerPool(Int_t numberOfWorkers = 1);
+
+  ~DelphesWorkerPool();
+
+  // returns true in worker processes, which process the events received with Receive,
+  // the main process reads the input and sends the events with Send
+  Bool_t Start(ExRootTreeWriter *treeWriter, const char *outputFileName);
+
+  // in worker processes writes the partial output and exits,
+  // in the main process waits for all workers and merges their outputs
+  void Finish(ExRootTreeWriter *treeWriter);
+
+  // true in the main process when events are processed by workers
+  Bool_t HasWorkers() const { return fNumberOfWorkers > 1 && fWorkerIndex < 0; }
+
+  Int_t GetNumberOfWorkers() const { return fNumberOfWorkers; }
+
+  // sends the current event of reader to the worker of entry, waits while its pipe is full,
+  // returns false if the worker has stopped
+  template< typename R >
+  Bool_t SendEvent(R *reader, Long64_t entry, Long64_t eventNumber)
+  {
+    reader->WriteEvent(fBuffer);
+    return Send(entry, eventNumber, fBuffer);
+  }
+
+  // waits for the next event of this worker, creates its candidates with reader
+  // and processes the modules, returns false once the main process has finished
+  template< typename R >
+  Bool_t ProcessEvent(R *reader, Delphes *modularDelphes, DelphesFactory *factory,
+    TObjArray *allParticleOutputArray, TObjArray *stableParticleOutputArray, TObjArray *partonOutputArray,
+    Long64_t &entry, Long64_t &eventNumber, TStopwatch *readStopWatch, TStopwatch *procStopWatch)
+  {
+    if(!Receive(entry, eventNumber, fBuffer)) return kFALSE;
+
+    reader->ReadEvent(fBuffer, factory, allParticleOutputArray, stableParticleOutputArray, partonOutputArray);
+
+    Process(modularDelphes, entry, readStopWatch, procStopWatch);
+
+    return kTRUE;
+  }
+
+private:
+
+  Bool_t Send(Long64_t entry, Long64_t eventNumber, const std::vector< char > &buffer);
+  Bool_t Receive(Long64_t &entry, Long64_t &eventNumber, std::vector< char > &buffer);
+
+  void Process(Delphes *modularDelphes, Long64_t entry, TStopwatch *readStopWatch, TStopwatch *procStopWatch);
+
+  Int_t fNumberOfWorkers;
+  Int_t fWorkerIndex;
+
+  TString fOutputFileName;
+
+  std::vector< pid_t > fWorkers;
+
+  // write ends of the worker pipes in the main process, read end in a worker
+  std::vector< int > fPipes;
+
+  // event record sent or received
+  std::vector< char > fBuffer;
+};
+
+#endif // DelphesWorkerPool_h
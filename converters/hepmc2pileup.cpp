@@ -35,6 +35,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesHepMCReader.h"
+#include "classes/DelphesInputStream.h"
 #include "classes/DelphesPileUpWriter.h"
 
 #include "ExRootAnalysis/ExRootTreeWriter.h"
@@ -65,6 +66,7 @@ int main(int argc, char *argv[])
   Candidate *candidate = 0;
   DelphesPileUpWriter *writer = 0;
   DelphesHepMCReader *reader = 0;
+  DelphesInputStream *input = 0;
   Int_t i;
   Long64_t length, eventCounter;
 
@@ -97,6 +99,8 @@ int main(int argc, char *argv[])
     itParticle = stableParticleOutputArray->MakeIterator();
 
     reader = new DelphesHepMCReader;
+    input = new DelphesInputStream;
+    reader->SetPipelineDepth(2);
 
     i = 2;
     do
@@ -132,6 +136,8 @@ int main(int argc, char *argv[])
         }
       }
 
+      inputFile = input->Open(inputFile);
+
       reader->SetInputFile(inputFile);
 
       ExRootProgressBar progressBar(length);
@@ -162,14 +168,17 @@ int main(int argc, char *argv[])
           factory->Clear();
           reader->Clear();
         }
-        progressBar.Update(ftello(inputFile), eventCounter);
+        progressBar.Update(input->GetPosition(), eventCounter);
       }
 
-      fseek(inputFile, 0L, SEEK_END);
-      progressBar.Update(ftello(inputFile), eventCounter, kTRUE);
+      // the reading thread may wait for input from a pipe
+      input->Interrupt();
+      reader->Stop();
+
+      progressBar.Update(length, eventCounter, kTRUE);
       progressBar.Finish();
 
-      if(inputFile != stdin) fclose(inputFile);
+      input->Close();
 
       ++i;
     }
@@ -180,6 +189,7 @@ int main(int argc, char *argv[])
     cout << "** Exiting..." << endl;
 
     delete reader;
+    delete input;
     delete factory;
     delete writer;
 
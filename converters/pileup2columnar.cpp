@@ -0,0 +1,115 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2026  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+#include <signal.h>
+
+#include "classes/DelphesPileUpReader.h"
+#include "classes/DelphesColumnarPileUpWriter.h"
+
+#include "ExRootAnalysis/ExRootProgressBar.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+
+static bool interrupted = false;
+
+void SignalHandler(int sig)
+{
+  interrupted = true;
+}
+
+//---------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  char appName[] = "pileup2columnar";
+  DelphesPileUpReader *reader = 0;
+  DelphesColumnarPileUpWriter *writer = 0;
+  DelphesPileUpEntry particles;
+  Long64_t entry, allEntries;
+  Int_t i;
+
+  if(argc != 3)
+  {
+    cout << " Usage: " << appName << " output_file" << " input_file" << endl;
+    cout << " output_file - output columnar pile-up file," << endl;
+    cout << " input_file - input binary pile-up file." << endl;
+    return 1;
+  }
+
+  signal(SIGINT, SignalHandler);
+
+  try
+  {
+    cout << "** Reading " << argv[2] << endl;
+
+    reader = new DelphesPileUpReader(argv[2]);
+    allEntries = reader->GetEntries();
+
+    cout << "** Input file contains " << allEntries << " events" << endl;
+
+    writer = new DelphesColumnarPileUpWriter(argv[1]);
+
+    if(allEntries > 0)
+    {
+      ExRootProgressBar progressBar(allEntries - 1);
+      // Loop over all events
+      for(entry = 0; entry < allEntries && !interrupted; ++entry)
+      {
+        if(!reader->ReadEntry(entry, particles))
+        {
+          cerr << "** ERROR: cannot read event " << entry << endl;
+          break;
+        }
+
+        for(i = 0; i < particles.size; ++i)
+        {
+          writer->WriteParticle(particles.pid[i],
+            particles.x[i], particles.y[i], particles.z[i], particles.t[i],
+            particles.px[i], particles.py[i], particles.pz[i], particles.e[i]);
+        }
+
+        writer->WriteEntry();
+
+        progressBar.Update(entry);
+      }
+      progressBar.Finish();
+    }
+
+    writer->WriteIndex();
+
+    cout << "** Exiting..." << endl;
+
+    delete writer;
+    delete reader;
+    return 0;
+  }
+  catch(runtime_error &e)
+  {
+    if(writer) delete writer;
+    if(reader) delete reader;
+    cerr << "** ERROR: " << e.what() << endl;
+    return 1;
+  }
+}
@@ -21,7 +21,7 @@ awk '
     print dst"[shape=box, style=rounded];";
     print src[1]"->"dst" [label="src[2]"];"
   }
-  $2~/Branch/{
+  $2~/^Branch$/{
     split($3, src, "/");
     if(src[1] == "Delphes") src[1] = "Reader";
     print "\"Branch "$4"\" [shape=box, style=\"rounded,filled\", fillcolor=lightgrey];";
@@ -234,6 +234,29 @@ CXXFLAGS += -I$(PYTHIA8)/include/Pythia8
 OPT_LIBS += -L$(PYTHIA8)/lib -lpythia8 -ldl
 endif
 
+# optional decompression of gzip, xz and zstd input files,
+# enabled when both the header and the library are found
+check_lib = $(shell printf '\043include <$(1)>\nint main() { return 0; }\n' | $(CXX) -x c++ - -l$(2) -o /dev/null > /dev/null 2>&1 && echo true)
+
+HAS_ZLIB := $(call check_lib,zlib.h,z)
+HAS_LZMA := $(call check_lib,lzma.h,lzma)
+HAS_ZSTD := $(call check_lib,zstd.h,zstd)
+
+ifeq ($(HAS_ZLIB),true)
+CXXFLAGS += -DHAS_ZLIB
+OPT_LIBS += -lz
+endif
+
+ifeq ($(HAS_LZMA),true)
+CXXFLAGS += -DHAS_LZMA
+OPT_LIBS += -llzma
+endif
+
+ifeq ($(HAS_ZSTD),true)
+CXXFLAGS += -DHAS_ZSTD
+OPT_LIBS += -lzstd
+endif
+
 DELPHES_LIBS += $(OPT_LIBS)
 DISPLAY_LIBS += $(OPT_LIBS)
 
@@ -254,6 +277,13 @@ DISTTAR = $(DISTDIR).tar.gz
 
 all:
 
+ifneq ($(PLATFORM),win32)
+# allow vectorization of the propagation kernels
+tmp/classes/DelphesPropagationBatch.$(ObjSuf): CXXFLAGS += -O3 -fno-math-errno -fno-trapping-math
+# allow vectorization of the XDR byte swapping loops
+tmp/classes/DelphesSTDHEPReader.$(ObjSuf): CXXFLAGS += -O3
+endif
+
 }
 
 executableDeps {converters/*.cpp} {examples/*.cpp}
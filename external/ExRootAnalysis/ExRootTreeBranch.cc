@@ -4,6 +4,13 @@
  *  Class handling object creation
  *  It is also used for output ROOT tree branches
  *
+ *  In flat mode the objects are not written to the tree,
+ *  every basic data member is copied to a leaf array (name_Member[name_size])
+ *  when the tree is filled.
+ *  TLorentzVector members are written as four leaf arrays
+ *  (name_Member_Px, _Py, _Pz and _E),
+ *  TObject data members, pointers and references are not written
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -12,8 +19,18 @@
 
 #include "TFile.h"
 #include "TTree.h"
+#include "TList.h"
+#include "TClass.h"
+#include "TBranch.h"
 #include "TString.h"
+#include "TBaseClass.h"
+#include "TDataType.h"
+#include "TDataMember.h"
 #include "TClonesArray.h"
+#include "TLorentzVector.h"
+
+#include <string.h>
+#include <algorithm>
 
 #include <iostream>
 #include <stdexcept>
@@ -24,7 +41,7 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 ExRootTreeBranch::ExRootTreeBranch(const char *name, TClass *cl, TTree *tree) :
-  fSize(0), fCapacity(1), fData(0)
+  fSize(0), fCapacity(1), fData(0), fFlat(kFALSE)
 {
   stringstream message;
 //  cl->IgnoreTObjectStreamer();
@@ -58,6 +75,128 @@ ExRootTreeBranch::~ExRootTreeBranch()
 
 //------------------------------------------------------------------------------
 
+void ExRootTreeBranch::SetFlat(TTree *tree, Int_t basketSize,
+  Int_t compressionAlgorithm, Int_t compressionLevel)
+{
+  TBranch *branch;
+  vector< TBranch * > branches;
+  vector< TBranch * >::iterator itBranches;
+  vector< TColumn >::iterator itColumns;
+
+  if(!fData || !tree || fFlat) return;
+
+  fFlat = kTRUE;
+
+  branch = tree->Branch(TString(GetName()) + "_size", &fSize, TString(GetName()) + "_size/I", basketSize);
+  branches.push_back(branch);
+
+  AddColumns(fData->GetClass(), 0, tree, basketSize);
+
+  // buffers are copied while the columns are added
+  for(itColumns = fColumns.begin(); itColumns != fColumns.end(); ++itColumns)
+  {
+    itColumns->branch->SetAddress(&itColumns->buffer[0]);
+    branches.push_back(itColumns->branch);
+  }
+
+  for(itBranches = branches.begin(); itBranches != branches.end(); ++itBranches)
+  {
+    if(compressionAlgorithm >= 0) (*itBranches)->SetCompressionAlgorithm(compressionAlgorithm);
+    if(compressionLevel >= 0) (*itBranches)->SetCompressionLevel(compressionLevel);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeBranch::AddColumns(TClass *cl, Int_t offset, TTree *tree, Int_t basketSize)
+{
+  static const char *components[4] = {"Px", "Py", "Pz", "E"};
+  TBaseClass *base;
+  TClass *baseClass;
+  TDataMember *member;
+  TString dimensions;
+  Int_t i, count, component;
+  Char_t type;
+
+  TIter itBases(cl->GetListOfBases());
+  while((base = static_cast<TBaseClass *>(itBases.Next())))
+  {
+    baseClass = base->GetClassPointer();
+    if(!baseClass || baseClass == TObject::Class()) continue;
+    AddColumns(baseClass, offset + base->GetDelta(), tree, basketSize);
+  }
+
+  TIter itMembers(cl->GetListOfDataMembers());
+  while((member = static_cast<TDataMember *>(itMembers.Next())))
+  {
+    if(!member->IsPersistent() || member->IsaPointer() || (member->Property() & kIsStatic)) continue;
+
+    count = 1;
+    dimensions = "";
+    for(i = 0; i < member->GetArrayDim(); ++i)
+    {
+      count *= member->GetMaxIndex(i);
+      dimensions += TString::Format("[%d]", member->GetMaxIndex(i));
+    }
+
+    if(member->IsBasic() && member->GetDataType())
+    {
+      switch(member->GetDataType()->GetType())
+      {
+        case kChar_t: type = 'B'; break;
+        case kUChar_t: type = 'b'; break;
+        case kShort_t: type = 'S'; break;
+        case kUShort_t: type = 's'; break;
+        case kInt_t: type = 'I'; break;
+        case kUInt_t: type = 'i'; break;
+        case kLong64_t: type = 'L'; break;
+        case kULong64_t: type = 'l'; break;
+        case kFloat_t: type = 'F'; break;
+        case kFloat16_t: type = 'F'; break;
+        case kDouble_t: type = 'D'; break;
+        case kDouble32_t: type = 'D'; break;
+        case kBool_t: type = 'O'; break;
+        default: type = 0;
+      }
+      if(!type) continue;
+
+      AddColumn(member->GetName(), dimensions, type, offset + member->GetOffset(),
+        member->GetDataType()->Size(), count, -1, tree, basketSize);
+    }
+    else if(TString(member->GetTypeName()) == "TLorentzVector")
+    {
+      for(component = 0; component < 4; ++component)
+      {
+        AddColumn(TString(member->GetName()) + "_" + components[component], dimensions, 'D',
+          offset + member->GetOffset(), sizeof(Double_t), count, component, tree, basketSize);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeBranch::AddColumn(const TString &member, const TString &dimensions, Char_t type,
+  Int_t offset, Int_t size, Int_t count, Int_t component, TTree *tree, Int_t basketSize)
+{
+  TColumn column;
+  TString name, leaves;
+
+  name = TString(GetName()) + "_" + member;
+  leaves = name + "[" + GetName() + "_size]" + dimensions + "/" + type;
+
+  column.offset = offset;
+  column.size = size;
+  column.count = count;
+  column.component = component;
+  column.buffer.resize(fCapacity*size*count);
+  column.branch = tree->Branch(name, &column.buffer[0], leaves, basketSize);
+
+  fColumns.push_back(column);
+}
+
+//------------------------------------------------------------------------------
+
 TObject *ExRootTreeBranch::NewEntry()
 {
   if(!fData) return 0;
@@ -89,3 +228,72 @@ void ExRootTreeBranch::Clear()
 
 //------------------------------------------------------------------------------
 
+void ExRootTreeBranch::FillColumns()
+{
+  Int_t i, j, bytes;
+  char *buffer;
+  Double_t *values;
+  TLorentzVector *momentum;
+  vector< TColumn >::iterator itColumns;
+
+  if(!fFlat) return;
+
+  Reserve(fSize);
+
+  for(itColumns = fColumns.begin(); itColumns != fColumns.end(); ++itColumns)
+  {
+    if(itColumns->component < 0)
+    {
+      bytes = itColumns->size*itColumns->count;
+      buffer = &itColumns->buffer[0];
+      for(i = 0; i < fSize; ++i)
+      {
+        memcpy(buffer + i*bytes, reinterpret_cast<char *>(fData->AddrAt(i)) + itColumns->offset, bytes);
+      }
+    }
+    else
+    {
+      values = reinterpret_cast<Double_t *>(&itColumns->buffer[0]);
+      for(i = 0; i < fSize; ++i)
+      {
+        momentum = reinterpret_cast<TLorentzVector *>(reinterpret_cast<char *>(fData->AddrAt(i)) + itColumns->offset);
+        for(j = 0; j < itColumns->count; ++j, ++momentum)
+        {
+          switch(itColumns->component)
+          {
+            case 0: *values++ = momentum->Px(); break;
+            case 1: *values++ = momentum->Py(); break;
+            case 2: *values++ = momentum->Pz(); break;
+            default: *values++ = momentum->E();
+          }
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeBranch::Reserve(Int_t size)
+{
+  size_t bytes;
+  vector< TColumn >::iterator itColumns;
+
+  for(itColumns = fColumns.begin(); itColumns != fColumns.end(); ++itColumns)
+  {
+    bytes = size_t(size)*itColumns->size*itColumns->count;
+    if(bytes <= itColumns->buffer.size()) continue;
+    itColumns->buffer.resize(max(bytes, 2*itColumns->buffer.size()));
+    itColumns->branch->SetAddress(&itColumns->buffer[0]);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+const char *ExRootTreeBranch::GetName() const
+{
+  return fData ? fData->GetName() : "";
+}
+
+//------------------------------------------------------------------------------
+
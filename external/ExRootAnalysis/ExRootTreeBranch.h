@@ -6,13 +6,21 @@
  *  Class handling object creation.
  *  It is also used for output ROOT tree branches
  *
+ *  In flat mode the objects are not written to the tree,
+ *  every basic data member is copied to a leaf array (name_Member[name_size])
+ *  when the tree is filled
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
 
 #include "Rtypes.h"
+#include "TString.h"
+
+#include <vector>
 
 class TTree;
+class TBranch;
 class TClonesArray;
 
 class ExRootTreeBranch
@@ -22,13 +30,47 @@ public:
   ExRootTreeBranch(const char *name, TClass *cl, TTree *tree = 0);
   ~ExRootTreeBranch();
 
+  // switches the branch to flat mode, negative compression settings
+  // are inherited from the output file
+  void SetFlat(TTree *tree, Int_t basketSize = 32000,
+    Int_t compressionAlgorithm = -1, Int_t compressionLevel = -1);
+
   TObject *NewEntry();
   void Clear();
 
+  // copies the data members of the objects to the leaf arrays in flat mode
+  void FillColumns();
+
+  // grows the leaf arrays to hold size objects in flat mode
+  void Reserve(Int_t size);
+
+  const char *GetName() const;
+  Bool_t IsFlat() const { return fFlat; }
+
 private:
 
+  void AddColumns(TClass *cl, Int_t offset, TTree *tree, Int_t basketSize);
+  void AddColumn(const TString &member, const TString &dimensions, Char_t type,
+    Int_t offset, Int_t size, Int_t count, Int_t component, TTree *tree, Int_t basketSize);
+
   Int_t fSize, fCapacity; //!
   TClonesArray *fData; //!
+
+  Bool_t fFlat; //!
+
+#if !defined(__CINT__) && !defined(__CLING__)
+  struct TColumn
+  {
+    // offset in the object, size of one element and number of elements per object
+    Int_t offset, size, count;
+    // component of TLorentzVector members, -1 for basic data members
+    Int_t component;
+    std::vector< char > buffer;
+    TBranch *branch;
+  }; //!
+
+  std::vector< TColumn > fColumns; //!
+#endif
 };
 
 #endif /* ExRootTreeBranch */
@@ -41,6 +41,14 @@ ExRootTreeWriter::~ExRootTreeWriter()
 
 //------------------------------------------------------------------------------
 
+void ExRootTreeWriter::SetTreeFile(TFile *file)
+{
+  fFile = file;
+  if(fTree) fTree->SetDirectory(file);
+}
+
+//------------------------------------------------------------------------------
+
 ExRootTreeBranch *ExRootTreeWriter::NewBranch(const char *name, TClass *cl)
 {
   if(!fTree) fTree = NewTree();
@@ -51,8 +59,39 @@ ExRootTreeBranch *ExRootTreeWriter::NewBranch(const char *name, TClass *cl)
 
 //------------------------------------------------------------------------------
 
+ExRootTreeBranch *ExRootTreeWriter::NewFlatBranch(const char *name, TClass *cl, Int_t basketSize,
+  Int_t compressionAlgorithm, Int_t compressionLevel)
+{
+  if(!fTree) fTree = NewTree();
+  ExRootTreeBranch *branch = new ExRootTreeBranch(name, cl);
+  branch->SetFlat(fTree, basketSize, compressionAlgorithm, compressionLevel);
+  fBranches.insert(branch);
+  return branch;
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeWriter::Reserve(TTree *tree)
+{
+  set<ExRootTreeBranch*>::iterator itBranches;
+  if(tree->GetEntries() <= 0) return;
+  for(itBranches = fBranches.begin(); itBranches != fBranches.end(); ++itBranches)
+  {
+    if(!(*itBranches)->IsFlat()) continue;
+    (*itBranches)->Reserve(Int_t(tree->GetMaximum(TString((*itBranches)->GetName()) + "_size")));
+  }
+}
+
+//------------------------------------------------------------------------------
+
 void ExRootTreeWriter::Fill()
 {
+  set<ExRootTreeBranch*>::iterator itBranches;
+  for(itBranches = fBranches.begin(); itBranches != fBranches.end(); ++itBranches)
+  {
+    (*itBranches)->FillColumns();
+  }
+
   if(fTree) fTree->Fill();
 }
 
@@ -25,11 +25,20 @@ public:
   ExRootTreeWriter(TFile *file = 0, const char *treeName = "Analysis");
   ~ExRootTreeWriter();
 
-  void SetTreeFile(TFile *file) { fFile = file; }
+  void SetTreeFile(TFile *file);
   void SetTreeName(const char *name) { fTreeName = name; }
 
+  TTree *GetTree() const { return fTree; }
+
   ExRootTreeBranch *NewBranch(const char *name, TClass *cl);
 
+  // branch written as leaf arrays, one per data member of the class
+  ExRootTreeBranch *NewFlatBranch(const char *name, TClass *cl, Int_t basketSize = 32000,
+    Int_t compressionAlgorithm = -1, Int_t compressionLevel = -1);
+
+  // grows the buffers of the flat branches to read the entries of a tree with the same branches
+  void Reserve(TTree *tree);
+
   void Clear();
   void Fill();
   void Write();
@@ -69,6 +69,15 @@ class puppiAlgoBin {
     else return false;
   };
 
+  void reset(){ // forget the results of the previous event, the particle buffers keep their capacity
+    fRMS_    = 0.;
+    fMean_   = 0.;
+    fMedian_ = 0.;
+    fPuppiParticlesPU_.clear();
+    fPuppiParticlesPV_.clear();
+    fPuppiParticlesNULL_.clear();
+  };
+
   void setPuppiParticles(const std::vector<puppiParticle> & puppiParticles){ // set the particles used by the current algorithm                                             
     fPuppiParticlesPU_.clear();
     fPuppiParticlesPV_.clear();
@@ -97,6 +106,22 @@ class puppiAlgoBin {
     }
   };
 
+  void setPositions(const int & nParticles){ // index in the three collections of each particle of the event, -1 if not there
+    fPositionPV_.assign(nParticles,-1);
+    fPositionPU_.assign(nParticles,-1);
+    fPositionNULL_.assign(nParticles,-1);
+
+    for(size_t iPart = 0; iPart < fPuppiParticlesPV_.size(); iPart++){
+      if(fPuppiParticlesPV_.at(iPart).fPosition_ < nParticles && fPositionPV_.at(fPuppiParticlesPV_.at(iPart).fPosition_) < 0) fPositionPV_.at(fPuppiParticlesPV_.at(iPart).fPosition_) = iPart;
+    }
+    for(size_t iPart = 0; iPart < fPuppiParticlesPU_.size(); iPart++){
+      if(fPuppiParticlesPU_.at(iPart).fPosition_ < nParticles && fPositionPU_.at(fPuppiParticlesPU_.at(iPart).fPosition_) < 0) fPositionPU_.at(fPuppiParticlesPU_.at(iPart).fPosition_) = iPart;
+    }
+    for(size_t iPart = 0; iPart < fPuppiParticlesNULL_.size(); iPart++){
+      if(fPuppiParticlesNULL_.at(iPart).fPosition_ < nParticles && fPositionNULL_.at(fPuppiParticlesNULL_.at(iPart).fPosition_) < 0) fPositionNULL_.at(fPuppiParticlesNULL_.at(iPart).fPosition_) = iPart;
+    }
+  };
+
   float fEtaMin_;
   float fEtaMax_;
   float fPtMin_ ;
@@ -120,6 +145,10 @@ class puppiAlgoBin {
   std::vector<puppiParticle> fPuppiParticlesPV_;
   std::vector<puppiParticle> fPuppiParticlesNULL_;
 
+  std::vector<int> fPositionPV_;
+  std::vector<int> fPositionPU_;
+  std::vector<int> fPositionNULL_;
+
 };
 
 #endif
@@ -14,15 +14,27 @@
 using namespace std;
 
 // ------------- Constructor
+puppiCleanContainer::puppiCleanContainer(std::vector<puppiAlgoBin> puppiAlgo,
+                                         float minPuppiWeight,
+                                         bool  fUseExp){
+
+    // puppi algo 
+    puppiAlgo_.clear();
+    puppiAlgo_ = puppiAlgo; 
+
+    // min puppi weight
+    fMinPuppiWeight_ = minPuppiWeight;
+
+    fNPV_    = 1 ;
+    fPVFrac_ = 0.;
+    fUseExp_ = fUseExp;
+}
+
 puppiCleanContainer::puppiCleanContainer(std::vector<RecoObj> inParticles, 
                                          std::vector<puppiAlgoBin> puppiAlgo,
                                          float minPuppiWeight,
                                          bool  fUseExp){
 
-    // take the input particles
-    fRecoParticles_.clear();
-    fRecoParticles_ = inParticles;
-
     // puppi algo 
     puppiAlgo_.clear();
     puppiAlgo_ = puppiAlgo; 
@@ -30,27 +42,47 @@ puppiCleanContainer::puppiCleanContainer(std::vector<RecoObj> inParticles,
     // min puppi weight
     fMinPuppiWeight_ = minPuppiWeight;
 
-    //Clear everything
+    fNPV_    = 1 ;
+    fPVFrac_ = 0.;
+    fUseExp_ = fUseExp;
+
+    // take the input particles
+    setParticles(inParticles);
+}
+
+// ------------- De-Constructor
+puppiCleanContainer::~puppiCleanContainer(){}
+
+// set the particles of a new event
+void puppiCleanContainer::setParticles(std::vector<RecoObj> & inParticles){
+
+    // take the input particles, the previous ones are given back to reuse their buffer
+    fRecoParticles_.swap(inParticles);
+
+    //Clear everything, the capacity is kept
     fPFParticles_.clear();
     fPFchsParticles_.clear();
     fChargedPV_.clear();
     fChargedNoPV_.clear();
     fPuppiWeights_.clear();
+    fPuppiParticles_.clear();
 
     fNPV_    = 1 ;
     fPVFrac_ = 0.;
-    fUseExp_ = fUseExp;
+
+    // the algorithms start from scratch as with a new container
+    for(size_t iPuppiAlgo = 0; iPuppiAlgo < puppiAlgo_.size(); iPuppiAlgo++) puppiAlgo_[iPuppiAlgo].reset();
 
     //Link to the RecoObjects --> loop on the input particles
     for (unsigned int i = 0; i < fRecoParticles_.size(); i++){
         fastjet::PseudoJet curPseudoJet;
         curPseudoJet.reset_PtYPhiM (fRecoParticles_[i].pt,fRecoParticles_[i].eta,fRecoParticles_[i].phi,fRecoParticles_[i].m);
         curPseudoJet.set_user_index(fRecoParticles_[i].id);  
-        // fill vector of pseudojets for internal references
+        // fill vector of pseudojets for internal references, the subsets are kept as index
         fPFParticles_.push_back(curPseudoJet);
-        if(fRecoParticles_[i].id <= 1) fPFchsParticles_.push_back(curPseudoJet);    //Remove Charged particles associated to other vertex
-        if(fRecoParticles_[i].id == 1) fChargedPV_.push_back(curPseudoJet);         //Take Charged particles associated to PV
-        if(fRecoParticles_[i].id == 2) fChargedNoPV_.push_back(curPseudoJet);
+        if(fRecoParticles_[i].id <= 1) fPFchsParticles_.push_back(i);    //Remove Charged particles associated to other vertex
+        if(fRecoParticles_[i].id == 1) fChargedPV_.push_back(i);         //Take Charged particles associated to PV
+        if(fRecoParticles_[i].id == 2) fChargedNoPV_.push_back(i);
         if(fRecoParticles_[i].id >= 0) fPVFrac_++ ;
 	if(fNPV_ < fRecoParticles_[i].vtxId) fNPV_ = fRecoParticles_[i].vtxId;
 
@@ -59,22 +91,38 @@ puppiCleanContainer::puppiCleanContainer(std::vector<RecoObj> inParticles,
     fPVFrac_ = double(fChargedPV_.size())/fPVFrac_;
 }
 
-// ------------- De-Constructor
-puppiCleanContainer::~puppiCleanContainer(){}
+// copy of a subset of the particles
+std::vector<fastjet::PseudoJet> puppiCleanContainer::subset(const std::vector<int> & indices){
+    std::vector<fastjet::PseudoJet> particles;
+    for(size_t i = 0; i < indices.size(); i++) particles.push_back(fPFParticles_[indices[i]]);
+    return particles;
+}
 
 // main function to compute puppi Event
-std::vector<fastjet::PseudoJet> puppiCleanContainer::puppiEvent(){
+const std::vector<fastjet::PseudoJet> & puppiCleanContainer::puppiEvent(){
 
     // output particles
-    std::vector<fastjet::PseudoJet> particles;
+    std::vector<fastjet::PseudoJet> & particles = fPuppiParticles_;
     particles.clear();
+    fPuppiWeights_.clear();
 
-    std::vector<int> pPupId ; 
-    std::vector<puppiParticle> partTmp ; // temp puppi particle vector; make a clone of the same particle for all the algo in which it is contained
+    std::vector<int> & pPupId = fPupId_; 
+    std::vector<puppiParticle> & partTmp = fPartTmp_; // temp puppi particle vector; make a clone of the same particle for all the algo in which it is contained
   
+    // tile the particles once for all the algorithms, tiles as large as the largest cone
+    float coneSizeAll = 0;
+    float coneSizePV  = 0;
+    for(size_t iPuppiAlgo = 0; iPuppiAlgo < puppiAlgo_.size(); iPuppiAlgo++){
+      if(puppiAlgo_.at(iPuppiAlgo).fUseCharged_) coneSizePV  = std::max(coneSizePV, puppiAlgo_.at(iPuppiAlgo).fConeSize_);
+      else                                       coneSizeAll = std::max(coneSizeAll,puppiAlgo_.at(iPuppiAlgo).fConeSize_);
+    }
+    fGridAll_.build(fPFParticles_,coneSizeAll);
+    fGridPV_.build(fPFParticles_,fChargedPV_,coneSizePV);
+    for(size_t iCache = 0; iCache < fNeighborCache_.size(); iCache++) fNeighborCache_[iCache].reset(fPFParticles_.size());
+
     // calculate puppi metric, RMS and mean value for all the algorithms
     for(size_t iPuppiAlgo = 0; iPuppiAlgo < puppiAlgo_.size(); iPuppiAlgo++){
-      getRMSAvg(iPuppiAlgo,fPFParticles_,fChargedPV_); // give all the particles in the event and the charged one
+      getRMSAvg(iPuppiAlgo); // use all the particles in the event and the charged one
     }
   
     int npart = 0;  
@@ -83,8 +131,7 @@ std::vector<fastjet::PseudoJet> puppiCleanContainer::puppiEvent(){
     for(size_t iPart = 0; iPart < fPFParticles_.size(); iPart++) {
 
       float pWeight = 1; // default weight
-      pPupId.clear();
-      pPupId = getPuppiId(fPFParticles_[iPart].pt(),fPFParticles_[iPart].eta(),puppiAlgo_); // take into account only algo eta
+      getPuppiId(fPFParticles_[iPart].pt(),fPFParticles_[iPart].eta(),puppiAlgo_,pPupId); // take into account only algo eta
 
       //////////////////////////////////////////      
       // acceptance check of the puppi algorithm
@@ -135,21 +182,17 @@ std::vector<fastjet::PseudoJet> puppiCleanContainer::puppiEvent(){
 
        int found = 0;  //  found index
        if(fabs(fPFParticles_[iPart].user_index()) <= 1 and puppiAlgo_.at(pPupId.at(iAlgo)).fUseCharged_){ // charged or neutral from PV
-	 for(size_t puppiIt = 0 ; puppiIt < puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesPV_.size(); puppiIt++){ // Loop on PV particles
-	   if(puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesPV_.at(puppiIt).fPosition_ == int(iPart)){
-	    partTmp.push_back(puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesPV_.at(puppiIt));  // take the puppi particle
-            found = 1 ;
-            break;
-	  }
-	}
+	 int puppiIt = puppiAlgo_.at(pPupId.at(iAlgo)).fPositionPV_.at(iPart); // position among PV particles
+	 if(puppiIt >= 0){
+	   partTmp.push_back(puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesPV_.at(puppiIt));  // take the puppi particle
+	   found = 1 ;
+	 }
        }
        else if ((fabs(fPFParticles_[iPart].user_index()) <= 1 and !puppiAlgo_.at(pPupId.at(iAlgo)).fUseCharged_) or fabs(fPFParticles_[iPart].user_index()) >= 2){
-	for(size_t puppiIt = 0; puppiIt < puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesPU_.size(); puppiIt++){
-          if(puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesPU_.at(puppiIt).fPosition_ == int(iPart)){
-            partTmp.push_back(puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesPU_.at(puppiIt));
-            found = 1;
-            break;
-	  }
+	int puppiIt = puppiAlgo_.at(pPupId.at(iAlgo)).fPositionPU_.at(iPart);
+	if(puppiIt >= 0){
+	  partTmp.push_back(puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesPU_.at(puppiIt));
+	  found = 1;
 	}
        }
       
@@ -158,12 +201,10 @@ std::vector<fastjet::PseudoJet> puppiCleanContainer::puppiEvent(){
       /////////////////////////////////////      
 
        if(found == 0){
-	for(size_t puppiIt = 0; puppiIt < puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesNULL_.size(); puppiIt++){
-          if(puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesNULL_.at(puppiIt).fPosition_ == int(iPart)){
-            partTmp.push_back(puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesNULL_.at(puppiIt));
-            found = 1 ;
-            break;
-	  }
+	int puppiIt = puppiAlgo_.at(pPupId.at(iAlgo)).fPositionNULL_.at(iPart);
+	if(puppiIt >= 0){
+	  partTmp.push_back(puppiAlgo_.at(pPupId.at(iAlgo)).fPuppiParticlesNULL_.at(puppiIt));
+	  found = 1 ;
 	}
        }
       }
@@ -237,9 +278,10 @@ std::vector<fastjet::PseudoJet> puppiCleanContainer::puppiEvent(){
 }
 
 // compute puppi metric, RMS and median for PU particle for each algo
-void puppiCleanContainer::getRMSAvg(const int & iPuppiAlgo, std::vector<fastjet::PseudoJet> & particlesAll, std::vector<fastjet::PseudoJet> &chargedPV) { 
+void puppiCleanContainer::getRMSAvg(const int & iPuppiAlgo) { 
 
-  std::vector<puppiParticle> puppiParticles; // puppi particles to be set for a specific algo
+  const std::vector<fastjet::PseudoJet> & particlesAll = fPFParticles_;
+  std::vector<puppiParticle> & puppiParticles = fAlgoParticles_; // puppi particles to be set for a specific algo
   puppiParticles.clear();
 
   // Loop on all the particles of the event  
@@ -251,10 +293,8 @@ void puppiCleanContainer::getRMSAvg(const int & iPuppiAlgo, std::vector<fastjet:
     // does not exsist and algorithm for this particle, store -999 as pVal
     if(pPupId == false) continue;
     // apply CHS in puppi metric computation -> use only LV hadrons to compute the metric for each particle
-    if(puppiAlgo_.at(iPuppiAlgo).fUseCharged_)  
-       pVal = goodVar(particlesAll[iPart], chargedPV,    puppiAlgo_.at(iPuppiAlgo).fMetricId_,puppiAlgo_.at(iPuppiAlgo).fConeSize_);
-    else if(!puppiAlgo_.at(iPuppiAlgo).fUseCharged_) 
-       pVal = goodVar(particlesAll[iPart], particlesAll, puppiAlgo_.at(iPuppiAlgo).fMetricId_,puppiAlgo_.at(iPuppiAlgo).fConeSize_);
+    // the metric is computed once for all the algorithms with the same collection, metric and cone size
+    pVal = getMetric(particlesAll[iPart], iPart, puppiAlgo_.at(iPuppiAlgo).fUseCharged_, puppiAlgo_.at(iPuppiAlgo).fMetricId_, puppiAlgo_.at(iPuppiAlgo).fConeSize_);
 
     // fill the value
     if(std::isnan(pVal) || std::isinf(pVal)) std::cout << "====>  Value is Nan " << pVal << " == " << particlesAll[iPart].pt() << " -- " << particlesAll[iPart].eta() << std::endl;
@@ -267,9 +307,57 @@ void puppiCleanContainer::getRMSAvg(const int & iPuppiAlgo, std::vector<fastjet:
   puppiAlgo_.at(iPuppiAlgo).setPuppiParticles(puppiParticles);
   // compute RMS, median and mean value  
   computeMedRMS(iPuppiAlgo);
+  // index the particles by position for the weighting pass, after the sorting in computeMedRMS
+  puppiAlgo_.at(iPuppiAlgo).setPositions(int(particlesAll.size()));
   
 }
 
+// metric of a particle with respect to all the particles or to the charged from PV (useCharged), cached per event
+float puppiCleanContainer::getMetric(const fastjet::PseudoJet & particle, const int & iPart, const bool & useCharged, const int & metricId, const float & coneSize) {
+
+  if(metricId == -1) return 1;
+
+  // find the neighbor lists of this collection and cone size
+  size_t iCache = 0;
+  for(; iCache < fNeighborCache_.size(); iCache++){
+    if(fNeighborCache_[iCache].fUseCharged_ == useCharged && fNeighborCache_[iCache].fConeSize_ == coneSize) break;
+  }
+  if(iCache == fNeighborCache_.size()){
+    fNeighborCache_.push_back(puppiNeighborCache(useCharged,coneSize));
+    fNeighborCache_.back().reset(fPFParticles_.size());
+  }
+  puppiNeighborCache & cache = fNeighborCache_[iCache];
+
+  // find the values of this metric
+  size_t iMetric = 0;
+  for(; iMetric < cache.fMetricId_.size(); iMetric++){
+    if(cache.fMetricId_[iMetric] == metricId) break;
+  }
+  if(iMetric == cache.fMetricId_.size()){
+    cache.fMetricId_.push_back(metricId);
+    cache.fValues_.push_back(std::vector<float>(fPFParticles_.size(),0));
+    cache.fValueDone_.push_back(std::vector<bool>(fPFParticles_.size(),false));
+  }
+  else if(cache.fValues_[iMetric].size() != fPFParticles_.size()){ // first use in this event
+    cache.fValues_[iMetric].assign(fPFParticles_.size(),0);
+    cache.fValueDone_[iMetric].assign(fPFParticles_.size(),false);
+  }
+
+  if(cache.fValueDone_[iMetric][iPart]) return cache.fValues_[iMetric][iPart];
+
+  if(!cache.fDone_[iPart]){
+    if(useCharged) fGridPV_.neighbors(particle,coneSize,cache.fNeighbors_[iPart]);
+    else           fGridAll_.neighbors(particle,coneSize,cache.fNeighbors_[iPart]);
+    cache.fDone_[iPart] = true;
+  }
+
+  // the neighbors are indices in fPFParticles_ for both collections
+  float var = var_within_R(metricId,fPFParticles_,cache.fNeighbors_[iPart],particle);
+  cache.fValues_[iMetric][iPart]    = var;
+  cache.fValueDone_[iMetric][iPart] = true;
+  return var;
+}
+
 
 float puppiCleanContainer::goodVar(const fastjet::PseudoJet & particle, const std::vector<fastjet::PseudoJet> & particleAll, const int & pPupId, const float & coneSize) {
   float lPup = 0;
@@ -311,6 +399,40 @@ float puppiCleanContainer::var_within_R(const int & pPupId, const vector<fastjet
 }
 
 
+// same as above for the particles already selected in the cone
+float puppiCleanContainer::var_within_R(const int & pPupId, const vector<fastjet::PseudoJet> & particles, const std::vector<int> & near_particles, const fastjet::PseudoJet& centre){
+
+  if(pPupId == -1) return 1;
+  float var = 0;
+
+  for(size_t iPart = 0; iPart < near_particles.size(); iPart++){
+
+    const fastjet::PseudoJet & near_particle = particles[near_particles[iPart]];
+
+    double pDEta = near_particle.eta()-centre.eta();
+    double pDPhi = fabs(near_particle.phi()-centre.phi());
+    if(pDPhi > 2.*3.14159265-pDPhi) pDPhi = 2.*3.14159265-pDPhi;
+    double pDR = sqrt(pDEta*pDEta+pDPhi*pDPhi);
+
+    if(pDR < 0.0001) continue;
+    if(pDR == 0)    continue;
+
+    if(pPupId == 0) var += (near_particle.pt()/(pDR*pDR));
+    if(pPupId == 1) var += near_particle.pt();
+    if(pPupId == 2) var += (1./pDR)*(1./pDR);
+    if(pPupId == 3) var += (1./pDR)*(1./pDR);
+    if(pPupId == 4) var += near_particle.pt();
+    if(pPupId == 5) var += (near_particle.pt()/pDR)*(near_particle.pt()/pDR);
+  }
+
+  if(pPupId == 0 && var != 0) var = log(var);
+  if(pPupId == 3 && var != 0) var = log(var);
+  if(pPupId == 5 && var != 0) var = log(var);
+  return var;
+
+}
+
+
 float puppiCleanContainer::pt_within_R(const std::vector<fastjet::PseudoJet> & particles, const fastjet::PseudoJet & centre, const float & R){
 
   fastjet::Selector sel = fastjet::SelectorCircle(R);
@@ -399,12 +521,18 @@ float puppiCleanContainer::getNeutralPtCut(const float & fNeutralMinE, const flo
 // take the type of algorithm : return a vector since more than one algo can be defined for the same eta region
 std::vector<int> puppiCleanContainer::getPuppiId(const float & pt, const float & eta, const std::vector<puppiAlgoBin> & puppiAlgos){
   std::vector<int> PuppiId ;
+  getPuppiId(pt,eta,puppiAlgos,PuppiId);
+  return PuppiId;  
+}
+
+// same as above filling an existing vector
+void puppiCleanContainer::getPuppiId(const float & pt, const float & eta, const std::vector<puppiAlgoBin> & puppiAlgos, std::vector<int> & PuppiId){
+  PuppiId.clear();
   for(size_t iPuppiAlgo = 0; iPuppiAlgo < puppiAlgos.size() ; iPuppiAlgo++){
     if(fabs(eta) <= puppiAlgos[iPuppiAlgo].fEtaMin_) continue;
     if(fabs(eta) > puppiAlgos[iPuppiAlgo].fEtaMax_) continue;
     PuppiId.push_back(int(iPuppiAlgo));
   }
-  return PuppiId;  
 }
 
 //check if a particle is good for an Algo definition
@@ -5,6 +5,7 @@
 #include "PUPPI/RecoObj.hh"
 #include "PUPPI/puppiParticle.hh"
 #include "PUPPI/puppiAlgoBin.hh"
+#include "PUPPI/puppiNeighborGrid.hh"
 
 #include "fastjet/internal/base.hh"
 #include "fastjet/PseudoJet.hh"
@@ -18,6 +19,12 @@ class puppiCleanContainer{
 
  public:
 
+  // reusable constructor which takes only the algorithm definition, the particles are given for each event with setParticles
+  puppiCleanContainer(std::vector<puppiAlgoBin> puppiAlgo, // vector with the definition of the puppi algorithm in different eta region (one for each eta) 
+                      float minPuppiWeight  = 0.01,        // min puppi weight cut
+                      bool  useExp = false                 // useDz vertex probability
+  ); 
+
   // basic constructor which takes input particles as RecoObj, the tracker eta extension and other two boolean info
   puppiCleanContainer(std::vector<RecoObj> inParticles,    // incoming particles of the event
                       std::vector<puppiAlgoBin> puppiAlgo, // vector with the definition of the puppi algorithm in different eta region (one for each eta) 
@@ -27,56 +34,74 @@ class puppiCleanContainer{
 
   ~puppiCleanContainer(); 
 
+  // set the particles of a new event: the content of inParticles is swapped with the particles of the previous event,
+  // all the buffers keep their capacity from one event to the next
+  void setParticles(std::vector<RecoObj> & inParticles);
+
   // ----- get methods
 
+  // get the input particles
+  const std::vector<RecoObj> & recoParticles() { return fRecoParticles_; }
   // get all the PF particles
-  std::vector<fastjet::PseudoJet> pfParticles()  { return  fPFParticles_; }    
+  const std::vector<fastjet::PseudoJet> & pfParticles()  { return  fPFParticles_; }    
   // get all the PF charged from PV
-  std::vector<fastjet::PseudoJet> pvParticles()  { return  fChargedPV_; }        
+  std::vector<fastjet::PseudoJet> pvParticles()  { return  subset(fChargedPV_); }        
   // get all the PF charged from PU
-  std::vector<fastjet::PseudoJet> puParticles()  { return  fChargedNoPV_; }    
+  std::vector<fastjet::PseudoJet> puParticles()  { return  subset(fChargedNoPV_); }    
   // get CHS particle collection
-  std::vector<fastjet::PseudoJet> pfchsParticles(){ return fPFchsParticles_; }    
+  std::vector<fastjet::PseudoJet> pfchsParticles(){ return subset(fPFchsParticles_); }    
   // get puppi weight for all particles 
-  std::vector<float> getPuppiWeights() { return fPuppiWeights_; };
+  const std::vector<float> & getPuppiWeights() { return fPuppiWeights_; };
 
-  // process puppi
-  std::vector<fastjet::PseudoJet> puppiEvent();
+  // process puppi, the output particles are kept until the next event
+  const std::vector<fastjet::PseudoJet> & puppiEvent();
  
  protected:
 
-   void    getRMSAvg(const int &, std::vector<fastjet::PseudoJet> &, std::vector<fastjet::PseudoJet> &);        
+   void    getRMSAvg(const int &);        
    float   goodVar  (const fastjet::PseudoJet &, const std::vector<fastjet::PseudoJet> &, const int &, const float &);    
+   float   getMetric(const fastjet::PseudoJet &, const int &, const bool &, const int &, const float &);
    void    computeMedRMS(const int &);  
    float   compute(const float &, const std::vector<puppiParticle> &, const std::vector<puppiAlgoBin> &, const std::vector<int> &);
 
    // some get functions
    float getNeutralPtCut(const float&, const float&, const int&);
    std::vector<int> getPuppiId(const float &, const float &, const std::vector<puppiAlgoBin> &);
+   void  getPuppiId(const float &, const float &, const std::vector<puppiAlgoBin> &, std::vector<int> &);
    bool  isGoodPuppiId(const float &, const float &, const puppiAlgoBin &);
    float getChi2FromdZ(float);
    // other functions
    float  var_within_R(const int &, const vector<fastjet::PseudoJet> &, const fastjet::PseudoJet &, const float &);
+   float  var_within_R(const int &, const vector<fastjet::PseudoJet> &, const std::vector<int> &, const fastjet::PseudoJet &);
    float  pt_within_R(const std::vector<fastjet::PseudoJet> &, const fastjet::PseudoJet &, const float &);
    fastjet::PseudoJet flow_within_R(const vector<fastjet::PseudoJet> &, const fastjet::PseudoJet &, const float &);
-   
+   std::vector<fastjet::PseudoJet> subset(const std::vector<int> &);
   
  private:    
  
   std::vector<RecoObj>            fRecoParticles_;
   std::vector<fastjet::PseudoJet> fPFParticles_;
-  std::vector<fastjet::PseudoJet> fPFchsParticles_;    
-  std::vector<fastjet::PseudoJet> fChargedPV_;
-  std::vector<fastjet::PseudoJet> fChargedNoPV_;
+  std::vector<int>                fPFchsParticles_; // index of the particles in fPFParticles_
+  std::vector<int>                fChargedPV_;
+  std::vector<int>                fChargedNoPV_;
 
   std::vector<puppiAlgoBin> puppiAlgo_;
   std::vector<float> fPuppiWeights_;
+  std::vector<fastjet::PseudoJet> fPuppiParticles_; // output particles
+
+  std::vector<int>           fPupId_;   // buffers reused for each particle
+  std::vector<puppiParticle> fPartTmp_;
+  std::vector<puppiParticle> fAlgoParticles_;
 
   float  fMinPuppiWeight_;
   float  fPVFrac_;
 
   int    fNPV_;  
   bool   fUseExp_ ;
+
+  puppiNeighborGrid fGridAll_;  // tiles over all the particles
+  puppiNeighborGrid fGridPV_;   // tiles over the charged particles from PV
+  std::vector<puppiNeighborCache> fNeighborCache_; // neighbor lists and metric values shared between the algorithms
     
 };
 
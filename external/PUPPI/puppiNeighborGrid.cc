@@ -0,0 +1,144 @@
+#include "puppiNeighborGrid.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+  // particles outside of this rapidity range go to the first or last tile
+  const double kMaxGridRap  = 10.;
+  // limits the number of tiles in rapidity for very forward particles
+  const int    kMaxRapTiles = 1000;
+  // tiles visited by a query are widened by this relative amount to be safe against rounding
+  const double kTileMargin  = 1e-6;
+}
+
+// ------------- Constructor
+puppiNeighborGrid::puppiNeighborGrid(){
+  fParticles_ = 0;
+  fNRap_      = 1;
+  fNPhi_      = 1;
+  fRapMin_    = 0.;
+  fRapWidth_  = 1.;
+  fPhiWidth_  = 2.*M_PI;
+}
+
+// sort all the particles in tiles
+void puppiNeighborGrid::build(const std::vector<fastjet::PseudoJet> & particles, const float & tileSize){
+  fIndex_.resize(particles.size());
+  for(size_t iPart = 0; iPart < particles.size(); iPart++) fIndex_[iPart] = int(iPart);
+  fill(particles,tileSize);
+}
+
+// sort a subset of the particles in tiles, the indices must be in increasing order
+void puppiNeighborGrid::build(const std::vector<fastjet::PseudoJet> & particles, const std::vector<int> & subset, const float & tileSize){
+  fIndex_.assign(subset.begin(),subset.end());
+  fill(particles,tileSize);
+}
+
+// fill the tiles with the particles of fIndex_, the buffers keep their capacity between events
+void puppiNeighborGrid::fill(const std::vector<fastjet::PseudoJet> & particles, const float & tileSize){
+
+  fParticles_ = &particles;
+
+  int nParticles = int(fIndex_.size());
+  double size = tileSize > 0 ? tileSize : 1.;
+
+  fRap_.resize(nParticles);
+  fPhi_.resize(nParticles);
+
+  double rapMax = 0.;
+  fRapMin_ = 0.;
+  for(int iPart = 0; iPart < nParticles; iPart++){
+    fRap_[iPart] = particles[fIndex_[iPart]].rap();
+    fPhi_[iPart] = particles[fIndex_[iPart]].phi();
+    double rap = max(-kMaxGridRap, min(kMaxGridRap, fRap_[iPart]));
+    if(iPart == 0 || rap < fRapMin_) fRapMin_ = rap;
+    if(iPart == 0 || rap > rapMax)   rapMax   = rap;
+  }
+
+  fNRap_     = max(1, int(min((rapMax-fRapMin_)/size, double(kMaxRapTiles))));
+  fRapWidth_ = max((rapMax-fRapMin_)/fNRap_, size);
+  fNPhi_     = max(1, int(2.*M_PI/size));
+  fPhiWidth_ = 2.*M_PI/fNPhi_;
+
+  // counting sort of the particles by tile, keeps the order of the particle vector in each tile
+  int nTiles = fNRap_*fNPhi_;
+  fParticleTiles_.resize(nParticles);
+  fTileStart_.assign(nTiles+1,0);
+  fTileEntries_.resize(nParticles);
+
+  for(int iPart = 0; iPart < nParticles; iPart++){
+    fParticleTiles_[iPart] = rapTile(fRap_[iPart])*fNPhi_ + phiTile(fPhi_[iPart]);
+    fTileStart_[fParticleTiles_[iPart]+1]++;
+  }
+  for(int iTile = 0; iTile < nTiles; iTile++) fTileStart_[iTile+1] += fTileStart_[iTile];
+  for(int iPart = 0; iPart < nParticles; iPart++) fTileEntries_[fTileStart_[fParticleTiles_[iPart]]++] = iPart;
+  for(int iTile = nTiles; iTile > 0; iTile--) fTileStart_[iTile] = fTileStart_[iTile-1];
+  fTileStart_[0] = 0;
+}
+
+int puppiNeighborGrid::rapTile(const double & rap) const {
+  double tile = (rap-fRapMin_)/fRapWidth_;
+  if(!(tile > 0)) return 0;
+  if(tile >= fNRap_) return fNRap_-1;
+  return int(tile);
+}
+
+int puppiNeighborGrid::phiTile(const double & phi) const {
+  int tile = int(floor(phi/fPhiWidth_));
+  if(tile < 0) return 0;
+  if(tile >= fNPhi_) return fNPhi_-1;
+  return tile;
+}
+
+// find the particles within the cone, same condition as fastjet::SelectorCircle
+void puppiNeighborGrid::neighbors(const fastjet::PseudoJet & centre, const float & R, std::vector<int> & result) const {
+
+  if(!fParticles_ || fIndex_.empty()) return;
+
+  size_t first = result.size();
+  double radius  = R;
+  double radius2 = radius*radius;
+  double margin  = radius*(1.+kTileMargin)+kTileMargin;
+  double rap = centre.rap();
+  double phi = centre.phi();
+
+  int rapFirst = rapTile(rap-margin);
+  int rapLast  = rapTile(rap+margin);
+  int phiFirst = 0;
+  int phiLast  = fNPhi_-1;
+  if(2.*margin+fPhiWidth_ < 2.*M_PI){ // visit every phi tile only once
+    phiFirst = int(floor((phi-margin)/fPhiWidth_));
+    phiLast  = int(floor((phi+margin)/fPhiWidth_));
+  }
+
+  for(int iRap = rapFirst; iRap <= rapLast; iRap++){
+    for(int iPhi = phiFirst; iPhi <= phiLast; iPhi++){
+      int tile = iRap*fNPhi_ + (iPhi%fNPhi_+fNPhi_)%fNPhi_;
+      for(int iEntry = fTileStart_[tile]; iEntry < fTileStart_[tile+1]; iEntry++){
+        int iPart = fTileEntries_[iEntry];
+        // same as PseudoJet::plain_distance
+        double dphi = fabs(fPhi_[iPart]-phi);
+        if(dphi > M_PI) dphi = 2.*M_PI-dphi;
+        double drap = fRap_[iPart]-rap;
+        if(dphi*dphi+drap*drap <= radius2) result.push_back(fIndex_[iPart]);
+      }
+    }
+  }
+
+  std::sort(result.begin()+first,result.end());
+}
+
+// prepare the cache for a new event, the neighbor lists keep their capacity
+void puppiNeighborCache::reset(const int & nParticles){
+  if(int(fNeighbors_.size()) < nParticles) fNeighbors_.resize(nParticles);
+  for(int iPart = 0; iPart < nParticles; iPart++) fNeighbors_[iPart].clear();
+  fDone_.assign(nParticles,false);
+  // the metric values are resized at their first use in the event
+  for(size_t iMetric = 0; iMetric < fValues_.size(); iMetric++){
+    fValues_[iMetric].clear();
+    fValueDone_[iMetric].clear();
+  }
+}
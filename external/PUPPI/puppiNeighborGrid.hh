@@ -0,0 +1,79 @@
+#ifndef PUPPINEIGHBORGRID_HH
+#define PUPPINEIGHBORGRID_HH
+
+#include "fastjet/PseudoJet.hh"
+
+#include <vector>
+
+//...................... rapidity-phi tiles over the particles of an event, used to find the particles within a cone
+//...................... with the same condition as fastjet::SelectorCircle without looping on all the particles
+class puppiNeighborGrid {
+
+ public:
+
+  puppiNeighborGrid();
+
+  ~puppiNeighborGrid(){};
+
+  // sort the particles in tiles of at least tileSize in rapidity and phi, the vector must stay unchanged while the grid is used
+  void build(const std::vector<fastjet::PseudoJet> & particles, const float & tileSize);
+
+  // same for a subset of the particles given by increasing indices, neighbors are still indices in the particle vector
+  void build(const std::vector<fastjet::PseudoJet> & particles, const std::vector<int> & subset, const float & tileSize);
+
+  // append the index of all the particles with squared distance to the centre <= R*R, in the order of the particle vector
+  void neighbors(const fastjet::PseudoJet & centre, const float & R, std::vector<int> & result) const;
+
+ private:
+
+  void fill(const std::vector<fastjet::PseudoJet> & particles, const float & tileSize);
+
+  int rapTile(const double & rap) const;
+  int phiTile(const double & phi) const;
+
+  const std::vector<fastjet::PseudoJet> * fParticles_;
+
+  int    fNRap_;
+  int    fNPhi_;
+  double fRapMin_;
+  double fRapWidth_;
+  double fPhiWidth_;
+
+  std::vector<int>    fIndex_;   // index in the particle vector of the tiled particles
+  std::vector<double> fRap_;     // rapidity and phi of the particles, computed once
+  std::vector<double> fPhi_;
+  std::vector<int>    fTileStart_; // particles of tile i are fTileEntries_[fTileStart_[i]] ... fTileEntries_[fTileStart_[i+1]-1]
+  std::vector<int>    fTileEntries_;
+  std::vector<int>    fParticleTiles_;
+
+};
+
+//...................... per-particle neighbor lists and metric values for one reference collection and cone size,
+//...................... shared by all the algorithms with the same collection and cone size
+class puppiNeighborCache {
+
+ public:
+
+  puppiNeighborCache(const bool & useCharged, const float & coneSize):
+    fUseCharged_(useCharged),
+    fConeSize_(coneSize)
+  {};
+
+  ~puppiNeighborCache(){};
+
+  // start a new event with nParticles particles
+  void reset(const int & nParticles);
+
+  bool  fUseCharged_;
+  float fConeSize_;
+
+  std::vector<std::vector<int> > fNeighbors_; // index of the neighbors in the particle vector
+  std::vector<bool> fDone_;
+
+  std::vector<int> fMetricId_;                // metric values already computed for this collection and cone size
+  std::vector<std::vector<float> > fValues_;
+  std::vector<std::vector<bool> > fValueDone_;
+
+};
+
+#endif
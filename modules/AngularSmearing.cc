@@ -113,8 +113,8 @@ void AngularSmearing::Process()
 
     // apply smearing formula for eta,phi
 
-    eta = gRandom->Gaus(eta, fFormulaEta->Eval(pt, eta, phi, e));
-    phi = gRandom->Gaus(phi, fFormulaPhi->Eval(pt, eta, phi, e));
+    eta = GetRandom()->Gaus(eta, fFormulaEta->Eval(pt, eta, phi, e));
+    phi = GetRandom()->Gaus(phi, fFormulaPhi->Eval(pt, eta, phi, e));
     
     if(pt <= 0.0) continue;
 
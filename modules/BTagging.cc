@@ -23,6 +23,10 @@
  *  applies b-tagging efficiency (miss identification rate) formulas
  *  and sets b-tagging flags
  *
+ *  Additional working points (WorkingPoints, list of bit numbers
+ *  and lists of efficiency formulas) are evaluated in the same pass
+ *  and share the random numbers, so the tags of nested working points are nested.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -32,6 +36,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEfficiencyMap.h"
 
 #include "TMath.h"
 #include "TString.h"
@@ -65,34 +70,27 @@ BTagging::~BTagging()
 
 void BTagging::Init()
 {
-  map< Int_t, DelphesFormula * >::iterator itEfficiencyMap;
   ExRootConfParam param;
-  DelphesFormula *formula;
+  WorkingPoint workingPoint;
   Int_t i, size;
 
   fBitNumber = GetInt("BitNumber", 0);
 
   // read efficiency formulas
-  param = GetParam("EfficiencyFormula");
+  workingPoint.bit = fBitNumber;
+  workingPoint.efficiency = NewEfficiencyMap(GetParam("EfficiencyFormula"));
+  fWorkingPoints.push_back(workingPoint);
+
+  // read efficiency formulas of additional working points,
+  // list of bit numbers and lists of flavors and formulas
+  param = GetParam("WorkingPoints");
   size = param.GetSize();
 
-  fEfficiencyMap.clear();
   for(i = 0; i < size/2; ++i)
   {
-    formula = new DelphesFormula;
-    formula->Compile(param[i*2 + 1].GetString());
-
-    fEfficiencyMap[param[i*2].GetInt()] = formula;
-  }
-
-  // set default efficiency formula
-  itEfficiencyMap = fEfficiencyMap.find(0);
-  if(itEfficiencyMap == fEfficiencyMap.end())
-  {
-    formula = new DelphesFormula;
-    formula->Compile("0.0");
-
-    fEfficiencyMap[0] = formula;
+    workingPoint.bit = param[i*2].GetInt();
+    workingPoint.efficiency = NewEfficiencyMap(param[i*2 + 1]);
+    fWorkingPoints.push_back(workingPoint);
   }
 
   // import input array(s)
@@ -105,16 +103,15 @@ void BTagging::Init()
 
 void BTagging::Finish()
 {
-  map< Int_t, DelphesFormula * >::iterator itEfficiencyMap;
-  DelphesFormula *formula;
+  vector< WorkingPoint >::iterator itWorkingPoints;
 
   if(fItJetInputArray) delete fItJetInputArray;
 
-  for(itEfficiencyMap = fEfficiencyMap.begin(); itEfficiencyMap != fEfficiencyMap.end(); ++itEfficiencyMap)
+  for(itWorkingPoints = fWorkingPoints.begin(); itWorkingPoints != fWorkingPoints.end(); ++itWorkingPoints)
   {
-    formula = itEfficiencyMap->second;
-    if(formula) delete formula;
+    if(itWorkingPoints->efficiency) delete itWorkingPoints->efficiency;
   }
+  fWorkingPoints.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -122,52 +119,64 @@ void BTagging::Finish()
 void BTagging::Process()
 {
   Candidate *jet;
-  Double_t pt, eta, phi, e;
-  map< Int_t, DelphesFormula * >::iterator itEfficiencyMap;
-  DelphesFormula *formula;
+  vector< WorkingPoint >::iterator itWorkingPoints;
+  Int_t i, n, bit;
 
-  // loop over all input jets
+  // collect kinematics and flavors of all input jets
+  fJets.clear();
   fItJetInputArray->Reset();
   while((jet = static_cast<Candidate*>(fItJetInputArray->Next())))
   {
+    fJets.push_back(jet);
+  }
+
+  n = fJets.size();
+  if(n == 0) return;
+
+  fFlavors.resize(3*n);
+  fPT.resize(3*n);
+  fEta.resize(3*n);
+  fPhi.resize(3*n);
+  fE.resize(3*n);
+  fRandoms.resize(3*n);
+  fEfficiencies.resize(3*n);
+
+  for(i = 0; i < n; ++i)
+  {
+    jet = fJets[i];
     const TLorentzVector &jetMomentum = jet->Momentum;
-    eta = jetMomentum.Eta();
-    phi = jetMomentum.Phi();
-    pt = jetMomentum.Pt();
-    e = jetMomentum.E();
-
-    // find an efficiency formula
-    itEfficiencyMap = fEfficiencyMap.find(jet->Flavor);
-    if(itEfficiencyMap == fEfficiencyMap.end())
-    {
-      itEfficiencyMap = fEfficiencyMap.find(0);
-    }
-    formula = itEfficiencyMap->second;
 
-    // apply an efficiency formula
-    jet->BTag |= (gRandom->Uniform() <= formula->Eval(pt, eta, phi, e)) << fBitNumber;
+    fFlavors[i] = jet->Flavor;
+    fFlavors[n + i] = jet->FlavorAlgo;
+    fFlavors[2*n + i] = jet->FlavorPhys;
 
-    // find an efficiency formula for algo flavor definition
-    itEfficiencyMap = fEfficiencyMap.find(jet->FlavorAlgo);
-    if(itEfficiencyMap == fEfficiencyMap.end())
-    {
-      itEfficiencyMap = fEfficiencyMap.find(0);
-    }
-    formula = itEfficiencyMap->second;
+    fEta[i] = fEta[n + i] = fEta[2*n + i] = jetMomentum.Eta();
+    fPhi[i] = fPhi[n + i] = fPhi[2*n + i] = jetMomentum.Phi();
+    fPT[i] = fPT[n + i] = fPT[2*n + i] = jetMomentum.Pt();
+    fE[i] = fE[n + i] = fE[2*n + i] = jetMomentum.E();
 
-    // apply an efficiency formula
-    jet->BTagAlgo |= (gRandom->Uniform() <= formula->Eval(pt, eta, phi, e)) << fBitNumber;
+    // one random number per jet and flavor definition, shared by all working points,
+    // so that every jet tagged at a tighter working point is also tagged at a looser one
+    fRandoms[i] = GetRandom()->Uniform();
+    fRandoms[n + i] = GetRandom()->Uniform();
+    fRandoms[2*n + i] = GetRandom()->Uniform();
+  }
+
+  for(itWorkingPoints = fWorkingPoints.begin(); itWorkingPoints != fWorkingPoints.end(); ++itWorkingPoints)
+  {
+    // evaluate the efficiencies of all jets and flavor definitions
+    itWorkingPoints->efficiency->EvalN(&fFlavors[0], &fPT[0], &fEta[0], &fPhi[0], &fE[0], &fEfficiencies[0], 3*n);
 
-    // find an efficiency formula for phys flavor definition
-    itEfficiencyMap = fEfficiencyMap.find(jet->FlavorPhys);
-    if(itEfficiencyMap == fEfficiencyMap.end())
+    bit = itWorkingPoints->bit;
+
+    // apply efficiencies
+    for(i = 0; i < n; ++i)
     {
-      itEfficiencyMap = fEfficiencyMap.find(0);
+      jet = fJets[i];
+      jet->BTag |= (fRandoms[i] <= fEfficiencies[i]) << bit;
+      jet->BTagAlgo |= (fRandoms[n + i] <= fEfficiencies[n + i]) << bit;
+      jet->BTagPhys |= (fRandoms[2*n + i] <= fEfficiencies[2*n + i]) << bit;
     }
-    formula = itEfficiencyMap->second;
-
-    // apply an efficiency formula
-    jet->BTagPhys |= (gRandom->Uniform() <= formula->Eval(pt, eta, phi, e)) << fBitNumber;
   }
 }
 
@@ -25,16 +25,21 @@
  *  applies b-tagging efficiency (miss identification rate) formulas
  *  and sets b-tagging flags 
  *
+ *  Additional working points (WorkingPoints, list of bit numbers
+ *  and lists of efficiency formulas) are evaluated in the same pass
+ *  and share the random numbers, so the tags of nested working points are nested.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
 
 #include "classes/DelphesModule.h"
 
-#include <map>
+#include <vector>
 
 class TObjArray;
-class DelphesFormula;
+class Candidate;
+class DelphesEfficiencyMap;
 
 class BTagging: public DelphesModule
 {
@@ -51,9 +56,21 @@ private:
 
   Int_t fBitNumber;
 
-#if !defined(__CINT__) && !defined(__CLING__)
-  std::map< Int_t, DelphesFormula * > fEfficiencyMap; //!
-#endif
+  struct WorkingPoint
+  {
+    Int_t bit;
+    DelphesEfficiencyMap *efficiency;
+  };
+
+  // the working points share the random numbers
+  std::vector< WorkingPoint > fWorkingPoints; //!
+
+  std::vector< Candidate * > fJets; //!
+
+  // three blocks of jets: flavor, algorithmic flavor and physics flavor
+  std::vector< Int_t > fFlavors; //!
+  std::vector< Double_t > fPT, fEta, fPhi, fE; //!
+  std::vector< Double_t > fRandoms, fEfficiencies; //!
 
   TIterator *fItJetInputArray; //!
   
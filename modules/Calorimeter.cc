@@ -31,6 +31,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesCaloBinning.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -51,14 +52,20 @@
 
 using namespace std;
 
+// energy fractions of particles with smaller PDG codes are stored in a dense table
+static const Int_t kFractionTableSize = 10000;
+
 //------------------------------------------------------------------------------
 
 Calorimeter::Calorimeter() :
+  fBinning(0),
   fECalResolutionFormula(0), fHCalResolutionFormula(0),
   fItParticleInputArray(0), fItTrackInputArray(0)
 {
   Int_t i;
 
+  fBinning = new DelphesCaloBinning;
+
   fECalResolutionFormula = new DelphesFormula;
   fHCalResolutionFormula = new DelphesFormula;
 
@@ -78,6 +85,8 @@ Calorimeter::~Calorimeter()
 {
   Int_t i;
 
+  if(fBinning) delete fBinning;
+
   if(fECalResolutionFormula) delete fECalResolutionFormula;
   if(fHCalResolutionFormula) delete fHCalResolutionFormula;
 
@@ -101,6 +110,7 @@ void Calorimeter::Init()
   TBinMap::iterator itEtaBin;
   set< Double_t >::iterator itPhiBin;
   vector< Double_t > *phiBins;
+  TFractionMap::iterator itFractionMap;
 
   // read eta and phi bins
   param = GetParam("EtaPhiBins");
@@ -138,6 +148,8 @@ void Calorimeter::Init()
     }
   }
 
+  fBinning->Build(fEtaBins, fPhiBins);
+
   // read energy fractions for different particles
   param = GetParam("EnergyFraction");
   size = param.GetSize();
@@ -156,6 +168,13 @@ void Calorimeter::Init()
     fFractionMap[param[i*2].GetInt()] = make_pair(ecalFraction, hcalFraction);
   }
 
+  fFractionTable.assign(kFractionTableSize, fFractionMap[0]);
+  for(itFractionMap = fFractionMap.begin(); itFractionMap != fFractionMap.end(); ++itFractionMap)
+  {
+    if(itFractionMap->first < 0 || itFractionMap->first >= kFractionTableSize) continue;
+    fFractionTable[itFractionMap->first] = itFractionMap->second;
+  }
+
   // read min E value for timing measurement in ECAL
   fTimingEnergyMin = GetDouble("TimingEnergyMin",4.);
   // For timing
@@ -212,7 +231,8 @@ void Calorimeter::Process()
 {
   Candidate *particle, *track;
   TLorentzVector position, momentum;
-  Short_t etaBin, phiBin, flags;
+  Int_t etaBin, phiBin;
+  Short_t flags;
   Int_t number;
   Long64_t towerHit, towerEtaPhi, hitEtaPhi;
   Double_t ecalFraction, hcalFraction;
@@ -220,10 +240,6 @@ void Calorimeter::Process()
   Double_t ecalSigma, hcalSigma;
   Int_t pdgCode;
 
-  TFractionMap::iterator itFractionMap;
-
-  vector< Double_t >::iterator itEtaBin;
-  vector< Double_t >::iterator itPhiBin;
   vector< Double_t > *phiBins;
 
   vector< Long64_t >::iterator itTowerHits;
@@ -245,32 +261,15 @@ void Calorimeter::Process()
 
     pdgCode = TMath::Abs(particle->PID);
 
-    itFractionMap = fFractionMap.find(pdgCode);
-    if(itFractionMap == fFractionMap.end())
-    {
-      itFractionMap = fFractionMap.find(0);
-    }
-
-    ecalFraction = itFractionMap->second.first;
-    hcalFraction = itFractionMap->second.second;
+    GetFractions(pdgCode, ecalFraction, hcalFraction);
 
     fECalTowerFractions.push_back(ecalFraction);
     fHCalTowerFractions.push_back(hcalFraction);
 
     if(ecalFraction < 1.0E-9 && hcalFraction < 1.0E-9) continue;
 
-    // find eta bin [1, fEtaBins.size - 1]
-    itEtaBin = lower_bound(fEtaBins.begin(), fEtaBins.end(), particlePosition.Eta());
-    if(itEtaBin == fEtaBins.begin() || itEtaBin == fEtaBins.end()) continue;
-    etaBin = distance(fEtaBins.begin(), itEtaBin);
-
-    // phi bins for given eta bin
-    phiBins = fPhiBins[etaBin];
-
-    // find phi bin [1, phiBins.size - 1]
-    itPhiBin = lower_bound(phiBins->begin(), phiBins->end(), particlePosition.Phi());
-    if(itPhiBin == phiBins->begin() || itPhiBin == phiBins->end()) continue;
-    phiBin = distance(phiBins->begin(), itPhiBin);
+    // find eta bin [1, fEtaBins.size - 1] and phi bin [1, phiBins.size - 1]
+    if(!fBinning->FindBin(particlePosition.Eta(), particlePosition.Phi(), etaBin, phiBin)) continue;
 
     flags = 0;
     flags |= (pdgCode == 11 || pdgCode == 22) << 1;
@@ -291,30 +290,13 @@ void Calorimeter::Process()
 
     pdgCode = TMath::Abs(track->PID);
 
-    itFractionMap = fFractionMap.find(pdgCode);
-    if(itFractionMap == fFractionMap.end())
-    {
-      itFractionMap = fFractionMap.find(0);
-    }
-
-    ecalFraction = itFractionMap->second.first;
-    hcalFraction = itFractionMap->second.second;
+    GetFractions(pdgCode, ecalFraction, hcalFraction);
 
     fECalTrackFractions.push_back(ecalFraction);
     fHCalTrackFractions.push_back(hcalFraction);
 
-    // find eta bin [1, fEtaBins.size - 1]
-    itEtaBin = lower_bound(fEtaBins.begin(), fEtaBins.end(), trackPosition.Eta());
-    if(itEtaBin == fEtaBins.begin() || itEtaBin == fEtaBins.end()) continue;
-    etaBin = distance(fEtaBins.begin(), itEtaBin);
-
-    // phi bins for given eta bin
-    phiBins = fPhiBins[etaBin];
-
-    // find phi bin [1, phiBins.size - 1]
-    itPhiBin = lower_bound(phiBins->begin(), phiBins->end(), trackPosition.Phi());
-    if(itPhiBin == phiBins->begin() || itPhiBin == phiBins->end()) continue;
-    phiBin = distance(phiBins->begin(), itPhiBin);
+    // find eta bin [1, fEtaBins.size - 1] and phi bin [1, phiBins.size - 1]
+    if(!fBinning->FindBin(trackPosition.Eta(), trackPosition.Phi(), etaBin, phiBin)) continue;
 
     flags = 1;
 
@@ -325,8 +307,9 @@ void Calorimeter::Process()
   }
 
   // all hits are sorted first by eta bin number, then by phi bin number,
-  // then by flags and then by particle or track number
-  sort(fTowerHits.begin(), fTowerHits.end());
+  // then by flags and then by particle or track number,
+  // so that the hits of each tower are consecutive
+  fBinning->SortHits(fTowerHits);
 
   // loop over all hits
   towerEtaPhi = 0;
@@ -470,6 +453,29 @@ void Calorimeter::Process()
 
 //------------------------------------------------------------------------------
 
+void Calorimeter::GetFractions(Int_t pdgCode, Double_t &ecalFraction, Double_t &hcalFraction)
+{
+  TFractionMap::iterator itFractionMap;
+
+  if(pdgCode < kFractionTableSize)
+  {
+    ecalFraction = fFractionTable[pdgCode].first;
+    hcalFraction = fFractionTable[pdgCode].second;
+    return;
+  }
+
+  itFractionMap = fFractionMap.find(pdgCode);
+  if(itFractionMap == fFractionMap.end())
+  {
+    itFractionMap = fFractionMap.find(0);
+  }
+
+  ecalFraction = itFractionMap->second.first;
+  hcalFraction = itFractionMap->second.second;
+}
+
+//------------------------------------------------------------------------------
+
 void Calorimeter::FinalizeTower()
 {
   Candidate *track, *tower, *mother;
@@ -501,8 +507,8 @@ void Calorimeter::FinalizeTower()
 
   if(fSmearTowerCenter)
   {
-    eta = gRandom->Uniform(fTowerEdges[0], fTowerEdges[1]);
-    phi = gRandom->Uniform(fTowerEdges[2], fTowerEdges[3]);
+    eta = GetRandom()->Uniform(fTowerEdges[0], fTowerEdges[1]);
+    phi = GetRandom()->Uniform(fTowerEdges[2], fTowerEdges[3]);
   }
   else
   {
@@ -653,7 +659,7 @@ Double_t Calorimeter::LogNormal(Double_t mean, Double_t sigma)
     b = TMath::Sqrt(TMath::Log((1.0 + (sigma*sigma)/(mean*mean))));
     a = TMath::Log(mean) - 0.5*b*b;
 
-    return TMath::Exp(a + b*gRandom->Gaus(0.0, 1.0));
+    return TMath::Exp(a + b*GetRandom()->Gaus(0.0, 1.0));
   }
   else
   {
@@ -36,6 +36,7 @@
 
 class TObjArray;
 class DelphesFormula;
+class DelphesCaloBinning;
 class Candidate;
 
 class Calorimeter: public DelphesModule
@@ -75,6 +76,10 @@ private:
   TFractionMap fFractionMap; //!
   TBinMap fBinMap; //!
 
+  std::vector < std::pair< Double_t, Double_t > > fFractionTable; //!
+
+  DelphesCaloBinning *fBinning; //!
+
   std::vector < Double_t > fEtaBins;
   std::vector < std::vector < Double_t >* > fPhiBins;
 
@@ -108,6 +113,7 @@ private:
   TObjArray *fHCalTowerTrackArray[2]; //!
   TIterator *fItHCalTowerTrackArray[2]; //!
 
+  void GetFractions(Int_t pdgCode, Double_t &ecalFraction, Double_t &hcalFraction);
   void FinalizeTower();
   Double_t LogNormal(Double_t mean, Double_t sigma);
 
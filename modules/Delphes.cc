@@ -59,7 +59,7 @@
 using namespace std;
 
 Delphes::Delphes(const char *name) :
-  fFactory(0)
+  fFactory(0), fRandomStreams(kFALSE), fRandomSeed(0), fEventNumber(0)
 {
   TFolder *folder = new TFolder(name, "");
   fFactory = new DelphesFactory("ObjectFactory");
@@ -120,6 +120,13 @@ void Delphes::Init()
 
   gRandom->SetSeed(confReader->GetInt("::RandomSeed", 0));
 
+  // every module draws random numbers from its own stream
+  // determined by the seed, the module name and the event number,
+  // without streams the output depends on ::NumberOfWorkers
+  fRandomStreams = confReader->GetBool("::RandomStreams", true);
+  fRandomSeed = confReader->GetInt("::RandomSeed", 0);
+  if(fRandomSeed == 0) fRandomSeed = gRandom->Integer(kMaxUInt) + 1;
+
   for(i = 0; i < size; ++i)
   {
     name = param[i].GetString();
@@ -146,6 +153,19 @@ void Delphes::Init()
 
 void Delphes::Process()
 {
+  TIter itTasks(GetListOfTasks());
+  TObject *task;
+
+  if(fRandomStreams)
+  {
+    while((task = itTasks()))
+    {
+      if(!task->IsA()->InheritsFrom(DelphesModule::Class())) continue;
+      static_cast<DelphesModule *>(task)->SetRandomStream(fRandomSeed, fEventNumber);
+    }
+  }
+
+  ++fEventNumber;
 }
 
 //------------------------------------------------------------------------------
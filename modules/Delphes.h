@@ -50,6 +50,10 @@ public:
 
   void Clear();
 
+  // number of the next event, used to select the random streams of the modules,
+  // incremented after every event
+  void SetEventNumber(Long64_t eventNumber) { fEventNumber = eventNumber; }
+
   virtual void Init();
   virtual void Process();
   virtual void Finish();
@@ -58,6 +62,10 @@ private:
 
   DelphesFactory *fFactory;
 
+  Bool_t fRandomStreams;
+  ULong64_t fRandomSeed;
+  Long64_t fEventNumber;
+
   ClassDef(Delphes, 1)
 };
 
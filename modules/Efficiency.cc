@@ -30,6 +30,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEfficiencyMap.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -53,16 +54,16 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 Efficiency::Efficiency() :
-  fFormula(0), fItInputArray(0)
+  fEfficiency(0), fItInputArray(0)
 {
-  fFormula = new DelphesFormula;
+  fEfficiency = new DelphesEfficiencyMap;
 }
 
 //------------------------------------------------------------------------------
 
 Efficiency::~Efficiency()
 {
-  if(fFormula) delete fFormula;
+  if(fEfficiency) delete fEfficiency;
 }
 
 //------------------------------------------------------------------------------
@@ -71,7 +72,8 @@ void Efficiency::Init()
 {
   // read efficiency formula
 
-  fFormula->Compile(GetString("EfficiencyFormula", "1.0"));
+  SetEfficiencyTable(fEfficiency);
+  fEfficiency->SetFormula(0, GetString("EfficiencyFormula", "1.0"));
 
   // import input array
 
@@ -95,22 +97,40 @@ void Efficiency::Finish()
 void Efficiency::Process()
 { 
   Candidate *candidate;
-  Double_t pt, eta, phi, e;
+  Int_t i, n;
+
+  fCandidates.clear();
+  fPT.clear();
+  fEta.clear();
+  fPhi.clear();
+  fE.clear();
 
   fItInputArray->Reset();
   while((candidate = static_cast<Candidate*>(fItInputArray->Next())))
   {
     const TLorentzVector &candidatePosition = candidate->Position;
     const TLorentzVector &candidateMomentum = candidate->Momentum;
-    eta = candidatePosition.Eta();
-    phi = candidatePosition.Phi();
-    pt = candidateMomentum.Pt();
-    e = candidateMomentum.E();
 
+    fCandidates.push_back(candidate);
+    fEta.push_back(candidatePosition.Eta());
+    fPhi.push_back(candidatePosition.Phi());
+    fPT.push_back(candidateMomentum.Pt());
+    fE.push_back(candidateMomentum.E());
+  }
+
+  n = fCandidates.size();
+  if(n == 0) return;
+
+  // evaluate the efficiencies of all candidates
+  fEfficiencies.resize(n);
+  fEfficiency->EvalN(0, &fPT[0], &fEta[0], &fPhi[0], &fE[0], &fEfficiencies[0], n);
+
+  for(i = 0; i < n; ++i)
+  {
     // apply an efficency formula
-    if(gRandom->Uniform() > fFormula->Eval(pt, eta, phi, e)) continue;
-    
-    fOutputArray->Add(candidate);
+    if(GetRandom()->Uniform() > fEfficiencies[i]) continue;
+
+    fOutputArray->Add(fCandidates[i]);
   }
 }
 
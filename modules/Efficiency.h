@@ -29,9 +29,12 @@
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TIterator;
 class TObjArray;
-class DelphesFormula;
+class Candidate;
+class DelphesEfficiencyMap;
 
 class Efficiency: public DelphesModule
 {
@@ -46,7 +49,10 @@ public:
 
 private:
 
-  DelphesFormula *fFormula; //!
+  DelphesEfficiencyMap *fEfficiency; //!
+
+  std::vector< Candidate * > fCandidates; //!
+  std::vector< Double_t > fPT, fEta, fPhi, fE, fEfficiencies; //!
 
   TIterator *fItInputArray; //!
 
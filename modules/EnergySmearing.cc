@@ -109,7 +109,7 @@ void EnergySmearing::Process()
     energy = candidateMomentum.E();
  
     // apply smearing formula
-    energy = gRandom->Gaus(energy, fFormula->Eval(pt, eta, phi, energy));
+    energy = GetRandom()->Gaus(energy, fFormula->Eval(pt, eta, phi, energy));
      
     if(energy <= 0.0) continue;
  
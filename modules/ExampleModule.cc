@@ -120,7 +120,7 @@ void ExampleModule::Process()
     candidateMomentum = candidate->Momentum;
 
     // apply an efficency formula
-    if(gRandom->Uniform() <= fFormula->Eval(candidateMomentum.Pt(), candidatePosition.Eta()))
+    if(GetRandom()->Uniform() <= fFormula->Eval(candidateMomentum.Pt(), candidatePosition.Eta()))
     {
       fOutputArray->Add(candidate);
     }
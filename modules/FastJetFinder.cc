@@ -68,6 +68,7 @@
 #include "fastjet/tools/Filter.hh"
 #include "fastjet/tools/Pruner.hh"
 #include "fastjet/contribs/RecursiveTools/SoftDrop.hh"
+#include "fastjet/contribs/RecursiveTools/Recluster.hh"
 
 using namespace std;
 using namespace fastjet;
@@ -77,8 +78,12 @@ using namespace fastjet::contrib;
 //------------------------------------------------------------------------------
 
 FastJetFinder::FastJetFinder() :
-  fPlugin(0), fRecomb(0), fNjettinessPlugin(0), fDefinition(0), fAreaDefinition(0), fItInputArray(0)
+  fPlugin(0), fRecomb(0), fNjettinessPlugin(0), fDefinition(0),
+  fTrimmer(0), fPruner(0), fSoftDrop(0), fReclusterCA(0),
+  fAreaDefinition(0), fItInputArray(0)
 {
+  Int_t i;
+  for(i = 0; i < 5; ++i) fNsubjettiness[i] = 0;
 
 }
 
@@ -99,6 +104,7 @@ void FastJetFinder::Init()
   Long_t i, size;
   Double_t etaMin, etaMax;
   TEstimatorStruct estimatorStruct;
+  Njettiness::AxesMode axisMode;
 
   // define algorithm
 
@@ -223,6 +229,52 @@ void FastJetFinder::Init()
 
   ClusterSequence::print_banner();
 
+  // create substructure tools
+
+  if(fComputeTrimming)
+  {
+    fTrimmer = new Filter(JetDefinition(kt_algorithm, fRTrim), SelectorPtFractionMin(fPtFracTrim));
+  }
+
+  if(fComputePruning)
+  {
+    fPruner = new Pruner(JetDefinition(cambridge_algorithm, fRPrun), fZcutPrun, fRcutPrun);
+  }
+
+  if(fComputeSoftDrop)
+  {
+    // same reclustering as done internally by SoftDrop,
+    // the C/A jet is computed once per jet and given to SoftDrop
+    fReclusterCA = new Recluster(cambridge_algorithm, JetDefinition::max_allowable_R);
+    fSoftDrop = new SoftDrop(fBetaSoftDrop, fSymmetryCutSoftDrop, fR0SoftDrop);
+    fSoftDrop->set_reclustering(false);
+  }
+
+  if(fComputeNsubjettiness)
+  {
+    switch(fAxisMode)
+    {
+      default:
+      case 1:
+        axisMode = Njettiness::wta_kt_axes;
+        break;
+      case 2:
+        axisMode = Njettiness::onepass_wta_kt_axes;
+        break;
+      case 3:
+        axisMode = Njettiness::kt_axes;
+        break;
+      case 4:
+        axisMode = Njettiness::onepass_kt_axes;
+        break;
+    }
+
+    for(i = 0; i < 5; ++i)
+    {
+      fNsubjettiness[i] = new Nsubjettiness(i + 1, axisMode, Njettiness::unnormalized_measure, fBeta);
+    }
+  }
+
   if(fComputeRho && fAreaDefinition)
   {
     // read eta ranges
@@ -258,6 +310,7 @@ void FastJetFinder::Init()
 void FastJetFinder::Finish()
 {
   vector< TEstimatorStruct >::iterator itEstimators;
+  Int_t i;
 
   for(itEstimators = fEstimators.begin(); itEstimators != fEstimators.end(); ++itEstimators)
   {
@@ -270,6 +323,14 @@ void FastJetFinder::Finish()
   if(fPlugin) delete static_cast<JetDefinition::Plugin*>(fPlugin);
   if(fRecomb) delete static_cast<JetDefinition::Recombiner*>(fRecomb);
   if(fNjettinessPlugin) delete static_cast<JetDefinition::Plugin*>(fNjettinessPlugin);
+  if(fTrimmer) delete fTrimmer;
+  if(fPruner) delete fPruner;
+  if(fSoftDrop) delete fSoftDrop;
+  if(fReclusterCA) delete fReclusterCA;
+  for(i = 0; i < 5; ++i)
+  {
+    if(fNsubjettiness[i]) delete fNsubjettiness[i];
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -284,11 +345,14 @@ void FastJetFinder::Process()
   Int_t number, ncharged, nneutrals;
   Int_t charge; 
   Double_t rho = 0.0;
-  PseudoJet jet, area;
+  PseudoJet jet, area, reclusteredJet;
   ClusterSequence *sequence;
-  vector< PseudoJet > inputList, outputList, subjets;
+  ClusterSequenceArea *sequenceArea = 0;
+  vector< PseudoJet > &inputList = fInputList, &outputList = fOutputList;
+  vector< PseudoJet > &constituents = fConstituents, &subjets = fSubjets;
   vector< PseudoJet >::iterator itInputList, itOutputList;
   vector< TEstimatorStruct >::iterator itEstimators;
+  size_t i;
 
   DelphesFactory *factory = GetFactory();
 
@@ -309,7 +373,8 @@ void FastJetFinder::Process()
   // construct jets
   if(fAreaDefinition)
   {
-    sequence = new ClusterSequenceArea(inputList, *fDefinition, *fAreaDefinition);
+    sequenceArea = new ClusterSequenceArea(inputList, *fDefinition, *fAreaDefinition);
+    sequence = sequenceArea;
   }
   else
   {
@@ -319,9 +384,11 @@ void FastJetFinder::Process()
   // compute rho and store it
   if(fComputeRho && fAreaDefinition)
   {
+    // the estimators have the same jet and area definitions as the jets,
+    // all eta ranges reuse the clustering done for the jets
     for(itEstimators = fEstimators.begin(); itEstimators != fEstimators.end(); ++itEstimators)
     {
-      itEstimators->estimator->set_particles(inputList);
+      itEstimators->estimator->set_cluster_sequence(*sequenceArea);
       rho = itEstimators->estimator->rho();
 
       candidate = factory->NewCandidate();
@@ -360,10 +427,10 @@ void FastJetFinder::Process()
     ncharged = 0;
     nneutrals = 0;
 
-    inputList.clear();
-    inputList = sequence->constituents(*itOutputList);
+    constituents.clear();
+    sequence->add_constituents(*itOutputList, constituents);
 
-    for(itInputList = inputList.begin(); itInputList != inputList.end(); ++itInputList)
+    for(itInputList = constituents.begin(); itInputList != constituents.end(); ++itInputList)
     {
       if(itInputList->user_index() < 0) continue;
       constituent = static_cast<Candidate*>(fInputArray->At(itInputList->user_index()));
@@ -398,118 +465,82 @@ void FastJetFinder::Process()
     // Trimming
     //------------------------------------
 
-     if(fComputeTrimming)
+    if(fComputeTrimming)
     {
+      PseudoJet trimmed_jet = (*fTrimmer)(*itOutputList);
 
-      fastjet::Filter    trimmer(fastjet::JetDefinition(fastjet::kt_algorithm,fRTrim),fastjet::SelectorPtFractionMin(fPtFracTrim));
-      fastjet::PseudoJet trimmed_jet = trimmer(*itOutputList);
-      
       trimmed_jet = join(trimmed_jet.constituents());
-     
+
       candidate->TrimmedP4[0].SetPtEtaPhiM(trimmed_jet.pt(), trimmed_jet.eta(), trimmed_jet.phi(), trimmed_jet.m());
-        
-      // four hardest subjets 
-      subjets.clear();
+
+      // four hardest subjets
       subjets = trimmed_jet.pieces();
       subjets = sorted_by_pt(subjets);
-      
+
       candidate->NSubJetsTrimmed = subjets.size();
 
-      for (size_t i = 0; i < subjets.size() and i < 4; i++){
-	if(subjets.at(i).pt() < 0) continue ; 
- 	candidate->TrimmedP4[i+1].SetPtEtaPhiM(subjets.at(i).pt(), subjets.at(i).eta(), subjets.at(i).phi(), subjets.at(i).m());
+      for(i = 0; i < subjets.size() && i < 4; ++i)
+      {
+        if(subjets[i].pt() < 0) continue;
+        candidate->TrimmedP4[i + 1].SetPtEtaPhiM(subjets[i].pt(), subjets[i].eta(), subjets[i].phi(), subjets[i].m());
       }
     }
-    
-    
+
     //------------------------------------
     // Pruning
     //------------------------------------
-    
-    
+
     if(fComputePruning)
     {
-
-      fastjet::Pruner    pruner(fastjet::JetDefinition(fastjet::cambridge_algorithm,fRPrun),fZcutPrun,fRcutPrun);
-      fastjet::PseudoJet pruned_jet = pruner(*itOutputList);
+      PseudoJet pruned_jet = (*fPruner)(*itOutputList);
 
       candidate->PrunedP4[0].SetPtEtaPhiM(pruned_jet.pt(), pruned_jet.eta(), pruned_jet.phi(), pruned_jet.m());
-         
-      // four hardest subjet 
-      subjets.clear();
+
+      // four hardest subjets
       subjets = pruned_jet.pieces();
       subjets = sorted_by_pt(subjets);
-      
+
       candidate->NSubJetsPruned = subjets.size();
 
-      for (size_t i = 0; i < subjets.size() and i < 4; i++){
-	if(subjets.at(i).pt() < 0) continue ; 
-  	candidate->PrunedP4[i+1].SetPtEtaPhiM(subjets.at(i).pt(), subjets.at(i).eta(), subjets.at(i).phi(), subjets.at(i).m());
+      for(i = 0; i < subjets.size() && i < 4; ++i)
+      {
+        if(subjets[i].pt() < 0) continue;
+        candidate->PrunedP4[i + 1].SetPtEtaPhiM(subjets[i].pt(), subjets[i].eta(), subjets[i].phi(), subjets[i].m());
       }
+    }
 
-    } 
-     
     //------------------------------------
     // SoftDrop
     //------------------------------------
-   
+
     if(fComputeSoftDrop)
     {
-    
-      contrib::SoftDrop  softDrop(fBetaSoftDrop,fSymmetryCutSoftDrop,fR0SoftDrop);
-      fastjet::PseudoJet softdrop_jet = softDrop(*itOutputList);
-      
+      reclusteredJet = (*fReclusterCA)(*itOutputList);
+      PseudoJet softdrop_jet = (*fSoftDrop)(reclusteredJet);
+
       candidate->SoftDroppedP4[0].SetPtEtaPhiM(softdrop_jet.pt(), softdrop_jet.eta(), softdrop_jet.phi(), softdrop_jet.m());
-        
-      // four hardest subjet 
-      
-      subjets.clear();
-      subjets    = softdrop_jet.pieces();
-      subjets    = sorted_by_pt(subjets);
-      candidate->NSubJetsSoftDropped = softdrop_jet.pieces().size();
-
-      for (size_t i = 0; i < subjets.size()  and i < 4; i++){
-	if(subjets.at(i).pt() < 0) continue ; 
-  	candidate->SoftDroppedP4[i+1].SetPtEtaPhiM(subjets.at(i).pt(), subjets.at(i).eta(), subjets.at(i).phi(), subjets.at(i).m());
+
+      // four hardest subjets
+      subjets = softdrop_jet.pieces();
+      subjets = sorted_by_pt(subjets);
+
+      candidate->NSubJetsSoftDropped = subjets.size();
+
+      for(i = 0; i < subjets.size() && i < 4; ++i)
+      {
+        if(subjets[i].pt() < 0) continue;
+        candidate->SoftDroppedP4[i + 1].SetPtEtaPhiM(subjets[i].pt(), subjets[i].eta(), subjets[i].phi(), subjets[i].m());
       }
     }
-  
+
     // --- compute N-subjettiness with N = 1,2,3,4,5 ----
 
     if(fComputeNsubjettiness)
     {
-      Njettiness::AxesMode axisMode;
-
-      switch(fAxisMode)
+      for(i = 0; i < 5; ++i)
       {
-        default:
-        case 1:
-          axisMode = Njettiness::wta_kt_axes;
-          break;
-        case 2:
-          axisMode = Njettiness::onepass_wta_kt_axes;
-          break;
-        case 3:
-          axisMode = Njettiness::kt_axes;
-          break;
-        case 4:
-          axisMode = Njettiness::onepass_kt_axes;
-          break;
+        candidate->Tau[i] = (*fNsubjettiness[i])(*itOutputList);
       }
-
-      Njettiness::MeasureMode measureMode = Njettiness::unnormalized_measure;
-
-      Nsubjettiness nSub1(1, axisMode, measureMode, fBeta);
-      Nsubjettiness nSub2(2, axisMode, measureMode, fBeta);
-      Nsubjettiness nSub3(3, axisMode, measureMode, fBeta);
-      Nsubjettiness nSub4(4, axisMode, measureMode, fBeta);
-      Nsubjettiness nSub5(5, axisMode, measureMode, fBeta);
-
-      candidate->Tau[0] = nSub1(*itOutputList);
-      candidate->Tau[1] = nSub2(*itOutputList);
-      candidate->Tau[2] = nSub3(*itOutputList);
-      candidate->Tau[3] = nSub4(*itOutputList);
-      candidate->Tau[4] = nSub5(*itOutputList);
     }
 
     fOutputArray->Add(candidate);
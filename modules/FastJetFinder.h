@@ -31,6 +31,10 @@
 
 #include <vector>
 
+#if !defined(__CINT__) && !defined(__CLING__)
+#include "fastjet/PseudoJet.hh"
+#endif
+
 class TObjArray;
 class TIterator;
 
@@ -38,8 +42,13 @@ namespace fastjet {
   class JetDefinition;
   class AreaDefinition;
   class JetMedianBackgroundEstimator;
+  class Filter;
+  class Pruner;
   namespace contrib {
     class NjettinessPlugin;
+    class Nsubjettiness;
+    class SoftDrop;
+    class Recluster;
   }
 }
 
@@ -102,6 +111,16 @@ private:
   Double_t fSymmetryCutSoftDrop;
   Double_t fR0SoftDrop;
 
+  // -- substructure tools, created once in Init --
+
+  fastjet::Filter *fTrimmer; //!
+  fastjet::Pruner *fPruner; //!
+  fastjet::contrib::SoftDrop *fSoftDrop; //!
+  fastjet::contrib::Nsubjettiness *fNsubjettiness[5]; //!
+
+  // C/A reclustering of the current jet, computed at most once per jet
+  fastjet::contrib::Recluster *fReclusterCA; //!
+
   // --- FastJet Area method --------
 
   fastjet::AreaDefinition *fAreaDefinition;
@@ -127,6 +146,12 @@ private:
   };
 
   std::vector< TEstimatorStruct > fEstimators; //!
+
+  // particle lists keep their capacity between events
+  std::vector< fastjet::PseudoJet > fInputList; //!
+  std::vector< fastjet::PseudoJet > fOutputList; //!
+  std::vector< fastjet::PseudoJet > fConstituents; //!
+  std::vector< fastjet::PseudoJet > fSubjets; //!
 #endif
 
   TIterator *fItInputArray; //!
@@ -143,7 +143,7 @@ void FastJetGridMedianEstimator::Process()
   Int_t number;
   Double_t rho = 0;
   PseudoJet jet;
-  vector< PseudoJet > inputList, outputList;
+  vector< PseudoJet > &inputList = fInputList;
 
   vector< GridMedianBackgroundEstimator * >::iterator itEstimators;;
 
@@ -163,7 +163,8 @@ void FastJetGridMedianEstimator::Process()
     ++number;
   }
 
-  // compute rho and store it
+  // compute rho and store it,
+  // each estimator fills its grid in one pass over the input particles
 
   for(itEstimators = fEstimators.begin(); itEstimators != fEstimators.end(); ++itEstimators)
   {
@@ -31,6 +31,10 @@
 #include "classes/DelphesModule.h"
 #include <vector>
 
+#if !defined(__CINT__) && !defined(__CLING__)
+#include "fastjet/PseudoJet.hh"
+#endif
+
 class TObjArray;
 class TIterator;
 
@@ -53,6 +57,11 @@ private:
 
   std::vector< fastjet::GridMedianBackgroundEstimator * > fEstimators; //!
 
+#if !defined(__CINT__) && !defined(__CLING__)
+  // input particles, keep their capacity between events
+  std::vector< fastjet::PseudoJet > fInputList; //!
+#endif
+
   TIterator *fItInputArray; //!
 
   const TObjArray *fInputArray; //!
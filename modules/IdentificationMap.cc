@@ -156,7 +156,7 @@ void IdentificationMap::Process()
     if(range.first == range.second) range = fEfficiencyMap.equal_range(-pdgCodeIn);
     if(range.first == range.second) range = fEfficiencyMap.equal_range(0);
 
-    r = gRandom->Uniform();
+    r = GetRandom()->Uniform();
     total = 0.0;
 
     // loop over sub-map for this PID
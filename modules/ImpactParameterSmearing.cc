@@ -121,9 +121,9 @@ void ImpactParameterSmearing::Process()
     zd =  candidate->Zd;
 
     // calculate smeared values
-    sx = gRandom->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
-    sy = gRandom->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
-    sz = gRandom->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
+    sx = GetRandom()->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
+    sy = GetRandom()->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
+    sz = GetRandom()->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
 
     xd += sx;
     yd += sy;
@@ -132,7 +132,7 @@ void ImpactParameterSmearing::Process()
     // calculate impact parameter (after-smearing)
     dxy = (xd*py - yd*px)/pt;
 
-    ddxy = gRandom->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
+    ddxy = GetRandom()->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
 
     // fill smeared values in candidate
     mother = candidate;
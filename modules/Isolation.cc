@@ -33,6 +33,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEtaPhiIndex.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -55,37 +56,9 @@ using namespace std;
 
 //------------------------------------------------------------------------------
 
-class IsolationClassifier : public ExRootClassifier
-{
-public:
-
-  IsolationClassifier() {}
-
-  Int_t GetCategory(TObject *object);
-
-  Double_t fPTMin;
-};
-
-//------------------------------------------------------------------------------
-
-Int_t IsolationClassifier::GetCategory(TObject *object)
-{
-  Candidate *track = static_cast<Candidate*>(object);
-  const TLorentzVector &momentum = track->Momentum;
-
-  if(momentum.Pt() < fPTMin) return -1;
-
-  return 0;
-}
-
-//------------------------------------------------------------------------------
-
 Isolation::Isolation() :
-  fClassifier(0), fFilter(0),
-  fItIsolationInputArray(0), fItCandidateInputArray(0),
-  fItRhoInputArray(0)
+  fItCandidateInputArray(0), fItRhoInputArray(0)
 {
-  fClassifier = new IsolationClassifier;
 }
 
 //------------------------------------------------------------------------------
@@ -108,14 +81,11 @@ void Isolation::Init()
 
   fUsePTSum = GetBool("UsePTSum", false);
 
-  fClassifier->fPTMin = GetDouble("PTMin", 0.5);
+  fPTMin = GetDouble("PTMin", 0.5);
 
   // import input array(s)
 
   fIsolationInputArray = ImportArray(GetString("IsolationInputArray", "Delphes/partons"));
-  fItIsolationInputArray = fIsolationInputArray->MakeIterator();
-
-  fFilter = new ExRootFilter(fIsolationInputArray);
 
   fCandidateInputArray = ImportArray(GetString("CandidateInputArray", "Calorimeter/electrons"));
   fItCandidateInputArray = fCandidateInputArray->MakeIterator();
@@ -141,9 +111,7 @@ void Isolation::Init()
 void Isolation::Finish()
 {
   if(fItRhoInputArray) delete fItRhoInputArray;
-  if(fFilter) delete fFilter;
   if(fItCandidateInputArray) delete fItCandidateInputArray;
-  if(fItIsolationInputArray) delete fItIsolationInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -151,92 +119,121 @@ void Isolation::Finish()
 void Isolation::Process()
 {
   Candidate *candidate, *isolation, *object;
-  TObjArray *isolationArray;
+  DelphesEtaPhiIndex *index;
   Double_t sumCharged, sumNeutral, sumAllParticles, sumChargedPU, sumDBeta, ratioDBeta, sumRhoCorr, ratioRhoCorr;
-  Int_t counter;
+  Double_t pt;
+  Int_t i, size;
+  Bool_t found, sorted;
   Double_t eta = 0.0;
   Double_t rho = 0.0;
+  Double_t maxEta = 0.0;
+  vector< RhoBin >::const_iterator itRhoBins;
 
-  // select isolation objects
-  fFilter->Reset();
-  isolationArray = fFilter->GetSubArray(fClassifier, 0);
+  index = GetKinematics(fIsolationInputArray);
 
-  if(isolationArray == 0) return;
+  // select isolation objects
+  size = index->GetSize();
+  found = kFALSE;
+  for(i = 0; i < size && !found; ++i)
+  {
+    found = index->GetCandidate(i) && index->GetPT(i) >= fPTMin;
+  }
 
-  TIter itIsolationArray(isolationArray);
+  if(!found) return;
 
-  // loop over all input jets
-  fItCandidateInputArray->Reset();
-  while((candidate = static_cast<Candidate*>(fItCandidateInputArray->Next())))
+  // sort rho bins by lower edge,
+  // overlapping bins are kept in their original order and searched one by one
+  fRhoBins.clear();
+  sorted = kTRUE;
+  if(fRhoInputArray)
   {
-    const TLorentzVector &candidateMomentum = candidate->Momentum;
-    eta = TMath::Abs(candidateMomentum.Eta());
+    fItRhoInputArray->Reset();
+    while((object = static_cast<Candidate*>(fItRhoInputArray->Next())))
+    {
+      fRhoBins.push_back(RhoBin(object->Edges[0], object->Edges[1], object->Momentum.Pt()));
+    }
+    stable_sort(fRhoBins.begin(), fRhoBins.end());
 
-    // find rho
-    rho = 0.0;
-    if(fRhoInputArray)
+    for(itRhoBins = fRhoBins.begin(); itRhoBins != fRhoBins.end() && sorted; ++itRhoBins)
+    {
+      if(itRhoBins != fRhoBins.begin() && itRhoBins->min < maxEta) sorted = kFALSE;
+      if(itRhoBins == fRhoBins.begin() || itRhoBins->max > maxEta) maxEta = itRhoBins->max;
+    }
+
+    if(!sorted)
     {
+      fRhoBins.clear();
       fItRhoInputArray->Reset();
       while((object = static_cast<Candidate*>(fItRhoInputArray->Next())))
       {
-        if(eta >= object->Edges[0] && eta < object->Edges[1])
-        {
-          rho = object->Momentum.Pt();
-        }
+        fRhoBins.push_back(RhoBin(object->Edges[0], object->Edges[1], object->Momentum.Pt()));
       }
     }
+  }
+
+  // loop over all input jets
+  fItCandidateInputArray->Reset();
+  while((candidate = static_cast<Candidate*>(fItCandidateInputArray->Next())))
+  {
+    const TLorentzVector &candidateMomentum = candidate->Momentum;
+    eta = candidateMomentum.Eta();
+
+    // loop over all isolation objects in the cone
 
-    // loop over all input tracks
-    
     sumNeutral = 0.0;
     sumCharged = 0.0;
     sumChargedPU = 0.0;
     sumAllParticles = 0.0;
-   
-    counter = 0;
-    itIsolationArray.Reset();
-    
-    while((isolation = static_cast<Candidate*>(itIsolationArray.Next())))
+
+    fCone.clear();
+    index->Query(eta, candidateMomentum.Phi(), fDeltaRMax, fCone);
+
+    for(i = 0; i < Int_t(fCone.size()); ++i)
     {
-      const TLorentzVector &isolationMomentum = isolation->Momentum;
+      pt = index->GetPT(fCone[i]);
+      if(pt < fPTMin) continue;
+
+      isolation = index->GetCandidate(fCone[i]);
+      if(candidate->GetUniqueID() == isolation->GetUniqueID()) continue;
 
-      if(candidateMomentum.DeltaR(isolationMomentum) <= fDeltaRMax &&
-         candidate->GetUniqueID() != isolation->GetUniqueID())
+      sumAllParticles += pt;
+      if(isolation->Charge != 0)
       {
-        sumAllParticles += isolationMomentum.Pt();
-        if(isolation->Charge !=0) 
-	{ 
-	  sumCharged += isolationMomentum.Pt();
-          if(isolation->IsRecoPU != 0) sumChargedPU += isolationMomentum.Pt();
-	} 
-        else
-	{
-	  sumNeutral += isolationMomentum.Pt();
-        }
-        ++counter;
+        sumCharged += pt;
+        if(isolation->IsRecoPU != 0) sumChargedPU += pt;
+      }
+      else
+      {
+        sumNeutral += pt;
       }
     }
 
-    // find rho
+    // find rho, with overlapping bins the last bin that contains eta is used
     rho = 0.0;
-    if(fRhoInputArray)
+    eta = TMath::Abs(eta);
+    if(sorted)
     {
-      fItRhoInputArray->Reset();
-      while((object = static_cast<Candidate*>(fItRhoInputArray->Next())))
+      itRhoBins = upper_bound(fRhoBins.begin(), fRhoBins.end(), RhoBin(eta, eta, 0.0));
+      if(itRhoBins != fRhoBins.begin())
+      {
+        --itRhoBins;
+        if(eta < itRhoBins->max) rho = itRhoBins->rho;
+      }
+    }
+    else
+    {
+      for(itRhoBins = fRhoBins.begin(); itRhoBins != fRhoBins.end(); ++itRhoBins)
       {
-        if(eta >= object->Edges[0] && eta < object->Edges[1])
-        {
-          rho = object->Momentum.Pt();
-        }
+        if(eta >= itRhoBins->min && eta < itRhoBins->max) rho = itRhoBins->rho;
       }
     }
 
-     // correct sum for pile-up contamination
+    // correct sum for pile-up contamination
     sumDBeta = sumCharged + TMath::Max(sumNeutral-0.5*sumChargedPU,0.0);
     sumRhoCorr = sumCharged + TMath::Max(sumNeutral-TMath::Max(rho,0.0)*fDeltaRMax*fDeltaRMax*TMath::Pi(),0.0);
     ratioDBeta = sumDBeta/candidateMomentum.Pt();
     ratioRhoCorr = sumRhoCorr/candidateMomentum.Pt();
-    
+
     candidate->IsolationVar = ratioDBeta;
     candidate->IsolationVarRhoCorr = ratioRhoCorr;
     candidate->SumPtCharged = sumCharged;
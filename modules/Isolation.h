@@ -32,10 +32,9 @@
 
 #include "classes/DelphesModule.h"
 
-class TObjArray;
+#include <vector>
 
-class ExRootFilter;
-class IsolationClassifier;
+class TObjArray;
 
 class Isolation: public DelphesModule
 {
@@ -56,13 +55,20 @@ private:
 
   Double_t fPTSumMax;
 
+  Double_t fPTMin;
+
   Bool_t fUsePTSum;
 
-  IsolationClassifier *fClassifier; //!
+  struct RhoBin
+  {
+    RhoBin(Double_t minEta, Double_t maxEta, Double_t value) : min(minEta), max(maxEta), rho(value) {}
+    bool operator<(const RhoBin &bin) const { return min < bin.min; }
+    Double_t min, max, rho;
+  };
 
-  ExRootFilter *fFilter;
+  std::vector< RhoBin > fRhoBins; //!
 
-  TIterator *fItIsolationInputArray; //!
+  std::vector< Int_t > fCone; //!
 
   TIterator *fItCandidateInputArray; //!
 
@@ -155,7 +155,7 @@ void JetFakeParticle::Process()
     pt = candidateMomentum.Pt();
     e = candidateMomentum.E();
 
-    r = gRandom->Uniform();
+    r = GetRandom()->Uniform();
     total = 0.0;
     fake = 0;
 
@@ -181,7 +181,7 @@ void JetFakeParticle::Process()
           }
           else
           {
-            rs = gRandom->Uniform();
+            rs = GetRandom()->Uniform();
             fake->Charge = (rs < 0.5) ? -1 : 1;
             
           }
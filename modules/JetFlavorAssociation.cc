@@ -30,9 +30,9 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEtaPhiIndex.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
-#include "ExRootAnalysis/ExRootFilter.h"
 #include "ExRootAnalysis/ExRootClassifier.h"
 
 #include "TMath.h"
@@ -116,10 +116,18 @@ Int_t ParticleLHEFClassifier::GetCategory(TObject *object)
 
 //------------------------------------------------------------------------------
 
+// flags of the partons
+static const Char_t kSelected = 1;
+// can give the algorithmic flavor
+static const Char_t kAlgoCandidate = 2;
+// can contaminate the physics flavor
+static const Char_t kContamination = 4;
+
+//------------------------------------------------------------------------------
+
 JetFlavorAssociation::JetFlavorAssociation() :
-  fPartonClassifier(0), fPartonFilter(0), fParticleLHEFFilter(0),
-  fItPartonInputArray(0), fItParticleInputArray(0),
-  fItParticleLHEFInputArray(0), fItJetInputArray(0)
+  fPartonClassifier(0), fParticleLHEFClassifier(0),
+  fPartons(0), fPartonsLHEF(0), fItJetInputArray(0)
 {
   fPartonClassifier = new PartonClassifier;
   fParticleLHEFClassifier = new ParticleLHEFClassifier;
@@ -149,11 +157,8 @@ void JetFlavorAssociation::Init()
 
   // import input array(s)
   fPartonInputArray = ImportArray(GetString("PartonInputArray", "Delphes/partons"));
-  fItPartonInputArray = fPartonInputArray->MakeIterator();
-  fPartonFilter = new ExRootFilter(fPartonInputArray);
 
   fParticleInputArray = ImportArray(GetString("ParticleInputArray", "Delphes/allParticles"));
-  fItParticleInputArray = fParticleInputArray->MakeIterator();
 
   try
   {
@@ -164,12 +169,6 @@ void JetFlavorAssociation::Init()
     fParticleLHEFInputArray = 0;
   }
 
-  if(fParticleLHEFInputArray)
-  {
-    fItParticleLHEFInputArray = fParticleLHEFInputArray->MakeIterator();
-    fParticleLHEFFilter = new ExRootFilter(fParticleLHEFInputArray);
-  }
-
   fJetInputArray = ImportArray(GetString("JetInputArray", "FastJetFinder/jets"));
   fItJetInputArray = fJetInputArray->MakeIterator();
 }
@@ -178,13 +177,7 @@ void JetFlavorAssociation::Init()
 
 void JetFlavorAssociation::Finish()
 {
-  if(fPartonFilter) delete fPartonFilter;
-  if(fParticleLHEFFilter) delete fParticleLHEFFilter;
-
   if(fItJetInputArray) delete fItJetInputArray;
-  if(fItParticleLHEFInputArray) delete fItParticleLHEFInputArray;
-  if(fItParticleInputArray) delete fItParticleInputArray;
-  if(fItPartonInputArray) delete fItPartonInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -192,64 +185,75 @@ void JetFlavorAssociation::Finish()
 void JetFlavorAssociation::Process(){
 
   Candidate *jet;
-  TObjArray *partonArray = 0;
-  TObjArray *partonLHEFArray = 0;
+
+  fPartons = GetKinematics(fPartonInputArray);
+  fPartonsLHEF = fParticleLHEFInputArray ? GetKinematics(fParticleLHEFInputArray) : 0;
 
   // select quark and gluons
-  fPartonFilter->Reset();
-  partonArray = fPartonFilter->GetSubArray(fPartonClassifier, 0); // get the filtered parton array
-  if(partonArray == 0) return;
+  if(!SelectPartons()) return;
 
-  if(fParticleLHEFInputArray) 
-  {
-    fParticleLHEFFilter->Reset();
-    partonLHEFArray = fParticleLHEFFilter->GetSubArray(fParticleLHEFClassifier, 0); // get the filtered parton array
-  }
   // loop over all input jets
   fItJetInputArray->Reset();
   while((jet = static_cast<Candidate *>(fItJetInputArray->Next())))
   {
     // get standard flavor
-    GetAlgoFlavor(jet, partonArray, partonLHEFArray);
-    if(fParticleLHEFInputArray) GetPhysicsFlavor(jet, partonArray, partonLHEFArray);
+    GetAlgoFlavor(jet);
+    if(fParticleLHEFInputArray) GetPhysicsFlavor(jet);
   }
 }
 
 //------------------------------------------------------------------------------
-// Standard definition of jet flavor in
-// https://cmssdt.cern.ch/SDT/lxr/source/PhysicsTools/JetMCAlgos/plugins/JetPartonMatcher.cc?v=CMSSW_7_3_0_pre1
+// Flags the selected partons and the partons that can give the jet flavor,
+// the flags don't depend on the jet and are computed once per event.
+// Returns false if no parton is selected.
 
-void JetFlavorAssociation::GetAlgoFlavor(Candidate *jet, TObjArray *partonArray, TObjArray *partonLHEFArray)
+Bool_t JetFlavorAssociation::SelectPartons()
 {
-  float maxPt = 0;
-  int daughterCounter = 0;
   Candidate *parton, *partonLHEF;
-  Candidate *tempParton = 0, *tempPartonHighestPt = 0;
-  int pdgCode, pdgCodeMax = -1;
-  
-  TIter itPartonArray(partonArray);
-  TIter itPartonLHEFArray(partonLHEFArray);
+  Int_t i, j, size, sizeLHEF;
+  int daughterCounter, daughterFlavor1, daughterFlavor2;
+  bool isGoodCandidate, found = false;
+
+  size = fPartons->GetSize();
+  fPartonFlags.assign(size, 0);
 
-  itPartonArray.Reset();
-  while((parton = static_cast<Candidate *>(itPartonArray.Next())))
+  for(i = 0; i < size; ++i)
   {
-    // default delphes method
-    pdgCode = TMath::Abs(parton->PID);
-    if(TMath::Abs(parton->PID) == 21) pdgCode = 0;
-    if(jet->Momentum.DeltaR(parton->Momentum) <= fDeltaR)
-    {
-      if(pdgCodeMax < pdgCode) pdgCodeMax = pdgCode;
-    }
- 
-    if(!fParticleLHEFInputArray) continue;
- 
-    itPartonLHEFArray.Reset();
-    while((partonLHEF = static_cast<Candidate *>(itPartonLHEFArray.Next())))
+    parton = fPartons->GetCandidate(i);
+    if(!parton || fPartonClassifier->GetCategory(parton) != 0) continue;
+    fPartonFlags[i] = kSelected;
+    found = true;
+  }
+
+  if(!found) return kFALSE;
+
+  if(!fPartonsLHEF) return kTRUE;
+
+  sizeLHEF = fPartonsLHEF->GetSize();
+  fPartonLHEFFlags.assign(sizeLHEF, 0);
+
+  for(j = 0; j < sizeLHEF; ++j)
+  {
+    partonLHEF = fPartonsLHEF->GetCandidate(j);
+    if(!partonLHEF || fParticleLHEFClassifier->GetCategory(partonLHEF) != 0) continue;
+    fPartonLHEFFlags[j] = kSelected;
+  }
+
+  // partons that can give the algorithmic flavor
+  for(i = 0; i < size; ++i)
+  {
+    if(!(fPartonFlags[i] & kSelected)) continue;
+    parton = fPartons->GetCandidate(i);
+
+    for(j = 0; j < sizeLHEF; ++j)
     {
+      if(!(fPartonLHEFFlags[j] & kSelected)) continue;
+      partonLHEF = fPartonsLHEF->GetCandidate(j);
+
       if(parton->Momentum.DeltaR(partonLHEF->Momentum) < 0.001 &&
          parton->PID == partonLHEF->PID &&
          partonLHEF->Charge == parton->Charge)
-      {      
+      {
          break;
       }
 
@@ -258,26 +262,94 @@ void JetFlavorAssociation::GetAlgoFlavor(Candidate *jet, TObjArray *partonArray,
       if(parton->D1 != -1 || parton->D2 != -1)
       {
         // partons are only quarks || gluons
-        int daughterFlavor1 = -1;
-        int daughterFlavor2 = -1;
+        daughterFlavor1 = -1;
+        daughterFlavor2 = -1;
         if(parton->D1 != -1) daughterFlavor1 = TMath::Abs(static_cast<Candidate *>(fParticleInputArray->At(parton->D1))->PID);
         if(parton->D2 != -1) daughterFlavor2 = TMath::Abs(static_cast<Candidate *>(fParticleInputArray->At(parton->D2))->PID);
         if((daughterFlavor1 == 1 || daughterFlavor1 == 2 || daughterFlavor1 == 3 || daughterFlavor1 == 4 || daughterFlavor1 == 5 || daughterFlavor1 == 21)) daughterCounter++;
         if((daughterFlavor2 == 1 || daughterFlavor2 == 2 || daughterFlavor2 == 3 || daughterFlavor2 == 4 || daughterFlavor1 == 5 || daughterFlavor2 == 21)) daughterCounter++;
       }
       if(daughterCounter > 0) continue;
-      if(jet->Momentum.DeltaR(parton->Momentum) <= fDeltaR)
+
+      fPartonFlags[i] |= kAlgoCandidate;
+      break;
+    }
+  }
+
+  // partons that can contaminate the physics flavor,
+  // the iteration over the LHEF partons continues from one parton to the next
+  j = 0;
+  for(i = 0; i < size; ++i)
+  {
+    if(!(fPartonFlags[i] & kSelected)) continue;
+    parton = fPartons->GetCandidate(i);
+
+    isGoodCandidate = true;
+    while(j < sizeLHEF)
+    {
+      partonLHEF = fPartonsLHEF->GetCandidate(j++);
+      if(!(fPartonLHEFFlags[j - 1] & kSelected)) continue;
+
+      if(parton->Momentum.DeltaR(partonLHEF->Momentum) < 0.01 &&
+         parton->PID == partonLHEF->PID &&
+         partonLHEF->Charge == parton->Charge)
       {
-        // if not yet found && pdgId is a c, take as c
-        if(TMath::Abs(parton->PID) == 4) tempParton = parton;
-        if(TMath::Abs(parton->PID) == 5) tempParton = parton;
-        if(parton->Momentum.Pt() > maxPt)
-        {
-          maxPt = parton->Momentum.Pt();
-          tempPartonHighestPt = parton;
-        }
+        isGoodCandidate = false;
+        break;
       }
     }
+
+    if(!isGoodCandidate) continue;
+
+    if(parton->D1 != -1 || parton->D2 != -1)
+    {
+      if((TMath::Abs(parton->PID) < 4 || TMath::Abs(parton->PID) == 21)) continue;
+      fPartonFlags[i] |= kContamination;
+    }
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+// Standard definition of jet flavor in
+// https://cmssdt.cern.ch/SDT/lxr/source/PhysicsTools/JetMCAlgos/plugins/JetPartonMatcher.cc?v=CMSSW_7_3_0_pre1
+
+void JetFlavorAssociation::GetAlgoFlavor(Candidate *jet)
+{
+  float maxPt = 0;
+  Candidate *parton;
+  Candidate *tempParton = 0, *tempPartonHighestPt = 0;
+  int pdgCode, pdgCodeMax = -1;
+  Int_t i, entry;
+
+  const TLorentzVector &jetMomentum = jet->Momentum;
+
+  // loop over all partons in the cone, in the order of the parton array
+  fCone.clear();
+  fPartons->Query(jetMomentum.Eta(), jetMomentum.Phi(), fDeltaR, fCone);
+
+  for(i = 0; i < Int_t(fCone.size()); ++i)
+  {
+    entry = fCone[i];
+    if(!(fPartonFlags[entry] & kSelected)) continue;
+    parton = fPartons->GetCandidate(entry);
+
+    // default delphes method
+    pdgCode = TMath::Abs(parton->PID);
+    if(TMath::Abs(parton->PID) == 21) pdgCode = 0;
+    if(pdgCodeMax < pdgCode) pdgCodeMax = pdgCode;
+
+    if(!(fPartonFlags[entry] & kAlgoCandidate)) continue;
+
+    // if not yet found && pdgId is a c, take as c
+    if(TMath::Abs(parton->PID) == 4) tempParton = parton;
+    if(TMath::Abs(parton->PID) == 5) tempParton = parton;
+    if(fPartons->GetPT(entry) > maxPt)
+    {
+      maxPt = fPartons->GetPT(entry);
+      tempPartonHighestPt = parton;
+    }
   }
 
   if(!tempParton) tempParton = tempPartonHighestPt;
@@ -291,60 +363,46 @@ void JetFlavorAssociation::GetAlgoFlavor(Candidate *jet, TObjArray *partonArray,
 
 //------------------------------------------------------------------------------
 
-void JetFlavorAssociation::GetPhysicsFlavor(Candidate *jet, TObjArray *partonArray, TObjArray *partonLHEFArray)
+void JetFlavorAssociation::GetPhysicsFlavor(Candidate *jet)
 {
   int partonCounter = 0;
   float biggerConeSize = 0.7;
-  float dist;
-  bool isGoodCandidate;
   int contaminatingFlavor = 0;
   int motherCounter = 0;
   Candidate *parton, *partonLHEF, *mother1, *mother2;
   Candidate *tempParton = 0;
   vector<Candidate *> contaminations;
   vector<Candidate *>::iterator itContaminations;
+  Int_t i, entry;
 
-  TIter itPartonArray(partonArray);
-  TIter itPartonLHEFArray(partonLHEFArray);
+  const TLorentzVector &jetMomentum = jet->Momentum;
 
   contaminations.clear();
 
-  itPartonLHEFArray.Reset();
-  while((partonLHEF = static_cast<Candidate *>(itPartonLHEFArray.Next())))
+  fCone.clear();
+  fPartonsLHEF->Query(jetMomentum.Eta(), jetMomentum.Phi(), fDeltaR, fCone);
+
+  for(i = 0; i < Int_t(fCone.size()); ++i)
   {
-    dist = jet->Momentum.DeltaR(partonLHEF->Momentum); // take the DR
+    entry = fCone[i];
+    if(!(fPartonLHEFFlags[entry] & kSelected)) continue;
+    partonLHEF = fPartonsLHEF->GetCandidate(entry);
 
-    if(partonLHEF->Status == 1 && dist <= fDeltaR)
+    if(partonLHEF->Status == 1)
     {
       tempParton = partonLHEF;
       partonCounter++;
     }
   }
 
-  itPartonArray.Reset();
-  itPartonLHEFArray.Reset();
-  while((parton = static_cast<Candidate *>(itPartonArray.Next())))
-  {
-    dist = jet->Momentum.DeltaR(parton->Momentum); // take the DR
-    isGoodCandidate = true;
-    while((partonLHEF = static_cast<Candidate *>(itPartonLHEFArray.Next())))
-    {
-      if(parton->Momentum.DeltaR(partonLHEF->Momentum) < 0.01 &&
-         parton->PID == partonLHEF->PID &&
-         partonLHEF->Charge == parton->Charge)
-      {
-        isGoodCandidate = false;
-        break;
-      }
-    }
-
-    if(!isGoodCandidate) continue;
+  fCone.clear();
+  fPartons->Query(jetMomentum.Eta(), jetMomentum.Phi(), biggerConeSize, fCone);
 
-    if(parton->D1 != -1 || parton->D2 != -1)
-    {
-      if((TMath::Abs(parton->PID) < 4 || TMath::Abs(parton->PID) == 21)) continue;
-      if(dist < biggerConeSize) contaminations.push_back(parton);
-    }
+  for(i = 0; i < Int_t(fCone.size()); ++i)
+  {
+    entry = fCone[i];
+    if(!(fPartonFlags[entry] & kContamination)) continue;
+    contaminations.push_back(fPartons->GetCandidate(entry));
   }
 
   if(partonCounter != 1)
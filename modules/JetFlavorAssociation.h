@@ -30,11 +30,12 @@
 #include "classes/DelphesModule.h"
 #include "classes/DelphesClasses.h"
 #include <map>
+#include <vector>
 
 class TObjArray;
 class DelphesFormula;
+class DelphesEtaPhiIndex;
 
-class ExRootFilter;
 class PartonClassifier;
 class ParticleLHEFClassifier;
 
@@ -49,22 +50,28 @@ public:
   void Process();
   void Finish();
 
-  void GetAlgoFlavor(Candidate *jet, TObjArray *partonArray, TObjArray *partonLHEFArray);
-  void GetPhysicsFlavor(Candidate *jet, TObjArray *partonArray, TObjArray *partonLHEFArray);
+  void GetAlgoFlavor(Candidate *jet);
+  void GetPhysicsFlavor(Candidate *jet);
 
 private:
 
+  Bool_t SelectPartons();
+
   Double_t fDeltaR;
 
   PartonClassifier *fPartonClassifier; //!
   ParticleLHEFClassifier *fParticleLHEFClassifier; //!
 
-  ExRootFilter *fPartonFilter;
-  ExRootFilter *fParticleLHEFFilter;
+  // indices shared with the other modules reading the same arrays
+  DelphesEtaPhiIndex *fPartons; //!
+  DelphesEtaPhiIndex *fPartonsLHEF; //!
+
+  // flags of the partons in fPartons and fPartonsLHEF, computed once per event
+  std::vector< Char_t > fPartonFlags; //!
+  std::vector< Char_t > fPartonLHEFFlags; //!
+
+  std::vector< Int_t > fCone; //!
 
-  TIterator *fItPartonInputArray; //!
-  TIterator *fItParticleInputArray; //!
-  TIterator *fItParticleLHEFInputArray; //!
   TIterator *fItJetInputArray; //!
 
   const TObjArray *fPartonInputArray; //!
@@ -30,6 +30,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEtaPhiIndex.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -53,7 +54,7 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 LeptonDressing::LeptonDressing() :
- fItDressingInputArray(0), fItCandidateInputArray(0)
+ fItCandidateInputArray(0)
 {
 }
 
@@ -72,7 +73,6 @@ void LeptonDressing::Init()
   // import input array(s)
 
   fDressingInputArray = ImportArray(GetString("DressingInputArray", "Calorimeter/photons"));
-  fItDressingInputArray = fDressingInputArray->MakeIterator();
   
   fCandidateInputArray = ImportArray(GetString("CandidateInputArray", "UniqueObjectFinder/electrons"));
   fItCandidateInputArray = fCandidateInputArray->MakeIterator();
@@ -87,34 +87,35 @@ void LeptonDressing::Init()
 void LeptonDressing::Finish()
 {
   if(fItCandidateInputArray) delete fItCandidateInputArray;
-  if(fItDressingInputArray) delete fItDressingInputArray;
 }
 
 //------------------------------------------------------------------------------
 
 void LeptonDressing::Process()
 {
-  Candidate *candidate, *dressing, *mother;
+  Candidate *candidate, *mother;
+  DelphesEtaPhiIndex *dressings;
   TLorentzVector momentum;
-  
+  Int_t i;
+
+  dressings = GetKinematics(fDressingInputArray);
+
   // loop over all input candidate
   fItCandidateInputArray->Reset();
   while((candidate = static_cast<Candidate*>(fItCandidateInputArray->Next())))
   {
     const TLorentzVector &candidateMomentum = candidate->Momentum;
 
-    // loop over all input tracks
-    fItDressingInputArray->Reset();
+    // loop over all input tracks in the cone
+    fCone.clear();
+    dressings->Query(candidateMomentum.Eta(), candidateMomentum.Phi(), fDeltaR, fCone);
+
     momentum.SetPxPyPzE(0.0, 0.0, 0.0, 0.0);
-    while((dressing = static_cast<Candidate*>(fItDressingInputArray->Next())))
+    for(i = 0; i < Int_t(fCone.size()); ++i)
     {
-      const TLorentzVector &dressingMomentum = dressing->Momentum;
-      if (dressingMomentum.Pt() > 0.1)
+      if(dressings->GetPT(fCone[i]) > 0.1)
       {
-        if(candidateMomentum.DeltaR(dressingMomentum) <= fDeltaR)
-        {
-          momentum += dressingMomentum;
-        }
+        momentum += dressings->GetCandidate(fCone[i])->Momentum;
       }
     }
 
@@ -27,6 +27,8 @@
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TIterator;
 class TObjArray;
 
@@ -45,8 +47,8 @@ private:
 
   Double_t fDeltaR;
   
-  TIterator *fItDressingInputArray; //!
-  
+  std::vector< Int_t > fCone; //!
+
   TIterator *fItCandidateInputArray; //!
 
   const TObjArray *fDressingInputArray; //!
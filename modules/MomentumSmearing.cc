@@ -108,7 +108,7 @@ void MomentumSmearing::Process()
     e = candidateMomentum.E();
 
     // apply smearing formula
-    pt = gRandom->Gaus(pt, fFormula->Eval(pt, eta, phi, e) * pt);
+    pt = GetRandom()->Gaus(pt, fFormula->Eval(pt, eta, phi, e) * pt);
     
     if(pt <= 0.0) continue;
 
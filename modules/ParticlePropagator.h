@@ -32,9 +32,14 @@
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TClonesArray;
 class TIterator;
 
+class Candidate;
+class DelphesPropagationBatch;
+
 class ParticlePropagator: public DelphesModule
 {
 public:
@@ -51,6 +56,10 @@ private:
   Double_t fRadius, fRadius2, fHalfLength;
   Double_t fBz;
 
+  DelphesPropagationBatch *fBatch; //!
+
+  std::vector< Candidate * > fCandidates; //!
+
   TIterator *fItInputArray; //!
 
   const TObjArray *fInputArray; //!
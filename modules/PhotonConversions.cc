@@ -219,7 +219,7 @@ void PhotonConversions::Process()
         p_conv = 1 - TMath::Exp(-7.0/9.0*fStep*rate);
 
         // case conversion occurs
-        if(gRandom->Uniform() < p_conv)
+        if(GetRandom()->Uniform() < p_conv)
         {
           converted = true;
 
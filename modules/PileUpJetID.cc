@@ -170,22 +170,22 @@ void PileUpJetID::Process()
             tow_sumW += w;
 	  } else {
 	    sumT0 += w*constituent->ECalEnergyTimePairs[i].second;
-	    sumT1 += w*gRandom->Gaus(constituent->ECalEnergyTimePairs[i].second,0.001);
-	    sumT10 += w*gRandom->Gaus(constituent->ECalEnergyTimePairs[i].second,0.010);
-	    sumT20 += w*gRandom->Gaus(constituent->ECalEnergyTimePairs[i].second,0.020);
-	    sumT30 += w*gRandom->Gaus(constituent->ECalEnergyTimePairs[i].second,0.030);
-	    sumT40 += w*gRandom->Gaus(constituent->ECalEnergyTimePairs[i].second,0.040);
+	    sumT1 += w*GetRandom()->Gaus(constituent->ECalEnergyTimePairs[i].second,0.001);
+	    sumT10 += w*GetRandom()->Gaus(constituent->ECalEnergyTimePairs[i].second,0.010);
+	    sumT20 += w*GetRandom()->Gaus(constituent->ECalEnergyTimePairs[i].second,0.020);
+	    sumT30 += w*GetRandom()->Gaus(constituent->ECalEnergyTimePairs[i].second,0.030);
+	    sumT40 += w*GetRandom()->Gaus(constituent->ECalEnergyTimePairs[i].second,0.040);
 	    sumWeightsForT += w;
 	    candidate->NTimeHits++;
 	  }
 	}
 	if (fAverageEachTower && tow_sumW > 0.) {
 	  sumT0 += tow_sumT;
-	  sumT1 += tow_sumW*gRandom->Gaus(tow_sumT/tow_sumW,0.001);
-          sumT10 += tow_sumW*gRandom->Gaus(tow_sumT/tow_sumW,0.0010);
-          sumT20 += tow_sumW*gRandom->Gaus(tow_sumT/tow_sumW,0.0020);
-          sumT30 += tow_sumW*gRandom->Gaus(tow_sumT/tow_sumW,0.0030);
-          sumT40 += tow_sumW*gRandom->Gaus(tow_sumT/tow_sumW,0.0040);
+	  sumT1 += tow_sumW*GetRandom()->Gaus(tow_sumT/tow_sumW,0.001);
+          sumT10 += tow_sumW*GetRandom()->Gaus(tow_sumT/tow_sumW,0.0010);
+          sumT20 += tow_sumW*GetRandom()->Gaus(tow_sumT/tow_sumW,0.0020);
+          sumT30 += tow_sumW*GetRandom()->Gaus(tow_sumT/tow_sumW,0.0030);
+          sumT40 += tow_sumW*GetRandom()->Gaus(tow_sumT/tow_sumW,0.0040);
 	  sumWeightsForT += tow_sumW;
 	  candidate->NTimeHits++;
 	}
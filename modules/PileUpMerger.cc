@@ -30,6 +30,8 @@
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesTF2.h"
 #include "classes/DelphesPileUpReader.h"
+#include "classes/DelphesPDGTable.h"
+#include "classes/DelphesThreadPool.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -50,10 +52,48 @@
 
 using namespace std;
 
+struct PileUpVertex
+{
+  Long64_t entry;
+  Double_t dz, dt, dphi;
+
+  DelphesPileUpEntry particles;
+  const Int_t *charges;
+  const Double_t *masses;
+
+  // index of the first particle in the candidate list
+  Long64_t first;
+  Candidate *vertex;
+
+  Float_t vx, vy;
+};
+
+//------------------------------------------------------------------------------
+
+class PileUpMergerTask: public DelphesThreadTask
+{
+public:
+
+  PileUpMergerTask(PileUpMerger *merger) : fMerger(merger) {}
+
+  void Execute(Int_t begin, Int_t end, Int_t thread)
+  {
+    Int_t i;
+    for(i = begin; i < end; ++i) fMerger->FillVertex(fVertices[i], thread);
+  }
+
+  vector< PileUpVertex > fVertices;
+  vector< Candidate * > fCandidates;
+
+private:
+
+  PileUpMerger *fMerger;
+};
+
 //------------------------------------------------------------------------------
 
 PileUpMerger::PileUpMerger() :
-  fFunction(0), fReader(0), fItInputArray(0)
+  fFunction(0), fReader(0), fPDGTable(0), fThreadPool(0), fTask(0), fItInputArray(0)
 {
   fFunction = new DelphesTF2;
 }
@@ -84,6 +124,12 @@ void PileUpMerger::Init()
   fOutputBeamSpotX = GetDouble("OutputBeamSpotX", 0.0);
   fOutputBeamSpotY = GetDouble("OutputBeamSpotY", 0.0);
 
+  // number of pile-up events to keep in memory, 0 to read them from file
+  fPreloadPileUp = GetInt("PreloadPileUp", 0);
+
+  // number of threads used to fill pile-up particles
+  fNumberOfThreads = GetInt("NumberOfThreads", 1);
+
   // read vertex smearing formula
 
   fFunction->Compile(GetString("VertexDistributionFormula", "0.0"));
@@ -92,6 +138,19 @@ void PileUpMerger::Init()
   fileName = GetString("PileUpFile", "MinBias.pileup");
   fReader = new DelphesPileUpReader(fileName);
 
+  fPDGTable = new DelphesPDGTable;
+
+  if(fPreloadPileUp > 0) PreloadPileUp();
+
+  if(fNumberOfThreads > 1 && fReader && !fReader->IsMapped())
+  {
+    throw runtime_error("NumberOfThreads > 1 requires PreloadPileUp or a columnar pile-up file");
+  }
+
+  fBuffers.resize(4*max(fNumberOfThreads, 1));
+
+  fTask = new PileUpMergerTask(this);
+
   // import input array
   fInputArray = ImportArray(GetString("InputArray", "Delphes/stableParticles"));
   fItInputArray = fInputArray->MakeIterator();
@@ -105,23 +164,213 @@ void PileUpMerger::Init()
 
 void PileUpMerger::Finish()
 {
+  if(fThreadPool) delete fThreadPool;
+  if(fTask) delete fTask;
   if(fReader) delete fReader;
+  if(fPDGTable) delete fPDGTable;
+}
+
+//------------------------------------------------------------------------------
+
+void PileUpMerger::PreloadPileUp()
+{
+  DelphesPileUpEntry particles;
+  Long64_t entry, allEntries;
+  Int_t i, charge;
+  Double_t mass;
+
+  allEntries = min(Long64_t(fPreloadPileUp), Long64_t(fReader->GetEntries()));
+
+  fPreloadOffsets.assign(1, 0);
+
+  for(entry = 0; entry < allEntries; ++entry)
+  {
+    fReader->ReadEntry(entry, particles);
+
+    fPreloadPID.insert(fPreloadPID.end(), particles.pid, particles.pid + particles.size);
+    fPreloadColumns[0].insert(fPreloadColumns[0].end(), particles.x, particles.x + particles.size);
+    fPreloadColumns[1].insert(fPreloadColumns[1].end(), particles.y, particles.y + particles.size);
+    fPreloadColumns[2].insert(fPreloadColumns[2].end(), particles.z, particles.z + particles.size);
+    fPreloadColumns[3].insert(fPreloadColumns[3].end(), particles.t, particles.t + particles.size);
+    fPreloadColumns[4].insert(fPreloadColumns[4].end(), particles.px, particles.px + particles.size);
+    fPreloadColumns[5].insert(fPreloadColumns[5].end(), particles.py, particles.py + particles.size);
+    fPreloadColumns[6].insert(fPreloadColumns[6].end(), particles.pz, particles.pz + particles.size);
+    fPreloadColumns[7].insert(fPreloadColumns[7].end(), particles.e, particles.e + particles.size);
+
+    // resolve charges and masses once
+    for(i = 0; i < particles.size; ++i)
+    {
+      fPDGTable->GetParticle(particles.pid[i], charge, mass);
+      fPreloadCharges.push_back(charge);
+      fPreloadMasses.push_back(mass);
+    }
+
+    fPreloadOffsets.push_back(fPreloadPID.size());
+  }
+
+  // all events are in memory now
+  delete fReader;
+  fReader = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void PileUpMerger::ReadPileUpEntry(Long64_t entry, DelphesPileUpEntry &particles, const Int_t *&charges, const Double_t *&masses)
+{
+  Long64_t offset;
+
+  // charges and masses of particles read from file are looked up while filling candidates
+  charges = 0;
+  masses = 0;
+
+  if(fReader)
+  {
+    fReader->ReadEntry(entry, particles);
+    return;
+  }
+
+  offset = fPreloadOffsets[entry];
+  particles.size = fPreloadOffsets[entry + 1] - offset;
+  if(particles.size == 0) return;
+
+  particles.pid = &fPreloadPID[offset];
+  particles.x = &fPreloadColumns[0][offset];
+  particles.y = &fPreloadColumns[1][offset];
+  particles.z = &fPreloadColumns[2][offset];
+  particles.t = &fPreloadColumns[3][offset];
+  particles.px = &fPreloadColumns[4][offset];
+  particles.py = &fPreloadColumns[5][offset];
+  particles.pz = &fPreloadColumns[6][offset];
+  particles.e = &fPreloadColumns[7][offset];
+
+  charges = &fPreloadCharges[offset];
+  masses = &fPreloadMasses[offset];
+}
+
+//------------------------------------------------------------------------------
+
+void PileUpMerger::AllocateVertex(PileUpVertex &vertex)
+{
+  DelphesFactory *factory = GetFactory();
+  vector< Candidate * > &candidates = fTask->fCandidates;
+  Int_t i;
+
+  // candidates are created in the same order for any number of threads
+  vertex.first = candidates.size();
+  for(i = 0; i < vertex.particles.size; ++i)
+  {
+    candidates.push_back(factory->NewCandidate());
+  }
+  vertex.vertex = factory->NewCandidate();
+}
+
+//------------------------------------------------------------------------------
+
+void PileUpMerger::FillVertex(PileUpVertex &vertex, Int_t thread)
+{
+  const DelphesPileUpEntry &particles = vertex.particles;
+  Candidate *candidate;
+  Int_t i, charge;
+  Float_t x, y, px, py;
+  Double_t mass, sinPhi, cosPhi;
+  Double_t *rotatedPx, *rotatedPy, *rotatedX, *rotatedY;
+
+  // rotate momenta and positions of all particles in one pass
+  sinPhi = TMath::Sin(vertex.dphi);
+  cosPhi = TMath::Cos(vertex.dphi);
+
+  for(i = 0; i < 4; ++i) fBuffers[4*thread + i].resize(particles.size + 1);
+  rotatedPx = &fBuffers[4*thread][0];
+  rotatedPy = &fBuffers[4*thread + 1][0];
+  rotatedX = &fBuffers[4*thread + 2][0];
+  rotatedY = &fBuffers[4*thread + 3][0];
+
+  for(i = 0; i < particles.size; ++i)
+  {
+    px = particles.px[i];
+    py = particles.py[i];
+    rotatedPx[i] = cosPhi*px - sinPhi*py;
+    rotatedPy[i] = sinPhi*px + cosPhi*py;
+
+    x = particles.x[i] - fInputBeamSpotX;
+    y = particles.y[i] - fInputBeamSpotY;
+    rotatedX[i] = cosPhi*x - sinPhi*y + fOutputBeamSpotX;
+    rotatedY[i] = sinPhi*x + cosPhi*y + fOutputBeamSpotY;
+  }
+
+  vertex.vx = 0.0;
+  vertex.vy = 0.0;
+  for(i = 0; i < particles.size; ++i)
+  {
+    candidate = fTask->fCandidates[vertex.first + i];
+
+    candidate->PID = particles.pid[i];
+
+    candidate->Status = 1;
+
+    if(vertex.charges)
+    {
+      charge = vertex.charges[i];
+      mass = vertex.masses[i];
+    }
+    else
+    {
+      fPDGTable->GetParticle(particles.pid[i], charge, mass);
+    }
+
+    candidate->Charge = charge;
+    candidate->Mass = mass;
+
+    candidate->IsPU = 1;
+
+    candidate->Momentum.SetPxPyPzE(rotatedPx[i], rotatedPy[i], particles.pz[i], particles.e[i]);
+
+    candidate->Position.SetXYZT(rotatedX[i], rotatedY[i], particles.z[i] + vertex.dz, particles.t[i] + vertex.dt);
+
+    vertex.vx += candidate->Position.X();
+    vertex.vy += candidate->Position.Y();
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void PileUpMerger::AddVertex(PileUpVertex &vertex)
+{
+  Int_t i, numberOfParticles;
+  Float_t vx, vy;
+
+  numberOfParticles = vertex.particles.size;
+  for(i = 0; i < numberOfParticles; ++i)
+  {
+    fParticleOutputArray->Add(fTask->fCandidates[vertex.first + i]);
+  }
+
+  vx = vertex.vx;
+  vy = vertex.vy;
+
+  if(numberOfParticles > 0)
+  {
+    vx /= numberOfParticles;
+    vy /= numberOfParticles;
+  }
+
+  vertex.vertex->Position.SetXYZT(vx, vy, vertex.dz, vertex.dt);
+  vertex.vertex->IsPU = 1;
+
+  fVertexOutputArray->Add(vertex.vertex);
 }
 
 //------------------------------------------------------------------------------
 
 void PileUpMerger::Process()
 {
-  TDatabasePDG *pdg = TDatabasePDG::Instance();
-  TParticlePDG *pdgParticle;
-  Int_t pid;
-  Float_t x, y, z, t, vx, vy;
-  Float_t px, py, pz, e;
-  Double_t dz, dphi, dt;
+  Float_t z, t, vx, vy;
+  Double_t dz, dt;
   Int_t numberOfEvents, event, numberOfParticles;
   Long64_t allEntries, entry;
   Candidate *candidate, *vertex;
   DelphesFactory *factory;
+  vector< PileUpVertex > &vertices = fTask->fVertices;
 
   const Double_t c_light = 2.99792458E8;
 
@@ -164,27 +413,32 @@ void PileUpMerger::Process()
   switch(fPileUpDistribution)
   {
     case 0:
-      numberOfEvents = gRandom->Poisson(fMeanPileUp);
+      numberOfEvents = GetRandom()->Poisson(fMeanPileUp);
       break;
     case 1:
-      numberOfEvents = gRandom->Integer(2*fMeanPileUp + 1);
+      numberOfEvents = GetRandom()->Integer(2*fMeanPileUp + 1);
       break;
     default:
-      numberOfEvents = gRandom->Poisson(fMeanPileUp);
+      numberOfEvents = GetRandom()->Poisson(fMeanPileUp);
       break;
   }
 
-  allEntries = fReader->GetEntries();
+  allEntries = fReader ? fReader->GetEntries() : Long64_t(fPreloadOffsets.size() - 1);
 
+  // draw all pile-up vertices first,
+  // random numbers don't depend on the number of threads
+  vertices.resize(numberOfEvents);
   for(event = 0; event < numberOfEvents; ++event)
   {
+    PileUpVertex &pileUpVertex = vertices[event];
+
     do
     {
-      entry = TMath::Nint(gRandom->Rndm()*allEntries);
+      entry = TMath::Nint(GetRandom()->Rndm()*allEntries);
     }
     while(entry >= allEntries);
 
-    fReader->ReadEntry(entry);
+    pileUpVertex.entry = entry;
 
    // --- Pile-up vertex smearing
 
@@ -193,52 +447,47 @@ void PileUpMerger::Process()
     dt *= c_light*1.0E3; // necessary in order to make t in mm/c
     dz *= 1.0E3; // necessary in order to make z in mm
 
-    dphi = gRandom->Uniform(-TMath::Pi(), TMath::Pi());
-
-    vx = 0.0;
-    vy = 0.0;
-    numberOfParticles = 0;
-    while(fReader->ReadParticle(pid, x, y, z, t, px, py, pz, e))
-    {
-      candidate = factory->NewCandidate();
-
-      candidate->PID = pid;
-
-      candidate->Status = 1;
-
-      pdgParticle = pdg->GetParticle(pid);
-      candidate->Charge = pdgParticle ? Int_t(pdgParticle->Charge()/3.0) : -999;
-      candidate->Mass = pdgParticle ? pdgParticle->Mass() : -999.9;
+    pileUpVertex.dz = dz;
+    pileUpVertex.dt = dt;
 
-      candidate->IsPU = 1;
-
-      candidate->Momentum.SetPxPyPzE(px, py, pz, e);
-      candidate->Momentum.RotateZ(dphi);
-
-      x -= fInputBeamSpotX;
-      y -= fInputBeamSpotY;
-      candidate->Position.SetXYZT(x, y, z + dz, t + dt);
-      candidate->Position.RotateZ(dphi);
-      candidate->Position += TLorentzVector(fOutputBeamSpotX, fOutputBeamSpotY, 0.0, 0.0);
+    pileUpVertex.dphi = GetRandom()->Uniform(-TMath::Pi(), TMath::Pi());
+  }
 
-      vx += candidate->Position.X();
-      vy += candidate->Position.Y();
-      ++numberOfParticles;
+  // threads are started with the first event, after the event loop processes are forked
+  if(fNumberOfThreads > 1 && !fThreadPool)
+  {
+    fThreadPool = new DelphesThreadPool(fNumberOfThreads);
+  }
 
-      fParticleOutputArray->Add(candidate);
-    }
+  fTask->fCandidates.clear();
 
-    if(numberOfParticles > 0)
+  if(!fThreadPool)
+  {
+    // particles read from XDR files are only valid until the next entry is read
+    for(event = 0; event < numberOfEvents; ++event)
     {
-      vx /= numberOfParticles;
-      vy /= numberOfParticles;
+      PileUpVertex &pileUpVertex = vertices[event];
+      ReadPileUpEntry(pileUpVertex.entry, pileUpVertex.particles, pileUpVertex.charges, pileUpVertex.masses);
+      AllocateVertex(pileUpVertex);
+      FillVertex(pileUpVertex, 0);
+      AddVertex(pileUpVertex);
     }
+    return;
+  }
 
-    vertex = factory->NewCandidate();
-    vertex->Position.SetXYZT(vx, vy, dz, dt);
-    vertex->IsPU = 1;
+  for(event = 0; event < numberOfEvents; ++event)
+  {
+    PileUpVertex &pileUpVertex = vertices[event];
+    ReadPileUpEntry(pileUpVertex.entry, pileUpVertex.particles, pileUpVertex.charges, pileUpVertex.masses);
+    AllocateVertex(pileUpVertex);
+  }
 
-    fVertexOutputArray->Add(vertex);
+  // vertices are filled in parallel and added in their original order
+  fThreadPool->Run(fTask, numberOfEvents);
+
+  for(event = 0; event < numberOfEvents; ++event)
+  {
+    AddVertex(vertices[event]);
   }
 }
 
@@ -29,9 +29,17 @@
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TObjArray;
 class DelphesPileUpReader;
+class DelphesPDGTable;
+class DelphesThreadPool;
 class DelphesTF2;
+class PileUpMergerTask;
+
+struct DelphesPileUpEntry;
+struct PileUpVertex;
 
 class PileUpMerger: public DelphesModule
 {
@@ -57,10 +65,36 @@ private:
   Double_t fOutputBeamSpotX;
   Double_t fOutputBeamSpotY;
 
+  Int_t fPreloadPileUp;
+
+  Int_t fNumberOfThreads;
+
+  void PreloadPileUp();
+
+  void ReadPileUpEntry(Long64_t entry, DelphesPileUpEntry &particles, const Int_t *&charges, const Double_t *&masses);
+
+  void AllocateVertex(PileUpVertex &vertex);
+  void FillVertex(PileUpVertex &vertex, Int_t thread);
+  void AddVertex(PileUpVertex &vertex);
+
   DelphesTF2 *fFunction; //!
 
   DelphesPileUpReader *fReader; //!
 
+  DelphesPDGTable *fPDGTable; //!
+
+  std::vector< Long64_t > fPreloadOffsets; //!
+  std::vector< Int_t > fPreloadPID; //!
+  std::vector< Float_t > fPreloadColumns[8]; //!
+  std::vector< Int_t > fPreloadCharges; //!
+  std::vector< Double_t > fPreloadMasses; //!
+
+  std::vector< std::vector< Double_t > > fBuffers; //!
+
+  DelphesThreadPool *fThreadPool; //!
+
+  PileUpMergerTask *fTask; //!
+
   TIterator *fItInputArray; //!
 
   const TObjArray *fInputArray; //!
@@ -68,6 +102,8 @@ private:
   TObjArray *fParticleOutputArray; //!
   TObjArray *fVertexOutputArray; //!
 
+  friend class PileUpMergerTask;
+
   ClassDef(PileUpMerger, 1)
 };
 
@@ -165,13 +165,13 @@ void PileUpMergerPythia8::Process()
   switch(fPileUpDistribution)
   {
     case 0:
-      numberOfEvents = gRandom->Poisson(fMeanPileUp);
+      numberOfEvents = GetRandom()->Poisson(fMeanPileUp);
       break;
     case 1:
-      numberOfEvents = gRandom->Integer(2*fMeanPileUp + 1);
+      numberOfEvents = GetRandom()->Integer(2*fMeanPileUp + 1);
       break;
     default:
-      numberOfEvents = gRandom->Poisson(fMeanPileUp);
+      numberOfEvents = GetRandom()->Poisson(fMeanPileUp);
       break;
   }
 
@@ -186,7 +186,7 @@ void PileUpMergerPythia8::Process()
     dt *= c_light*1.0E3; // necessary in order to make t in mm/c
     dz *= 1.0E3; // necessary in order to make z in mm
 
-    dphi = gRandom->Uniform(-TMath::Pi(), TMath::Pi());
+    dphi = GetRandom()->Uniform(-TMath::Pi(), TMath::Pi());
 
     vx = 0.0;
     vy = 0.0;
@@ -20,7 +20,8 @@ using namespace std;
 //------------------------------------------------------------------------------
 RunPUPPI::RunPUPPI() :
   fItTrackInputArray(0), 
-  fItNeutralInputArray(0)
+  fItNeutralInputArray(0),
+  fPuppi(0)
 {}
 
 //------------------------------------------------------------------------------
@@ -103,6 +104,37 @@ void RunPUPPI::Init(){
   fMetricId.clear();
   for(int iMap = 0; iMap < param.GetSize(); ++iMap) fMetricId.push_back(param[iMap].GetInt());
 
+  // Create algorithm list for puppi
+  std::vector<puppiAlgoBin> puppiAlgo;
+   if(!(fEtaMinBin.size() == fEtaMaxBin.size() and fEtaMinBin.size() == fPtMinBin.size() and fEtaMinBin.size() == fConeSizeBin.size() and fEtaMinBin.size() == fRMSPtMinBin.size()
+       and fEtaMinBin.size() == fRMSScaleFactorBin.size() and fEtaMinBin.size() == fNeutralMinEBin.size() and  fEtaMinBin.size() == fNeutralPtSlope.size() 
+       and fEtaMinBin.size() == fApplyCHS.size()  and fEtaMinBin.size() == fUseCharged.size()
+       and fEtaMinBin.size() == fApplyLowPUCorr.size() and fEtaMinBin.size() == fMetricId.size())) {
+    std::cerr<<" Error in PUPPI configuration, algo info should have the same size --> exit from the code"<<std::endl;
+    std::exit(EXIT_FAILURE);
+   } 
+
+   for( size_t iAlgo =  0 ; iAlgo < fEtaMinBin.size() ; iAlgo++){
+    puppiAlgoBin algoTmp ;
+    algoTmp.fEtaMin_ = fEtaMinBin.at(iAlgo);
+    algoTmp.fEtaMax_ = fEtaMaxBin.at(iAlgo);
+    algoTmp.fPtMin_  = fPtMinBin.at(iAlgo);
+    algoTmp.fConeSize_        = fConeSizeBin.at(iAlgo);
+    algoTmp.fRMSPtMin_        = fRMSPtMinBin.at(iAlgo);
+    algoTmp.fRMSScaleFactor_  = fRMSScaleFactorBin.at(iAlgo);
+    algoTmp.fNeutralMinE_     = fNeutralMinEBin.at(iAlgo);
+    algoTmp.fNeutralPtSlope_  = fNeutralPtSlope.at(iAlgo);
+    algoTmp.fApplyCHS_        = fApplyCHS.at(iAlgo);
+    algoTmp.fUseCharged_      = fUseCharged.at(iAlgo);
+    algoTmp.fApplyLowPUCorr_  = fApplyLowPUCorr.at(iAlgo);
+    algoTmp.fMetricId_        = fMetricId.at(iAlgo);
+    if(std::find(puppiAlgo.begin(),puppiAlgo.end(),algoTmp) != puppiAlgo.end()) continue;    
+    puppiAlgo.push_back(algoTmp);     
+   }
+
+  // Create PUPPI container
+  fPuppi = new puppiCleanContainer(puppiAlgo,fMinPuppiWeight,fUseExp);
+
   // create output array
   fOutputArray        = ExportArray(GetString("OutputArray", "puppiParticles"));
   fOutputTrackArray   = ExportArray(GetString("OutputArrayTracks", "puppiTracks"));
@@ -114,6 +146,7 @@ void RunPUPPI::Init(){
 void RunPUPPI::Finish(){
   if(fItTrackInputArray)   delete fItTrackInputArray;
   if(fItNeutralInputArray) delete fItNeutralInputArray;
+  if(fPuppi) delete fPuppi;
 }
 
 //------------------------------------------------------------------------------
@@ -130,7 +163,7 @@ void RunPUPPI::Process(){
   fItNeutralInputArray->Reset();
   fPVItInputArray->Reset();
 
-  std::vector<Candidate *> InputParticles;
+  std::vector<Candidate *> &InputParticles = fInputParticles;
   InputParticles.clear();
 
   // take the leading vertex 
@@ -139,7 +172,7 @@ void RunPUPPI::Process(){
   if (pv) PVZ = pv->Position.Z();
 
   // Fill input particles for puppi
-  std::vector<RecoObj> puppiInputVector;
+  std::vector<RecoObj> &puppiInputVector = fPuppiInputVector;
   puppiInputVector.clear();
 
   // Loop on charge track candidate
@@ -210,48 +243,19 @@ void RunPUPPI::Process(){
       InputParticles.push_back(candidate);
   }
 
-  // Create algorithm list for puppi
-  std::vector<puppiAlgoBin> puppiAlgo;
-  if(puppiAlgo.empty()){
-   if(!(fEtaMinBin.size() == fEtaMaxBin.size() and fEtaMinBin.size() == fPtMinBin.size() and fEtaMinBin.size() == fConeSizeBin.size() and fEtaMinBin.size() == fRMSPtMinBin.size()
-       and fEtaMinBin.size() == fRMSScaleFactorBin.size() and fEtaMinBin.size() == fNeutralMinEBin.size() and  fEtaMinBin.size() == fNeutralPtSlope.size() 
-       and fEtaMinBin.size() == fApplyCHS.size()  and fEtaMinBin.size() == fUseCharged.size()
-       and fEtaMinBin.size() == fApplyLowPUCorr.size() and fEtaMinBin.size() == fMetricId.size())) {
-    std::cerr<<" Error in PUPPI configuration, algo info should have the same size --> exit from the code"<<std::endl;
-    std::exit(EXIT_FAILURE);
-   } 
-
-   for( size_t iAlgo =  0 ; iAlgo < fEtaMinBin.size() ; iAlgo++){
-    puppiAlgoBin algoTmp ;
-    algoTmp.fEtaMin_ = fEtaMinBin.at(iAlgo);
-    algoTmp.fEtaMax_ = fEtaMaxBin.at(iAlgo);
-    algoTmp.fPtMin_  = fPtMinBin.at(iAlgo);
-    algoTmp.fConeSize_        = fConeSizeBin.at(iAlgo);
-    algoTmp.fRMSPtMin_        = fRMSPtMinBin.at(iAlgo);
-    algoTmp.fRMSScaleFactor_  = fRMSScaleFactorBin.at(iAlgo);
-    algoTmp.fNeutralMinE_     = fNeutralMinEBin.at(iAlgo);
-    algoTmp.fNeutralPtSlope_  = fNeutralPtSlope.at(iAlgo);
-    algoTmp.fApplyCHS_        = fApplyCHS.at(iAlgo);
-    algoTmp.fUseCharged_      = fUseCharged.at(iAlgo);
-    algoTmp.fApplyLowPUCorr_  = fApplyLowPUCorr.at(iAlgo);
-    algoTmp.fMetricId_        = fMetricId.at(iAlgo);
-    if(std::find(puppiAlgo.begin(),puppiAlgo.end(),algoTmp) != puppiAlgo.end()) continue;    
-    puppiAlgo.push_back(algoTmp);     
-   }
-  }  
-
-  // Create PUPPI container
-  puppiCleanContainer curEvent(puppiInputVector,puppiAlgo,fMinPuppiWeight,fUseExp);
-  std::vector<fastjet::PseudoJet> puppiParticles = curEvent.puppiEvent();
+  // Run PUPPI, the input particles are swapped into the container
+  fPuppi->setParticles(puppiInputVector);
+  const std::vector<fastjet::PseudoJet> &puppiParticles = fPuppi->puppiEvent();
+  const std::vector<RecoObj> &recoParticles = fPuppi->recoParticles();
 
   // Loop on final particles
-  for (std::vector<fastjet::PseudoJet>::iterator it = puppiParticles.begin() ; it != puppiParticles.end() ; it++) {
+  for (std::vector<fastjet::PseudoJet>::const_iterator it = puppiParticles.begin() ; it != puppiParticles.end() ; it++) {
     if(it->user_index() <= int(InputParticles.size())){      
       candidate = static_cast<Candidate *>(InputParticles.at(it->user_index())->Clone());
       candidate->Momentum.SetPxPyPzE(it->px(),it->py(),it->pz(),it->e());
       fOutputArray->Add(candidate);
-      if( puppiInputVector.at(it->user_index()).id == 1 or puppiInputVector.at(it->user_index()).id == 2) fOutputTrackArray->Add(candidate);
-      else if (puppiInputVector.at(it->user_index()).id == 0) fOutputNeutralArray->Add(candidate);
+      if( recoParticles.at(it->user_index()).id == 1 or recoParticles.at(it->user_index()).id == 2) fOutputTrackArray->Add(candidate);
+      else if (recoParticles.at(it->user_index()).id == 0) fOutputNeutralArray->Add(candidate);
     }
     else{ 
       std::cerr<<" particle not found in the input Array --> skip "<<std::endl;
@@ -4,8 +4,14 @@
 #include "classes/DelphesModule.h"
 #include <vector>
 
+#if !defined(__CINT__) && !defined(__CLING__)
+#include "PUPPI/RecoObj.hh"
+#endif
+
 class TObjArray;
 class TIterator;
+class Candidate;
+class puppiCleanContainer;
 
 
 class RunPUPPI: public DelphesModule {
@@ -46,6 +52,15 @@ class RunPUPPI: public DelphesModule {
   std::vector<bool>  fApplyLowPUCorr;
   std::vector<int>   fMetricId;
 
+  // puppi engine, created once with the algorithm list and reused for every event
+  puppiCleanContainer *fPuppi; //!
+
+#if !defined(__CINT__) && !defined(__CLING__)
+  // input of the current event, the buffers keep their capacity between events
+  std::vector<Candidate *> fInputParticles; //!
+  std::vector<RecoObj> fPuppiInputVector; //!
+#endif
+
   TObjArray *fOutputArray;
   TObjArray *fOutputTrackArray;
   TObjArray *fOutputNeutralArray;
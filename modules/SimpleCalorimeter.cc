@@ -31,6 +31,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesCaloBinning.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -51,14 +52,20 @@
 
 using namespace std;
 
+// energy fractions of particles with smaller PDG codes are stored in a dense table
+static const Int_t kFractionTableSize = 10000;
+
 //------------------------------------------------------------------------------
 
 SimpleCalorimeter::SimpleCalorimeter() :
+  fBinning(0),
   fResolutionFormula(0),
   fItParticleInputArray(0), fItTrackInputArray(0)
 {
   Int_t i;
 
+  fBinning = new DelphesCaloBinning;
+
   fResolutionFormula = new DelphesFormula;
 
   for(i = 0; i < 2; ++i)
@@ -74,6 +81,8 @@ SimpleCalorimeter::~SimpleCalorimeter()
 {
   Int_t i;
 
+  if(fBinning) delete fBinning;
+
   if(fResolutionFormula) delete fResolutionFormula;
 
   for(i = 0; i < 2; ++i)
@@ -93,6 +102,7 @@ void SimpleCalorimeter::Init()
   TBinMap::iterator itEtaBin;
   set< Double_t >::iterator itPhiBin;
   vector< Double_t > *phiBins;
+  TFractionMap::iterator itFractionMap;
 
   // read eta and phi bins
   param = GetParam("EtaPhiBins");
@@ -130,6 +140,8 @@ void SimpleCalorimeter::Init()
     }
   }
 
+  fBinning->Build(fEtaBins, fPhiBins);
+
   // read energy fractions for different particles
   param = GetParam("EnergyFraction");
   size = param.GetSize();
@@ -145,6 +157,13 @@ void SimpleCalorimeter::Init()
     fFractionMap[param[i*2].GetInt()] = fraction;
   }
 
+  fFractionTable.assign(kFractionTableSize, fFractionMap[0]);
+  for(itFractionMap = fFractionMap.begin(); itFractionMap != fFractionMap.end(); ++itFractionMap)
+  {
+    if(itFractionMap->first < 0 || itFractionMap->first >= kFractionTableSize) continue;
+    fFractionTable[itFractionMap->first] = itFractionMap->second;
+  }
+
   // read min E value for towers to be saved
   fEnergyMin = GetDouble("EnergyMin", 0.0);
 
@@ -192,7 +211,8 @@ void SimpleCalorimeter::Process()
 {
   Candidate *particle, *track;
   TLorentzVector position, momentum;
-  Short_t etaBin, phiBin, flags;
+  Int_t etaBin, phiBin;
+  Short_t flags;
   Int_t number;
   Long64_t towerHit, towerEtaPhi, hitEtaPhi;
   Double_t fraction;
@@ -200,10 +220,6 @@ void SimpleCalorimeter::Process()
   Double_t sigma;
   Int_t pdgCode;
 
-  TFractionMap::iterator itFractionMap;
-
-  vector< Double_t >::iterator itEtaBin;
-  vector< Double_t >::iterator itPhiBin;
   vector< Double_t > *phiBins;
 
   vector< Long64_t >::iterator itTowerHits;
@@ -223,29 +239,13 @@ void SimpleCalorimeter::Process()
 
     pdgCode = TMath::Abs(particle->PID);
 
-    itFractionMap = fFractionMap.find(pdgCode);
-    if(itFractionMap == fFractionMap.end())
-    {
-      itFractionMap = fFractionMap.find(0);
-    }
-
-    fraction = itFractionMap->second;
+    fraction = GetFraction(pdgCode);
     fTowerFractions.push_back(fraction);
 
     if(fraction < 1.0E-9) continue;
 
-    // find eta bin [1, fEtaBins.size - 1]
-    itEtaBin = lower_bound(fEtaBins.begin(), fEtaBins.end(), particlePosition.Eta());
-    if(itEtaBin == fEtaBins.begin() || itEtaBin == fEtaBins.end()) continue;
-    etaBin = distance(fEtaBins.begin(), itEtaBin);
-
-    // phi bins for given eta bin
-    phiBins = fPhiBins[etaBin];
-
-    // find phi bin [1, phiBins.size - 1]
-    itPhiBin = lower_bound(phiBins->begin(), phiBins->end(), particlePosition.Phi());
-    if(itPhiBin == phiBins->begin() || itPhiBin == phiBins->end()) continue;
-    phiBin = distance(phiBins->begin(), itPhiBin);
+    // find eta bin [1, fEtaBins.size - 1] and phi bin [1, phiBins.size - 1]
+    if(!fBinning->FindBin(particlePosition.Eta(), particlePosition.Phi(), etaBin, phiBin)) continue;
 
     flags = 0;
     flags |= (pdgCode == 11 || pdgCode == 22) << 1;
@@ -266,28 +266,12 @@ void SimpleCalorimeter::Process()
 
     pdgCode = TMath::Abs(track->PID);
 
-    itFractionMap = fFractionMap.find(pdgCode);
-    if(itFractionMap == fFractionMap.end())
-    {
-      itFractionMap = fFractionMap.find(0);
-    }
-
-    fraction = itFractionMap->second;
+    fraction = GetFraction(pdgCode);
 
     fTrackFractions.push_back(fraction);
 
-    // find eta bin [1, fEtaBins.size - 1]
-    itEtaBin = lower_bound(fEtaBins.begin(), fEtaBins.end(), trackPosition.Eta());
-    if(itEtaBin == fEtaBins.begin() || itEtaBin == fEtaBins.end()) continue;
-    etaBin = distance(fEtaBins.begin(), itEtaBin);
-
-    // phi bins for given eta bin
-    phiBins = fPhiBins[etaBin];
-
-    // find phi bin [1, phiBins.size - 1]
-    itPhiBin = lower_bound(phiBins->begin(), phiBins->end(), trackPosition.Phi());
-    if(itPhiBin == phiBins->begin() || itPhiBin == phiBins->end()) continue;
-    phiBin = distance(phiBins->begin(), itPhiBin);
+    // find eta bin [1, fEtaBins.size - 1] and phi bin [1, phiBins.size - 1]
+    if(!fBinning->FindBin(trackPosition.Eta(), trackPosition.Phi(), etaBin, phiBin)) continue;
 
     flags = 1;
 
@@ -298,8 +282,9 @@ void SimpleCalorimeter::Process()
   }
 
   // all hits are sorted first by eta bin number, then by phi bin number,
-  // then by flags and then by particle or track number
-  sort(fTowerHits.begin(), fTowerHits.end());
+  // then by flags and then by particle or track number,
+  // so that the hits of each tower are consecutive
+  fBinning->SortHits(fTowerHits);
 
   // loop over all hits
   towerEtaPhi = 0;
@@ -414,6 +399,23 @@ void SimpleCalorimeter::Process()
 
 //------------------------------------------------------------------------------
 
+Double_t SimpleCalorimeter::GetFraction(Int_t pdgCode)
+{
+  TFractionMap::iterator itFractionMap;
+
+  if(pdgCode < kFractionTableSize) return fFractionTable[pdgCode];
+
+  itFractionMap = fFractionMap.find(pdgCode);
+  if(itFractionMap == fFractionMap.end())
+  {
+    itFractionMap = fFractionMap.find(0);
+  }
+
+  return itFractionMap->second;
+}
+
+//------------------------------------------------------------------------------
+
 void SimpleCalorimeter::FinalizeTower()
 {
   Candidate *tower, *track, *mother;
@@ -438,8 +440,8 @@ void SimpleCalorimeter::FinalizeTower()
 
   if(fSmearTowerCenter)
   {
-    eta = gRandom->Uniform(fTowerEdges[0], fTowerEdges[1]);
-    phi = gRandom->Uniform(fTowerEdges[2], fTowerEdges[3]);
+    eta = GetRandom()->Uniform(fTowerEdges[0], fTowerEdges[1]);
+    phi = GetRandom()->Uniform(fTowerEdges[2], fTowerEdges[3]);
   }
   else
   {
@@ -520,7 +522,7 @@ Double_t SimpleCalorimeter::LogNormal(Double_t mean, Double_t sigma)
     b = TMath::Sqrt(TMath::Log((1.0 + (sigma*sigma)/(mean*mean))));
     a = TMath::Log(mean) - 0.5*b*b;
 
-    return TMath::Exp(a + b*gRandom->Gaus(0.0, 1.0));
+    return TMath::Exp(a + b*GetRandom()->Gaus(0.0, 1.0));
   }
   else
   {
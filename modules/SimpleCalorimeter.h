@@ -37,6 +37,7 @@
 
 class TObjArray;
 class DelphesFormula;
+class DelphesCaloBinning;
 class Candidate;
 
 class SimpleCalorimeter: public DelphesModule
@@ -79,6 +80,10 @@ private:
   TFractionMap fFractionMap; //!
   TBinMap fBinMap; //!
 
+  std::vector < Double_t > fFractionTable; //!
+
+  DelphesCaloBinning *fBinning; //!
+
   std::vector < Double_t > fEtaBins;
   std::vector < std::vector < Double_t >* > fPhiBins;
 
@@ -104,6 +109,7 @@ private:
   TObjArray *fTowerTrackArray[2]; //!
   TIterator *fItTowerTrackArray[2]; //!
 
+  Double_t GetFraction(Int_t pdgCode);
   void FinalizeTower();
   Double_t LogNormal(Double_t mean, Double_t sigma);
 
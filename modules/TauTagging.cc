@@ -32,6 +32,8 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEfficiencyMap.h"
+#include "classes/DelphesEtaPhiIndex.h"
 
 #include "TMath.h"
 #include "TString.h"
@@ -105,50 +107,26 @@ Int_t TauTaggingPartonClassifier::GetCategory(TObject *object)
 //------------------------------------------------------------------------------
 
 TauTagging::TauTagging() :
-  fClassifier(0), fFilter(0),
-  fItPartonInputArray(0), fItJetInputArray(0)
+  fEfficiency(0), fClassifier(0), fTaus(0), fItJetInputArray(0)
 {
+  fTaus = new DelphesEtaPhiIndex;
 }
 
 //------------------------------------------------------------------------------
 
 TauTagging::~TauTagging()
 {
+  if(fTaus) delete fTaus;
 }
 
 //------------------------------------------------------------------------------
 
 void TauTagging::Init()
 {
-  map< Int_t, DelphesFormula * >::iterator itEfficiencyMap;
-  ExRootConfParam param;
-  DelphesFormula *formula;
-  Int_t i, size;
-
   fDeltaR = GetDouble("DeltaR", 0.5);
 
   // read efficiency formulas
-  param = GetParam("EfficiencyFormula");
-  size = param.GetSize();
-
-  fEfficiencyMap.clear();
-  for(i = 0; i < size/2; ++i)
-  {
-    formula = new DelphesFormula;
-    formula->Compile(param[i*2 + 1].GetString());
-
-    fEfficiencyMap[param[i*2].GetInt()] = formula;
-  }
-
-  // set default efficiency formula
-  itEfficiencyMap = fEfficiencyMap.find(0);
-  if(itEfficiencyMap == fEfficiencyMap.end())
-  {
-    formula = new DelphesFormula;
-    formula->Compile("0.0");
-
-    fEfficiencyMap[0] = formula;
-  }
+  fEfficiency = NewEfficiencyMap(GetParam("EfficiencyFormula"));
 
   // import input array(s)
 
@@ -159,9 +137,6 @@ void TauTagging::Init()
   fClassifier->fEtaMax = GetDouble("TauEtaMax", 2.5);
 
   fPartonInputArray = ImportArray(GetString("PartonInputArray", "Delphes/partons"));
-  fItPartonInputArray = fPartonInputArray->MakeIterator();
-
-  fFilter = new ExRootFilter(fPartonInputArray);
 
   fJetInputArray = ImportArray(GetString("JetInputArray", "FastJetFinder/jets"));
   fItJetInputArray = fJetInputArray->MakeIterator();
@@ -171,19 +146,9 @@ void TauTagging::Init()
 
 void TauTagging::Finish()
 {
-  map< Int_t, DelphesFormula * >::iterator itEfficiencyMap;
-  DelphesFormula *formula;
-
-  if(fFilter) delete fFilter;
+  if(fEfficiency) delete fEfficiency;
   if(fClassifier) delete fClassifier;
   if(fItJetInputArray) delete fItJetInputArray;
-  if(fItPartonInputArray) delete fItPartonInputArray;
-
-  for(itEfficiencyMap = fEfficiencyMap.begin(); itEfficiencyMap != fEfficiencyMap.end(); ++itEfficiencyMap)
-  {
-    formula = itEfficiencyMap->second;
-    if(formula) delete formula;
-  }
 }
 
 //------------------------------------------------------------------------------
@@ -192,66 +157,78 @@ void TauTagging::Process()
 {
   Candidate *jet, *tau, *daughter;
   TLorentzVector tauMomentum;
-  Double_t pt, eta, phi;
-  TObjArray *tauArray;
-  map< Int_t, DelphesFormula * >::iterator itEfficiencyMap;
-  DelphesFormula *formula;
-  Int_t pdgCode, charge, i;
+  Int_t charge, i, j, n, size;
+
+  // select taus and sum the momenta of their visible daughters once per event
+  fTaus->Clear();
 
-  // select taus
-  fFilter->Reset();
-  tauArray = fFilter->GetSubArray(fClassifier, 0);
+  size = fPartonInputArray->GetEntriesFast();
+  for(j = 0; j < size; ++j)
+  {
+    tau = static_cast<Candidate *>(fPartonInputArray->At(j));
+    if(!tau || fClassifier->GetCategory(tau) != 0) continue;
+
+    if(tau->D1 < 0) continue;
+
+    if(tau->D1 >= fParticleInputArray->GetEntriesFast() ||
+       tau->D2 >= fParticleInputArray->GetEntriesFast())
+    {
+      throw runtime_error("tau's daughter index is greater than the ParticleInputArray size");
+    }
+
+    tauMomentum.SetPxPyPzE(0.0, 0.0, 0.0, 0.0);
+
+    for(i = tau->D1; i <= tau->D2; ++i)
+    {
+      daughter = static_cast<Candidate *>(fParticleInputArray->At(i));
+      if(TMath::Abs(daughter->PID) == 16) continue;
+      tauMomentum += daughter->Momentum;
+    }
+
+    fTaus->Add(tau, tauMomentum);
+  }
 
   // loop over all input jets
+  fJets.clear();
+  fMatchedTaus.clear();
+  fPDGCodes.clear();
+  fPT.clear();
+  fEta.clear();
+
   fItJetInputArray->Reset();
   while((jet = static_cast<Candidate *>(fItJetInputArray->Next())))
   {
     const TLorentzVector &jetMomentum = jet->Momentum;
-    pdgCode = 0;
-    charge = gRandom->Uniform() > 0.5 ? 1 : -1;
-    eta = jetMomentum.Eta();
-    phi = jetMomentum.Phi();
-    pt = jetMomentum.Pt();
-
-    // loop over all input taus
-    if(tauArray){
-      TIter itTauArray(tauArray);
-      while((tau = static_cast<Candidate *>(itTauArray.Next())))
-      {
-        if(tau->D1 < 0) continue;
-
-        if(tau->D1 >= fParticleInputArray->GetEntriesFast() ||
-           tau->D2 >= fParticleInputArray->GetEntriesFast())
-        {
-          throw runtime_error("tau's daughter index is greater than the ParticleInputArray size");
-        }
-
-        tauMomentum.SetPxPyPzE(0.0, 0.0, 0.0, 0.0);
-
-        for(i = tau->D1; i <= tau->D2; ++i)
-        {
-          daughter = static_cast<Candidate *>(fParticleInputArray->At(i));
-          if(TMath::Abs(daughter->PID) == 16) continue;
-          tauMomentum += daughter->Momentum;
-        }
-
-        if(jetMomentum.DeltaR(tauMomentum) <= fDeltaR)
-        {
-          pdgCode = 15;
-          charge = tau->Charge;
-        }
-      }
-    }
-    // find an efficency formula
-    itEfficiencyMap = fEfficiencyMap.find(pdgCode);
-    if(itEfficiencyMap == fEfficiencyMap.end())
-    {
-      itEfficiencyMap = fEfficiencyMap.find(0);
-    }
-    formula = itEfficiencyMap->second;
+
+    fJets.push_back(jet);
+    fPT.push_back(jetMomentum.Pt());
+    fEta.push_back(jetMomentum.Eta());
+
+    // loop over all taus in the cone, the last one gives the charge
+    fCone.clear();
+    fTaus->Query(fEta.back(), jetMomentum.Phi(), fDeltaR, fCone);
+
+    fMatchedTaus.push_back(fCone.empty() ? 0 : fTaus->GetCandidate(fCone.back()));
+    fPDGCodes.push_back(fCone.empty() ? 0 : 15);
+  }
+
+  n = fJets.size();
+  if(n == 0) return;
+
+  // evaluate the efficiencies of all jets
+  fEfficiencies.resize(n);
+  fEfficiency->EvalN(&fPDGCodes[0], &fPT[0], &fEta[0], 0, 0, &fEfficiencies[0], n);
+
+  for(i = 0; i < n; ++i)
+  {
+    jet = fJets[i];
+    tau = fMatchedTaus[i];
+
+    charge = GetRandom()->Uniform() > 0.5 ? 1 : -1;
+    if(tau) charge = tau->Charge;
 
     // apply an efficency formula
-    jet->TauTag = gRandom->Uniform() <= formula->Eval(pt, eta);
+    jet->TauTag = GetRandom()->Uniform() <= fEfficiencies[i];
     // set tau charge
     jet->Charge = charge;
   }
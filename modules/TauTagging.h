@@ -31,15 +31,16 @@
 
 #include "classes/DelphesModule.h"
 #include "ExRootAnalysis/ExRootResult.h"
-#include "ExRootAnalysis/ExRootFilter.h"
 #include "ExRootAnalysis/ExRootClassifier.h"
 
 #include <map>
+#include <vector>
 
 class TObjArray;
-class DelphesFormula;
+class Candidate;
+class DelphesEtaPhiIndex;
+class DelphesEfficiencyMap;
 
-class ExRootFilter;
 class TauTaggingPartonClassifier;
 
 class TauTagging: public DelphesModule
@@ -57,16 +58,19 @@ private:
 
   Double_t fDeltaR;
 
-#if !defined(__CINT__) && !defined(__CLING__)
-  std::map< Int_t, DelphesFormula * > fEfficiencyMap; //!
-#endif
+  DelphesEfficiencyMap *fEfficiency; //!
   
   TauTaggingPartonClassifier *fClassifier; //!
-  
-  ExRootFilter *fFilter;
 
-  TIterator *fItPartonInputArray; //!
-  
+  // visible momenta of the selected taus
+  DelphesEtaPhiIndex *fTaus; //!
+
+  std::vector< Int_t > fCone; //!
+
+  std::vector< Candidate * > fJets, fMatchedTaus; //!
+  std::vector< Int_t > fPDGCodes; //!
+  std::vector< Double_t > fPT, fEta, fEfficiencies; //!
+
   TIterator *fItJetInputArray; //!
 
   const TObjArray *fParticleInputArray; //!
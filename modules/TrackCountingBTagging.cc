@@ -30,6 +30,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesEtaPhiIndex.h"
 
 #include "TMath.h"
 #include "TString.h"
@@ -48,7 +49,7 @@ using namespace std;
 //------------------------------------------------------------------------------
 
 TrackCountingBTagging::TrackCountingBTagging() :
-  fItTrackInputArray(0), fItJetInputArray(0)
+  fItJetInputArray(0)
 {
 }
 
@@ -74,7 +75,6 @@ void TrackCountingBTagging::Init()
   // import input array(s)
 
   fTrackInputArray = ImportArray(GetString("TrackInputArray", "Calorimeter/eflowTracks"));
-  fItTrackInputArray = fTrackInputArray->MakeIterator();
 
   fJetInputArray = ImportArray(GetString("JetInputArray", "FastJetFinder/jets"));
   fItJetInputArray = fJetInputArray->MakeIterator();
@@ -84,7 +84,6 @@ void TrackCountingBTagging::Init()
 
 void TrackCountingBTagging::Finish()
 {
-  if(fItTrackInputArray) delete fItTrackInputArray;
   if(fItJetInputArray) delete fItJetInputArray;
 }
 
@@ -93,14 +92,16 @@ void TrackCountingBTagging::Finish()
 void TrackCountingBTagging::Process()
 {
   Candidate *jet, *track;
+  DelphesEtaPhiIndex *tracks;
 
   Double_t jpx, jpy;
-  Double_t dr, tpx, tpy, tpt;
   Double_t xd, yd, dxy, ddxy, ip, sip;
 
   Int_t sign;
 
-  Int_t count;
+  Int_t i, count;
+
+  tracks = GetKinematics(fTrackInputArray);
 
   // loop over all input jets
   fItJetInputArray->Reset();
@@ -110,26 +111,22 @@ void TrackCountingBTagging::Process()
     jpx = jetMomentum.Px();
     jpy = jetMomentum.Py();
 
-    // loop over all input tracks
-    fItTrackInputArray->Reset();
+    // loop over all input tracks in the cone
+    fCone.clear();
+    tracks->Query(jetMomentum.Eta(), jetMomentum.Phi(), fDeltaR, fCone);
+
     count = 0;
-    while((track = static_cast<Candidate*>(fItTrackInputArray->Next())))
+    for(i = 0; i < Int_t(fCone.size()); ++i)
     {
-      const TLorentzVector &trkMomentum = track->Momentum;
-
-      dr = jetMomentum.DeltaR(trkMomentum);
+      if(tracks->GetPT(fCone[i]) < fPtMin) continue;
 
-      tpt = trkMomentum.Pt();
-      tpx = trkMomentum.Px();
-      tpy = trkMomentum.Py();
+      track = tracks->GetCandidate(fCone[i]);
 
       xd = track->Xd;
       yd = track->Yd;
       dxy = TMath::Hypot(xd, yd);
       ddxy = track->SDxy;
 
-      if(tpt < fPtMin) continue;
-      if(dr > fDeltaR) continue;
       if(dxy > fIPmax) continue;
 
       sign = (jpx*xd + jpy*yd > 0.0) ? 1 : -1;
@@ -30,6 +30,7 @@
 #include "classes/DelphesModule.h"
 
 #include <map>
+#include <vector>
 
 class TObjArray;
 
@@ -54,7 +55,8 @@ private:
   Double_t fSigMin;
   Int_t    fNtracks;
 
-  TIterator *fItTrackInputArray; //!
+  std::vector< Int_t > fCone; //!
+
   TIterator *fItJetInputArray; //!
 
   const TObjArray *fTrackInputArray; //!
@@ -21,6 +21,12 @@
  *
  *  Fills ROOT tree branches.
  *
+ *  Branches listed in FlatBranch are written as one leaf array
+ *  per data member (Jet_PT[Jet_size]) instead of TClonesArray,
+ *  with their own basket size and compression settings.
+ *  References (TRef, TRefArray) of other branches to the objects
+ *  of a flat branch can't be resolved, a warning is printed.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -44,7 +50,10 @@
 #include "TObjArray.h"
 #include "TDatabasePDG.h"
 #include "TLorentzVector.h"
+#include "TDataMember.h"
 
+#include <set>
+#include <vector>
 #include <algorithm>
 #include <stdexcept>
 #include <iostream>
@@ -89,11 +98,23 @@ void TreeWriter::Init()
   // import array with output from filter/classifier/jetfinder modules
 
   ExRootConfParam param = GetParam("Branch");
-  Long_t i, size;
+  ExRootConfParam flatParam = GetParam("FlatBranch");
+  Long_t i, j, size, flatSize;
   TString branchName, branchClassName, branchInputArray;
   TClass *branchClass;
   TObjArray *array;
   ExRootTreeBranch *branch;
+  vector< TString > flatBranches;
+  set< TClass * > referencedClasses;
+  Bool_t hasReferences = kFALSE;
+
+  // classes of the objects that are marked as referenced by the Process methods
+  referencedClasses.insert(GenParticle::Class());
+  referencedClasses.insert(Track::Class());
+  referencedClasses.insert(Tower::Class());
+  referencedClasses.insert(Muon::Class());
+
+  flatSize = flatParam.GetSize();
 
   size = param.GetSize();
   for(i = 0; i < size/3; ++i)
@@ -118,11 +139,53 @@ void TreeWriter::Init()
     }
 
     array = ImportArray(branchInputArray);
-    branch = NewBranch(branchName, branchClass);
+
+    // add FlatBranch BranchName BasketSize CompressionAlgorithm CompressionLevel
+    for(j = 0; j < flatSize/4; ++j)
+    {
+      if(branchName == flatParam[j*4].GetString()) break;
+    }
+
+    if(j < flatSize/4)
+    {
+      branch = NewFlatBranch(branchName, branchClass, flatParam[j*4 + 1].GetInt(),
+        flatParam[j*4 + 2].GetInt(), flatParam[j*4 + 3].GetInt());
+
+      if(referencedClasses.count(branchClass)) flatBranches.push_back(branchName);
+    }
+    else
+    {
+      branch = NewBranch(branchName, branchClass);
+
+      if(HasReferences(branchClass)) hasReferences = kTRUE;
+    }
 
     fBranchMap.insert(make_pair(branch, make_pair(itClassMap->second, array)));
   }
 
+  // flat branches don't store objects, references to them can't be resolved
+  for(i = 0; i < Long_t(flatBranches.size()) && hasReferences; ++i)
+  {
+    cout << "** WARNING: branch '" << flatBranches[i] << "' is written as leaf arrays, ";
+    cout << "references to its objects from other branches can't be resolved" << endl;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t TreeWriter::HasReferences(TClass *cl)
+{
+  TDataMember *member;
+  TString typeName;
+
+  TIter itMembers(cl->GetListOfDataMembers());
+  while((member = static_cast<TDataMember *>(itMembers.Next())))
+  {
+    typeName = member->GetTypeName();
+    if(typeName == "TRef" || typeName == "TRefArray") return kTRUE;
+  }
+
+  return kFALSE;
 }
 
 //------------------------------------------------------------------------------
@@ -23,6 +23,12 @@
  *
  *  Fills ROOT tree branches.
  *
+ *  Branches listed in FlatBranch are written as one leaf array
+ *  per data member (Jet_PT[Jet_size]) instead of TClonesArray,
+ *  with their own basket size and compression settings.
+ *  References (TRef, TRefArray) of other branches to the objects
+ *  of a flat branch can't be resolved, a warning is printed.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -53,6 +59,9 @@ private:
 
   void FillParticles(Candidate *candidate, TRefArray *array);
 
+  // true if the class has TRef or TRefArray data members
+  Bool_t HasReferences(TClass *cl);
+
   void ProcessParticles(ExRootTreeBranch *branch, TObjArray *array);
   void ProcessVertices(ExRootTreeBranch *branch, TObjArray *array);
   void ProcessTracks(ExRootTreeBranch *branch, TObjArray *array);
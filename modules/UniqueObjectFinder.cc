@@ -30,6 +30,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesOverlapIndex.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -52,14 +53,17 @@ using namespace std;
 
 //------------------------------------------------------------------------------
 
-UniqueObjectFinder::UniqueObjectFinder()
+UniqueObjectFinder::UniqueObjectFinder() :
+  fOverlapIndex(0)
 {
+  fOverlapIndex = new DelphesOverlapIndex;
 }
 
 //------------------------------------------------------------------------------
 
 UniqueObjectFinder::~UniqueObjectFinder()
 {
+  if(fOverlapIndex) delete fOverlapIndex;
 }
 
 //------------------------------------------------------------------------------
@@ -108,6 +112,9 @@ void UniqueObjectFinder::Process()
   vector< pair< TIterator *, TObjArray * > >::iterator itInputMap;
   TIterator *iterator;
   TObjArray *array;
+  Int_t i;
+
+  fOverlapIndex->Clear();
 
   // loop over all input arrays
   for(itInputMap = fInputMap.begin(); itInputMap != fInputMap.end(); ++itInputMap)
@@ -115,44 +122,22 @@ void UniqueObjectFinder::Process()
     iterator = itInputMap->first;
     array = itInputMap->second;
 
-    // loop over all candidates
+    // loop over all candidates, keep those that don't overlap
+    // with the candidates found in the previous arrays
     iterator->Reset();
     while((candidate = static_cast<Candidate*>(iterator->Next())))
     {
-      if(Unique(candidate, itInputMap))
+      if(!fOverlapIndex->Overlaps(candidate))
       {
         array->Add(candidate);
       }
     }
-  }
-}
 
-//------------------------------------------------------------------------------
-
-Bool_t UniqueObjectFinder::Unique(Candidate *candidate, vector< pair< TIterator *, TObjArray * > >::iterator itInputMap)
-{
-  Candidate *previousCandidate;
-  vector< pair< TIterator *, TObjArray * > >::iterator previousItInputMap;
-  TObjArray *array;
-
-  // loop over previous arrays
-  for(previousItInputMap = fInputMap.begin(); previousItInputMap != itInputMap; ++previousItInputMap)
-  {
-    array = previousItInputMap->second;
-    TIter iterator(array);
-
-    // loop over all candidates
-    iterator.Reset();
-    while((previousCandidate = static_cast<Candidate*>(iterator.Next())))
+    for(i = 0; i < array->GetEntriesFast(); ++i)
     {
-      if(candidate->Overlaps(previousCandidate))
-      {
-        return kFALSE;
-      }
+      fOverlapIndex->Add(static_cast<Candidate*>(array->At(i)));
     }
   }
-
-  return kTRUE;
 }
 
 //------------------------------------------------------------------------------
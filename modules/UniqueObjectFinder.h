@@ -35,6 +35,7 @@
 class TIterator;
 class TObjArray;
 class Candidate;
+class DelphesOverlapIndex;
 
 class UniqueObjectFinder: public DelphesModule
 {
@@ -49,7 +50,7 @@ public:
 
 private:
 
-  Bool_t Unique(Candidate *candidate, std::vector< std::pair< TIterator *, TObjArray * > >::iterator itInputMap);
+  DelphesOverlapIndex *fOverlapIndex; //!
 
   std::vector< std::pair< TIterator *, TObjArray * > > fInputMap; //!
 
@@ -35,7 +35,9 @@
 #include "modules/Delphes.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesWorkerPool.h"
 #include "classes/DelphesLHEFReader.h"
+#include "classes/DelphesInputStream.h"
 
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
@@ -68,8 +70,10 @@ int main(int argc, char *argv[])
   DelphesFactory *factory = 0;
   TObjArray *stableParticleOutputArray = 0, *allParticleOutputArray = 0, *partonOutputArray = 0;
   DelphesLHEFReader *reader = 0;
-  Int_t i, maxEvents, skipEvents;
-  Long64_t length, eventCounter;
+  DelphesInputStream *input = 0;
+  DelphesWorkerPool *workers = 0;
+  Int_t i, maxEvents, skipEvents, numberOfWorkers, readAheadEvents;
+  Long64_t length, eventCounter, entryCounter;
 
   if(argc < 3)
   {
@@ -120,6 +124,21 @@ int main(int argc, char *argv[])
       throw runtime_error("SkipEvents must be zero or positive");
     }
 
+    numberOfWorkers = confReader->GetInt("::NumberOfWorkers", 1);
+
+    if(numberOfWorkers < 1)
+    {
+      throw runtime_error("NumberOfWorkers must be positive");
+    }
+
+    // events parsed in a separate thread while the modules process the current event
+    readAheadEvents = confReader->GetInt("::ReadAheadEvents", 2);
+
+    if(readAheadEvents < 0)
+    {
+      throw runtime_error("ReadAheadEvents must be zero or positive");
+    }
+
     modularDelphes = new Delphes("Delphes");
     modularDelphes->SetConfReader(confReader);
     modularDelphes->SetTreeWriter(treeWriter);
@@ -130,102 +149,149 @@ int main(int argc, char *argv[])
     partonOutputArray = modularDelphes->ExportArray("partons");
 
     reader = new DelphesLHEFReader;
+    reader->SetPipelineDepth(readAheadEvents);
+    input = new DelphesInputStream;
 
     modularDelphes->InitTask();
 
-    i = 3;
-    do
-    {
-      if(interrupted) break;
+    workers = new DelphesWorkerPool(numberOfWorkers);
 
-      if(i == argc || strncmp(argv[i], "-", 2) == 0)
+    entryCounter = 0;
+    if(workers->Start(treeWriter, argv[2]))
+    {
+      // events are read by the main process
+      treeWriter->Clear();
+      modularDelphes->Clear();
+      reader->Clear();
+      readStopWatch.Start();
+      while(!interrupted && workers->ProcessEvent(reader, modularDelphes, factory,
+        allParticleOutputArray, stableParticleOutputArray, partonOutputArray,
+        entryCounter, eventCounter, &readStopWatch, &procStopWatch))
       {
-        cout << "** Reading standard input" << endl;
-        inputFile = stdin;
-        length = -1;
+        reader->AnalyzeEvent(branchEvent, eventCounter, &readStopWatch, &procStopWatch);
+        reader->AnalyzeWeight(branchWeight);
+
+        treeWriter->Fill();
+
+        treeWriter->Clear();
+        modularDelphes->Clear();
+        reader->Clear();
+
+        readStopWatch.Start();
       }
-      else
+    }
+    else
+    {
+      i = 3;
+      do
       {
-        cout << "** Reading " << argv[i] << endl;
-        inputFile = fopen(argv[i], "r");
+        if(interrupted) break;
 
-        if(inputFile == NULL)
+        if(i == argc || strncmp(argv[i], "-", 2) == 0)
         {
-          message << "can't open " << argv[i];
-          throw runtime_error(message.str());
+          cout << "** Reading standard input" << endl;
+          inputFile = stdin;
+          length = -1;
         }
+        else
+        {
+          cout << "** Reading " << argv[i] << endl;
+          inputFile = fopen(argv[i], "r");
 
-        fseek(inputFile, 0L, SEEK_END);
-        length = ftello(inputFile);
-        fseek(inputFile, 0L, SEEK_SET);
+          if(inputFile == NULL)
+          {
+            message << "can't open " << argv[i];
+            throw runtime_error(message.str());
+          }
 
-        if(length <= 0)
-        {
-          fclose(inputFile);
-          ++i;
-          continue;
+          fseek(inputFile, 0L, SEEK_END);
+          length = ftello(inputFile);
+          fseek(inputFile, 0L, SEEK_SET);
+
+          if(length <= 0)
+          {
+            fclose(inputFile);
+            ++i;
+            continue;
+          }
         }
-      }
 
-      reader->SetInputFile(inputFile);
+        inputFile = input->Open(inputFile);
 
-      ExRootProgressBar progressBar(length);
+        reader->SetInputFile(inputFile);
 
-      // Loop over all objects
-      eventCounter = 0;
-      treeWriter->Clear();
-      modularDelphes->Clear();
-      reader->Clear();
-      readStopWatch.Start();
-      while((maxEvents <= 0 || eventCounter - skipEvents < maxEvents) &&
-        reader->ReadBlock(factory, allParticleOutputArray,
-        stableParticleOutputArray, partonOutputArray) && !interrupted)
-      {
-        if(reader->EventReady())
-        {
-          ++eventCounter;
+        ExRootProgressBar progressBar(length);
 
-          readStopWatch.Stop();
-
-          if(eventCounter > skipEvents)
+        // Loop over all objects
+        eventCounter = 0;
+        treeWriter->Clear();
+        modularDelphes->Clear();
+        reader->Clear();
+        readStopWatch.Start();
+        // with workers the candidates are created by the worker of each event
+        while((maxEvents <= 0 || eventCounter - skipEvents < maxEvents) &&
+          reader->ReadBlock(workers->HasWorkers() ? 0 : factory, allParticleOutputArray,
+          stableParticleOutputArray, partonOutputArray) && !interrupted)
+        {
+          if(reader->EventReady())
           {
+            ++eventCounter;
+
             readStopWatch.Stop();
-            procStopWatch.Start();
-            modularDelphes->ProcessTask();
-            procStopWatch.Stop();
 
-            reader->AnalyzeEvent(branchEvent, eventCounter, &readStopWatch, &procStopWatch);
-            reader->AnalyzeWeight(branchWeight);
+            if(eventCounter > skipEvents && workers->HasWorkers())
+            {
+              // a stopped worker is reported by Finish
+              if(!workers->SendEvent(reader, entryCounter++, eventCounter)) break;
+            }
+            else if(eventCounter > skipEvents)
+            {
+              modularDelphes->SetEventNumber(entryCounter++);
 
-            treeWriter->Fill();
+              readStopWatch.Stop();
+              procStopWatch.Start();
+              modularDelphes->ProcessTask();
+              procStopWatch.Stop();
 
-            treeWriter->Clear();
-          }
+              reader->AnalyzeEvent(branchEvent, eventCounter, &readStopWatch, &procStopWatch);
+              reader->AnalyzeWeight(branchWeight);
+
+              treeWriter->Fill();
 
-          modularDelphes->Clear();
-          reader->Clear();
+              treeWriter->Clear();
+            }
 
-          readStopWatch.Start();
+            modularDelphes->Clear();
+            reader->Clear();
+
+            readStopWatch.Start();
+          }
+          progressBar.Update(input->GetPosition(), eventCounter);
         }
-        progressBar.Update(ftello(inputFile), eventCounter);
-      }
 
-      fseek(inputFile, 0L, SEEK_END);
-      progressBar.Update(ftello(inputFile), eventCounter, kTRUE);
-      progressBar.Finish();
+        // the reading thread may wait for input from a pipe
+        input->Interrupt();
+        reader->Stop();
 
-      if(inputFile != stdin) fclose(inputFile);
+        progressBar.Update(length, eventCounter, kTRUE);
+        progressBar.Finish();
 
-      ++i;
+        input->Close();
+
+        ++i;
+      }
+      while(i < argc);
     }
-    while(i < argc);
 
     modularDelphes->FinishTask();
+    workers->Finish(treeWriter);
     treeWriter->Write();
 
     cout << "** Exiting..." << endl;
 
+    delete workers;
     delete reader;
+    delete input;
     delete modularDelphes;
     delete confReader;
     delete treeWriter;